@@ -1,23 +1,86 @@
 /** \file
  * Gyro classes borrowed from the Rat Pack!
  * The gyro can take up to 15 seconds to become usable.
+ *
+ * The update task samples the gyro on an absolute deadline on the HAL clock so the
+ * rate does not drift with scheduling.  Each sample is stamped, integrated with the
+ * trapezoidal rule and kept in a ring so readers can ask for the angle at an
+ * earlier time.
+ *
+ * Only the update task touches the integrator.  Other tasks read it through a
+ * seqlock snapshot: the writer bumps snapshot_seq to odd, stores the fields and
+ * bumps it back to even, and a reader retries if the count was odd or changed
+ * while it copied.  A write takes a few stores every 2 ms, so a reader never
+ * waits on a lock and at most repeats a copy.  Zero() is a reference offset
+ * subtracted by readers and Reset() is a request the update task carries out,
+ * so neither can race the integrator.
+ *
+ * The bias found by calibration is saved to GYRO_CALIBRATION_FILEPATH with the
+ * temperature and time.  At boot a saved bias taken near the current temperature
+ * is checked against a one second average and, if it agrees, used straight away
+ * instead of sitting through the full 20 second calibration.
+ *
+ * After calibration the bias is tracked by a one state Kalman filter.  The bias
+ * is modelled as a random walk (GYRO_BIAS_PROCESS_NOISE) so its variance grows
+ * every sample; while the robot reports that it is stationary each raw reading is
+ * a measurement of the bias (GYRO_RATE_NOISE) and pulls it back in.  A robot that
+ * sits still for a few seconds between cycles keeps up with the warm-up drift.
+ *
+ * Every response is checked before it is used: the transfer length, both parity
+ * bits, the status bits and the fault bits, and a run of identical frames that
+ * would mean the sensor or the bus is stuck.  A bad frame is counted and dropped
+ * without touching lastTime, so the next good frame is integrated across the gap
+ * with the trapezoidal rule - a straight line interpolation over the bad sample.
  */
 
 #include "ADXRS453Z.h"
 #include <cstdarg>
+#include <time.h>
+#include <math.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <string>
+#include <string.h>
 
-int ADXRS453ZUpdateFunction(int pointer_val) {
+#include "RobotLog.h"
+
+//only one task may write the calibration file at a time
+static pthread_mutex_t calibration_file_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+int ADXRS453ZUpdateFunction(intptr_t pointer_val) {
 	ADXRS453Z * gyro = (ADXRS453Z *) pointer_val;
+	const double period = 1.0 / GYRO_SAMPLE_RATE;
+	HalClock *clock = Hal::GetInstance()->GetClock();
+	double deadline = clock->Now();
+	double now;
+
 	while (true)
 	{
 		gyro->Update();
-		Wait(0.01);
+
+		deadline += period;
+
+		// if we fell a whole period behind, skip ahead rather than bursting to catch up
+
+		now = clock->Now();
+
+		if ((now - deadline) > period)
+		{
+			gyro->missed_deadlines.fetch_add(1, std::memory_order_relaxed);
+			deadline = now;
+		}
+
+		clock->WaitUntil(deadline);
 	}
 	return 0;
 }
 
-ADXRS453Z::ADXRS453Z() {
-	spi = new SPI(SPI::kOnboardCS0);
+double ADXRS453Z::Now() {
+	return(Hal::Now());
+}
+
+ADXRS453Z::ADXRS453Z(HalSpi *pSpi) {
+	spi = pSpi;
 	spi->SetClockRate(4000000); //4 MHz (rRIO max, gyro can go high)
 	spi->SetClockActiveHigh();
 	spi->SetChipSelectActiveLow();
@@ -31,16 +94,48 @@ ADXRS453Z::ADXRS453Z() {
 	data[1] = 0;
 	data[2] = 0;
 	data[3] = 0;
+	last_data[0] = 0;
+	last_data[1] = 0;
+	last_data[2] = 0;
+	last_data[3] = 0;
 	iLoop = 0;
+	check_parity(command);
 
 	accumulated_angle = 0.0;
 	current_rate = 0.0;
+	last_rate = 0.0;
+	last_offset_rate = 0.0;
 	accumulated_offset = 0.0;
 	rate_offset = 0.0;
-	update_timer = new Timer();
-	update_timer->Start();
-	calibration_timer = new Timer();
-	calibration_timer->Start();
+	calibration_start = Now();
+	lastTime = thisTime = calibration_start;
+	sample_head = 0;
+	missed_deadlines.store(0, std::memory_order_relaxed);
+	snapshot_seq = 0;
+	zero_reference = 0.0;
+	reset_requested = false;
+	save_requested = false;
+	stationary = false;
+	bias_variance = 0.0;
+	snapshot_bias_variance = 0.0;
+	temperature = 0.0;
+	last_temperature_time = calibration_start;
+	repeated_frames = 0;
+	consecutive_errors = 0;
+	last_error_time = calibration_start - GYRO_DEGRADED_HOLD;
+	spi_errors = 0;
+	parity_errors = 0;
+	status_errors = 0;
+	fault_errors = 0;
+	repeated_errors = 0;
+	health = GYRO_HEALTH_OK;
+	flight_rate = FlightRecorder::Register("Gyro Rate");
+	flight_angle = FlightRecorder::Register("Gyro Raw Angle");
+
+	ReadTemperature();
+	saved_valid = LoadCalibration();
+	state = saved_valid ? GYRO_STATE_CHECK_SAVED : GYRO_STATE_WARM_UP;
+	PublishSnapshot();
 
 	update_task = new Task("tADSRX543Z", (FUNCPTR) &ADXRS453ZUpdateFunction); //TODO: this should give a unique name for each gyro object
 	task_started = false;
@@ -53,7 +148,7 @@ void ADXRS453Z::Start() {
 	}
 	else
 	{
-		update_task->Start((int) this);
+		update_task->Start((intptr_t) this);
 		task_started = true;
 	}
 }
@@ -66,64 +161,310 @@ void ADXRS453Z::Stop() {
 }
 
 void ADXRS453Z::Update() {
-	//calibration_timer->Start();
-	check_parity(command);
-	spi->Transaction(command, data, DATA_SIZE); //perform transaction, get error code
+	if (reset_requested.exchange(false, std::memory_order_acq_rel))
+	{
+		DoReset();
+	}
 
-	if (calibration_timer->Get() < WARM_UP_PERIOD)
+	if (save_requested.exchange(false, std::memory_order_acq_rel))
 	{
-		lastTime = thisTime = update_timer->Get();
-		return;
+		DoSaveCalibration();
 	}
-	else if (calibration_timer->Get() < CALIBRATE_PERIOD)
+
+	int transferred = spi->Transaction(command, data, DATA_SIZE); //command parity was set in the constructor
+	thisTime = Now();
+
+	if (!ValidateResponse(transferred))
 	{
-		Calibrate();
+		return;
 	}
-	else
+
+	float elapsed = thisTime - calibration_start;
+
+	switch (state.load(std::memory_order_relaxed))
 	{
+	case GYRO_STATE_CHECK_SAVED:
+		if (elapsed < GYRO_QUICK_WARM_UP)
+		{
+			accumulated_offset = 0.0;
+			lastTime = thisTime;
+			last_offset_rate = ((float) assemble_sensor_data(data)) / 80.0;
+		}
+		else if (elapsed < GYRO_QUICK_WARM_UP + GYRO_QUICK_CHECK_PERIOD)
+		{
+			Calibrate(GYRO_QUICK_WARM_UP);
+		}
+		else if (fabs(rate_offset - saved_offset) < GYRO_QUICK_CHECK_TOLERANCE)
+		{
+			// the saved bias agrees with what we see now, the long average is the better one
+
+			RobotLog::Printf(LOG_INFO, "Gyro using saved calibration %f (measured %f)\n", saved_offset, rate_offset);
+			rate_offset = saved_offset;
+			bias_variance = GYRO_QUICK_CHECK_TOLERANCE * GYRO_QUICK_CHECK_TOLERANCE;
+			state = GYRO_STATE_RUNNING;
+			PublishSnapshot();
+		}
+		else
+		{
+			// something changed, fall back to the full calibration
+
+			RobotLog::Printf(LOG_WARNING, "Gyro saved calibration %f rejected (measured %f)\n", saved_offset, rate_offset);
+			state = GYRO_STATE_WARM_UP;
+		}
+		break;
+
+	case GYRO_STATE_WARM_UP:
+		accumulated_offset = 0.0;
+		lastTime = thisTime;
+		last_offset_rate = ((float) assemble_sensor_data(data)) / 80.0;
+
+		if (elapsed >= WARM_UP_PERIOD)
+		{
+			state = GYRO_STATE_CALIBRATE;
+		}
+		break;
+
+	case GYRO_STATE_CALIBRATE:
+		if (elapsed < CALIBRATE_PERIOD)
+		{
+			Calibrate(WARM_UP_PERIOD);
+		}
+		else
+		{
+			// the variance of the mean of every sample taken while calibrating
+
+			bias_variance = GYRO_RATE_NOISE
+					/ ((CALIBRATE_PERIOD - WARM_UP_PERIOD) * GYRO_SAMPLE_RATE);
+			state = GYRO_STATE_RUNNING;
+			ReadTemperature();
+			DoSaveCalibration();
+		}
+		break;
+
+	case GYRO_STATE_RUNNING:
+	default:
 		UpdateData();
+
+		if ((thisTime - last_temperature_time) > GYRO_TEMPERATURE_PERIOD)
+		{
+			ReadTemperature();
+		}
+		break;
 	}
 }
 
 void ADXRS453Z::UpdateData() {
 	int sensor_data = assemble_sensor_data(data);
 	float rate = ((float) sensor_data) / 80.0;
+	float dt = thisTime - lastTime;
+
+	// trapezoidal rule: average this rate with the last one over the interval
 
-	current_rate = rate;
-	current_rate -= rate_offset;
-	thisTime = update_timer->Get();
+	current_rate = rate - rate_offset;
+	accumulated_offset += 0.5 * (rate + last_offset_rate) * dt;
+	accumulated_angle += 0.5 * (current_rate + (last_rate - rate_offset)) * dt;
 
-	accumulated_offset += rate * (thisTime - lastTime);
-	accumulated_angle += current_rate * (thisTime - lastTime);
+	// Kalman predict: the bias wanders, so we grow less sure of it
+
+	bias_variance += GYRO_BIAS_PROCESS_NOISE * dt;
+
+	// Kalman update: while nothing is moving the whole reading is bias
+
+	if (stationary.load(std::memory_order_relaxed))
+	{
+		float gain = bias_variance / (bias_variance + GYRO_RATE_NOISE);
+
+		rate_offset += gain * (rate - rate_offset);
+		bias_variance *= (1.0 - gain);
+	}
+
+	last_rate = rate;
+	last_offset_rate = rate;
 	lastTime = thisTime;
+
+	PushSample(thisTime, current_rate, accumulated_angle);
+	PublishSnapshot();
+	FlightRecorder::RecordAt(flight_rate, thisTime, current_rate);
+	FlightRecorder::RecordAt(flight_angle, thisTime, accumulated_angle);
 	iLoop++;
 }
 
-void ADXRS453Z::Calibrate() {
+///Only the update task calls this.
+void ADXRS453Z::PublishSnapshot() {
+	unsigned seq = snapshot_seq.load(std::memory_order_relaxed);
+
+	snapshot_seq.store(seq + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	snapshot_angle.store(accumulated_angle, std::memory_order_relaxed);
+	snapshot_rate.store(current_rate, std::memory_order_relaxed);
+	snapshot_offset.store(rate_offset, std::memory_order_relaxed);
+	snapshot_bias_variance.store(bias_variance, std::memory_order_relaxed);
+	snapshot_samples.store(sample_head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	snapshot_timestamp.store(thisTime, std::memory_order_relaxed);
+
+	snapshot_seq.store(seq + 2, std::memory_order_release);
+}
+
+GyroSnapshot ADXRS453Z::GetSnapshot() {
+	GyroSnapshot snapshot;
+	unsigned seq;
+
+	do
+	{
+		seq = snapshot_seq.load(std::memory_order_acquire);
+
+		snapshot.angle = snapshot_angle.load(std::memory_order_relaxed);
+		snapshot.rate = snapshot_rate.load(std::memory_order_relaxed);
+		snapshot.offset = snapshot_offset.load(std::memory_order_relaxed);
+		snapshot.samples = snapshot_samples.load(std::memory_order_relaxed);
+		snapshot.timestamp = snapshot_timestamp.load(std::memory_order_relaxed);
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+	} while ((seq & 1) || (seq != snapshot_seq.load(std::memory_order_relaxed)));
+
+	snapshot.angle -= zero_reference.load(std::memory_order_acquire);
+	return snapshot;
+}
+
+void ADXRS453Z::Calibrate(float start) {
 	int sensor_data = assemble_sensor_data(data);
 	float rate = ((float) sensor_data) / 80.0;
 
-	thisTime = update_timer->Get();
-	accumulated_offset += rate * (thisTime - lastTime);
+	accumulated_offset += 0.5 * (rate + last_offset_rate) * (thisTime - lastTime);
+	last_offset_rate = rate;
+	last_rate = rate;
 	lastTime = thisTime;
 	rate_offset = accumulated_offset
-			/ (calibration_timer->Get() - WARM_UP_PERIOD);
+			/ (thisTime - calibration_start - start);
+	PublishSnapshot();
 	iLoop++;
 }
 
+///Only the update task calls this; readers see a sample once sample_head moves past it.
+void ADXRS453Z::PushSample(double timestamp, float rate, float angle) {
+	unsigned head = sample_head.load(std::memory_order_relaxed);
+	GyroSample *sample = &samples[head & (GYRO_SAMPLE_BUFFER - 1)];
+
+	sample->timestamp = timestamp;
+	sample->rate = rate;
+	sample->angle = angle;
+	sample_head.store(head + 1, std::memory_order_release);
+}
+
+/**
+ * Returns the angle the gyro read at a HAL clock time (see Now()), by
+ * interpolating between the stored samples either side of it.  Times newer than
+ * the last sample are extrapolated along the last rate for at most one sample
+ * period.  Times older than the ring return the oldest angle still held.
+ */
+float ADXRS453Z::GetAngleAt(double timestamp) {
+	float angle;
+
+	for (int i = 0; i < GYRO_ANGLE_AT_TRIES; i++)
+	{
+		if (TryAngleAt(timestamp, angle))
+		{
+			return angle;
+		}
+	}
+
+	// we keep being held off for half a second at a time, the latest angle will have to do
+
+	return GetAngle();
+}
+
+/**
+ * The samples are plain copies, so like a seqlock the head is read again
+ * afterwards.  We only read the newest half of the ring; if the writer has not
+ * moved half a ring on since, it cannot have touched what we copied.
+ */
+bool ADXRS453Z::TryAngleAt(double timestamp, float &angle) {
+	unsigned head = sample_head.load(std::memory_order_acquire);
+	unsigned oldest = (head > GYRO_SAMPLE_BUFFER / 2) ? head - GYRO_SAMPLE_BUFFER / 2 : 0;
+	unsigned index;
+	GyroSample newer;
+	GyroSample older;
+
+	float reference = zero_reference.load(std::memory_order_acquire);
+
+	if (head == 0)
+	{
+		angle = 0.0;
+		return true;
+	}
+
+	newer = samples[(head - 1) & (GYRO_SAMPLE_BUFFER - 1)];
+
+	if (timestamp >= newer.timestamp)
+	{
+		double ahead = timestamp - newer.timestamp;
+
+		if (ahead > 1.0 / GYRO_SAMPLE_RATE)
+		{
+			ahead = 1.0 / GYRO_SAMPLE_RATE;
+		}
+
+		angle = newer.angle + newer.rate * ahead - reference;
+	}
+	else
+	{
+		older = newer;
+
+		for (index = head - 1; index > oldest; index--)
+		{
+			older = samples[(index - 1) & (GYRO_SAMPLE_BUFFER - 1)];
+
+			if (older.timestamp <= timestamp)
+			{
+				break;
+			}
+
+			newer = older;
+		}
+
+		if ((index == oldest) || (newer.timestamp <= older.timestamp))
+		{
+			angle = newer.angle - reference;
+		}
+		else
+		{
+			angle = older.angle + (newer.angle - older.angle)
+					* (timestamp - older.timestamp) / (newer.timestamp - older.timestamp)
+					- reference;
+		}
+	}
+
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return ((sample_head.load(std::memory_order_relaxed) - head) < GYRO_SAMPLE_BUFFER / 2);
+}
+
+unsigned ADXRS453Z::GetSampleCount() {
+	return sample_head.load(std::memory_order_acquire);
+}
+
+unsigned ADXRS453Z::GetMissedDeadlines() {
+	return missed_deadlines.load(std::memory_order_relaxed);
+}
+
 float ADXRS453Z::GetRate() {
-	return current_rate;
+	return GetSnapshot().rate;
 }
 
 float ADXRS453Z::GetAngle() {
-	return accumulated_angle;
+	return GetSnapshot().angle;
 }
 
 float ADXRS453Z::Offset() {
-	return rate_offset;
+	return GetSnapshot().offset;
 }
 
 void ADXRS453Z::Reset() {
+	reset_requested.store(true, std::memory_order_release);
+}
+
+///Only the update task calls this.
+void ADXRS453Z::DoReset() {
 	data[0] = 0;
 	data[1] = 0;
 	data[2] = 0;
@@ -132,19 +473,113 @@ void ADXRS453Z::Reset() {
 	accumulated_angle = 0.0;
 	rate_offset = 0.0;
 	accumulated_offset = 0.0;
+	bias_variance = 0.0;
+
+	calibration_start = Now();
+	zero_reference.store(0.0, std::memory_order_release);
+	state = saved_valid ? GYRO_STATE_CHECK_SAVED : GYRO_STATE_WARM_UP;
+	PublishSnapshot();
+}
+
+bool ADXRS453Z::IsCalibrated() {
+	return (state.load(std::memory_order_acquire) == GYRO_STATE_RUNNING);
+}
+
+float ADXRS453Z::GetTemperature() {
+	return temperature.load(std::memory_order_relaxed);
+}
+
+void ADXRS453Z::SetStationary(bool bStationary) {
+	stationary.store(bStationary, std::memory_order_relaxed);
+}
+
+float ADXRS453Z::GetBiasVariance() {
+	return snapshot_bias_variance.load(std::memory_order_relaxed);
+}
+
+/**
+ * Reads the TEM register.  SPI responses come back one transaction late, so the
+ * register read is followed by a sensor data command whose response carries the
+ * temperature; the next regular Update() then gets sensor data again.
+ * Only the update task may call this once the task is running.
+ */
+void ADXRS453Z::ReadTemperature() {
+	unsigned char temperature_command[DATA_SIZE] = { TEMPERATURE_COMMAND_0, TEMPERATURE_COMMAND_1, 0, 0 };
+	unsigned char response[DATA_SIZE];
+	short raw;
+
+	check_parity(temperature_command);
+	spi->Transaction(temperature_command, response, DATA_SIZE);
+	check_parity(command);
+	spi->Transaction(command, response, DATA_SIZE);
+
+	// register data is D15:D0 in bits 20:5, temperature is the top 10 bits: 0 = 45C, 5 LSB per C
+
+	raw = (short)(((response[1] & 0x1F) << 11) | (response[2] << 3) | (response[3] >> 5));
+	temperature.store(45.0 + (raw >> 6) / 5.0, std::memory_order_relaxed);
+	last_temperature_time = Now();
+}
+
+///Loads the saved bias, it is only usable if it was taken near the current temperature.
+bool ADXRS453Z::LoadCalibration() {
+	FILE *calibration = fopen(GYRO_CALIBRATION_FILEPATH, "r");
+	bool bReturn = false;
+
+	if (calibration)
+	{
+		if (fscanf(calibration, "%f %f %ld", &saved_offset, &saved_temperature, &saved_time) == 3)
+		{
+			// the saved time is only for the humans, the roboRIO clock is not set until the DS connects
+
+			bReturn = (fabs(saved_temperature - GetTemperature()) < GYRO_CALIBRATION_MAX_TEMP_DELTA);
+			RobotLog::Printf(LOG_INFO, "Gyro calibration %f from %ld at %0.1fC, now %0.1fC\n", saved_offset,
+					saved_time, saved_temperature, GetTemperature());
+		}
+
+		fclose(calibration);
+	}
+
+	return bReturn;
+}
+
+void ADXRS453Z::SaveCalibration() {
+	save_requested.store(true, std::memory_order_release);
+}
+
+///Writes the current bias out for the next boot, the file is replaced in one step.  Only the update task calls this.
+void ADXRS453Z::DoSaveCalibration() {
+	GyroSnapshot snapshot = GetSnapshot();
+	std::string tempPath = std::string(GYRO_CALIBRATION_FILEPATH) + ".tmp";
+	FILE *calibration;
+
+	if (!IsCalibrated())
+	{
+		return;
+	}
+
+	pthread_mutex_lock(&calibration_file_mutex);
+	calibration = fopen(tempPath.c_str(), "w");
+
+	if (calibration)
+	{
+		fprintf(calibration, "%f %f %ld\n", snapshot.offset, GetTemperature(), (long) time(NULL));
+		fclose(calibration);
+		rename(tempPath.c_str(), GYRO_CALIBRATION_FILEPATH);
 
-	//calibration_timer->Stop();
-	calibration_timer->Reset();
+		saved_offset = snapshot.offset;
+		saved_temperature = GetTemperature();
+		saved_valid = true;
+	}
 
-	//update_timer->Stop();
-	update_timer->Reset();
+	pthread_mutex_unlock(&calibration_file_mutex);
 }
 
 //a function to simply zero the gyro rather than reset & calibrate. Added by Taylor Smith
+//the integrator is left alone, readers subtract the angle it had when we were zeroed
 void ADXRS453Z::Zero()
 {
-	current_rate = 0.0;
-	accumulated_angle = 0.0;
+	zero_reference.store(snapshot_angle.load(std::memory_order_acquire),
+			std::memory_order_release);
 }
 
 short ADXRS453Z::assemble_sensor_data(unsigned char * data) {
@@ -168,13 +603,96 @@ void ADXRS453Z::check_parity(unsigned char * command) {
 }
 
 int ADXRS453Z::bits(unsigned char val) {
-	int n = 0;
+	return __builtin_popcount(val);
+}
 
-	while (val)
+/**
+ * Checks the response to the last sensor data command and keeps the error
+ * counters and health up to date.  Returns false if the frame must not be used.
+ * Response layout (MSB first):
+ * SQ2 SQ1 SQ0 P0 ST1 ST0 D D | D D D D D D D D | D D D D D D 0 0 | PLL Q NVM POR PWR CST CHK P
+ * P0 makes the top 16 bits odd, P makes all 32 odd.
+ */
+bool ADXRS453Z::ValidateResponse(int transferred) {
+	uint32_t frame = ((uint32_t) data[0] << 24) | ((uint32_t) data[1] << 16)
+			| ((uint32_t) data[2] << 8) | data[3];
+	bool bGood = true;
+
+	if (frame == (((uint32_t) last_data[0] << 24) | ((uint32_t) last_data[1] << 16)
+			| ((uint32_t) last_data[2] << 8) | last_data[3]))
 	{
-		val &= val - 1;
-		n += 1;
+		repeated_frames++;
 	}
+	else
+	{
+		repeated_frames = 0;
+	}
+
+	memcpy(last_data, data, DATA_SIZE);
+
+	if (transferred < DATA_SIZE)
+	{
+		spi_errors.fetch_add(1, std::memory_order_relaxed);
+		bGood = false;
+	}
+	else if (((__builtin_popcount(frame >> 16) & 1) == 0) || ((__builtin_popcount(frame) & 1) == 0))
+	{
+		parity_errors.fetch_add(1, std::memory_order_relaxed);
+		bGood = false;
+	}
+	else if ((data[0] & STATUS_MASK) != STATUS_SENSOR_DATA)
+	{
+		status_errors.fetch_add(1, std::memory_order_relaxed);
+		bGood = false;
+	}
+	else if (data[3] & FAULT_MASK)
+	{
+		fault_errors.fetch_add(1, std::memory_order_relaxed);
+		bGood = false;
+	}
+	else if (repeated_frames >= GYRO_MAX_REPEATED_FRAMES)
+	{
+		repeated_errors.fetch_add(1, std::memory_order_relaxed);
+		bGood = false;
+	}
+
+	if (bGood)
+	{
+		consecutive_errors = 0;
+	}
+	else
+	{
+		consecutive_errors++;
+		last_error_time = thisTime;
+	}
+
+	if (consecutive_errors >= GYRO_FAILED_ERRORS)
+	{
+		health.store(GYRO_HEALTH_FAILED, std::memory_order_relaxed);
+	}
+	else if ((thisTime - last_error_time) < GYRO_DEGRADED_HOLD)
+	{
+		health.store(GYRO_HEALTH_DEGRADED, std::memory_order_relaxed);
+	}
+	else
+	{
+		health.store(GYRO_HEALTH_OK, std::memory_order_relaxed);
+	}
+
+	return bGood;
+}
+
+GyroHealth ADXRS453Z::GetHealth() {
+	return health.load(std::memory_order_relaxed);
+}
+
+GyroErrorCounts ADXRS453Z::GetErrorCounts() {
+	GyroErrorCounts counts;
 
-	return n;
+	counts.spi = spi_errors.load(std::memory_order_relaxed);
+	counts.parity = parity_errors.load(std::memory_order_relaxed);
+	counts.status = status_errors.load(std::memory_order_relaxed);
+	counts.fault = fault_errors.load(std::memory_order_relaxed);
+	counts.repeated = repeated_errors.load(std::memory_order_relaxed);
+	return counts;
 }
@@ -7,42 +7,131 @@
 
 #include "WPILib.h"
 
+#include <stdint.h>
+#include <atomic>
+
+#include "FlightRecorder.h"
+#include "Hal.h"
+
 const float WARM_UP_PERIOD = 5.0;  //seconds
 const float CALIBRATE_PERIOD = 15.0; //seconds
+const char* const GYRO_CALIBRATION_FILEPATH = "/home/lvuser/GyroCalibration.txt";
+const float GYRO_QUICK_WARM_UP = 0.5; //seconds before a saved calibration is checked
+const float GYRO_QUICK_CHECK_PERIOD = 1.0; //seconds of averaging to check a saved calibration against
+const float GYRO_QUICK_CHECK_TOLERANCE = 0.25; //degrees per second a saved bias may be off and still be used
+const float GYRO_CALIBRATION_MAX_TEMP_DELTA = 10.0; //degrees C a saved bias may be from the current temperature
+const float GYRO_TEMPERATURE_PERIOD = 1.0; //seconds between temperature reads
+const float GYRO_RATE_NOISE = 0.0169; //(deg/s)^2, variance of one raw rate sample
+const float GYRO_BIAS_PROCESS_NOISE = 1.0e-4; //(deg/s)^2 per second the bias may wander as the sensor warms
+const unsigned GYRO_MAX_REPEATED_FRAMES = 8; //identical responses in a row before the sensor is taken to be stuck
+const unsigned GYRO_FAILED_ERRORS = 50; //bad frames in a row before the gyro is reported failed
+const float GYRO_DEGRADED_HOLD = 1.0; //seconds the gyro is reported degraded after a bad frame
+const int GYRO_SAMPLE_RATE = 500; //Hz, the update task runs on an absolute deadline at this rate
+const unsigned GYRO_SAMPLE_BUFFER = 1024; //samples kept for GetAngleAt(), must be a power of 2
+const int GYRO_ANGLE_AT_TRIES = 3; //GetAngleAt() reads the ring this many times before settling for the snapshot
+
+int ADXRS453ZUpdateFunction(intptr_t pointer_val);
 
-int ADXRS453ZUpdateFunction(int pointer_val);
+///Where the gyro is in its start up
+typedef enum eGyroState
+{
+	GYRO_STATE_CHECK_SAVED,		//checking the saved calibration against a short average
+	GYRO_STATE_WARM_UP,			//waiting out WARM_UP_PERIOD before calibrating
+	GYRO_STATE_CALIBRATE,		//averaging the bias until CALIBRATE_PERIOD
+	GYRO_STATE_RUNNING			//integrating
+} GyroState;
+
+///How much the gyro readings can be trusted
+typedef enum eGyroHealth
+{
+	GYRO_HEALTH_OK,				//no bad frames within GYRO_DEGRADED_HOLD
+	GYRO_HEALTH_DEGRADED,		//recent bad frames were skipped and interpolated over
+	GYRO_HEALTH_FAILED			//GYRO_FAILED_ERRORS bad frames in a row, the angle is not being updated
+} GyroHealth;
+
+///Running totals of rejected SPI frames, see ADXRS453Z::GetErrorCounts()
+struct GyroErrorCounts {
+	unsigned spi; //transaction did not move every byte
+	unsigned parity; //P0 or P parity wrong
+	unsigned status; //ST bits not 01 (valid sensor data)
+	unsigned fault; //one of the fault bits set
+	unsigned repeated; //more than GYRO_MAX_REPEATED_FRAMES identical frames
+};
+
+///One integrated gyro reading, timestamped from the HAL clock
+struct GyroSample {
+	double timestamp; //seconds
+	float rate; //degrees per second, offset removed
+	float angle; //degrees
+};
+
+///A consistent copy of the gyro state, see ADXRS453Z::GetSnapshot()
+struct GyroSnapshot {
+	float angle; //degrees, relative to the last Zero()
+	float rate; //degrees per second, offset removed
+	float offset; //degrees per second of bias being removed
+	unsigned samples; //samples integrated so far
+	double timestamp; //HAL clock seconds of the newest sample
+};
 
 class ADXRS453Z {
 	public:
-		ADXRS453Z();
+		ADXRS453Z(HalSpi *pSpi);
+		GyroSnapshot GetSnapshot(); //never blocks, see the seqlock notes in ADXRS453Z.cpp
 		float GetRate();
 		float GetAngle();
-		void Reset();
+		void Reset(); //restarts calibration, carried out by the update task
 		void Zero(); //added by Taylor Smith
 		void Update();
 		float Offset();
 		void Start();
 		void Stop();
+		float GetAngleAt(double timestamp); //angle at a HAL clock time, for latency compensation
+		unsigned GetSampleCount();
+		unsigned GetMissedDeadlines();
+		bool IsCalibrated();
+		float GetTemperature(); //degrees C
+		void SetStationary(bool stationary); //lets the bias be refined while the robot is still
+		float GetBiasVariance(); //(deg/s)^2, how sure the bias filter is of the offset
+		GyroHealth GetHealth();
+		GyroErrorCounts GetErrorCounts();
+		void SaveCalibration(); //the update task saves the current bias for the next boot on its next pass
+		static double Now(); //Hal::Now(), the clock samples are stamped with
 	private:
+		friend int ADXRS453ZUpdateFunction(intptr_t pointer_val);
 		void UpdateData();
-		void Calibrate();
 		static void check_parity(unsigned char * command); //gyro requires odd parity for command
 		static int bits(unsigned char val); //returns number of on bits in a byte (helper for parity check)
+		bool ValidateResponse(int transferred); //counts and rejects corrupted responses
 		static short assemble_sensor_data(unsigned char * data); //takes the sensor data from the data array and puts it into an int
 		static const unsigned char DATA_SIZE = 4; //4 bytes = 32 bits
 		static const unsigned char PARITY_BIT = 1; //parity check on first bit
 		static const unsigned char FIRST_BYTE_DATA = 0x3; //mask to find sensor data bits on first byte: X X X X X X D D
 		static const unsigned char THIRD_BYTE_DATA = 0xFC; //mask to find sensor data bits on third byte: D D D D D D X X
+		static const unsigned char STATUS_MASK = 0x0C; //ST1 ST0 in the first byte of a response
+		static const unsigned char STATUS_SENSOR_DATA = 0x04; //ST = 01, valid sensor data
+		static const unsigned char FAULT_MASK = 0xFE; //PLL Q NVM POR PWR CST CHK in the last byte of a response
 		static const unsigned char READ_COMMAND = 0x20; //0010 0000 for first byte
+		static const unsigned char TEMPERATURE_COMMAND_0 = 0x80; //register read of TEM (0x02): 100A AAAA
+		static const unsigned char TEMPERATURE_COMMAND_1 = 0x04; //AAAA 0000
+		void ReadTemperature();
+		bool LoadCalibration();
+		void DoSaveCalibration();
+		void Calibrate(float start);
+		void PushSample(double timestamp, float rate, float angle);
+		bool TryAngleAt(double timestamp, float &angle); //false if the writer came around while we read
+		void PublishSnapshot();
+		void DoReset();
 		float accumulated_angle;
-		Timer * update_timer;
-		Timer * calibration_timer;
+		double calibration_start;
 		float current_rate;
+		float last_rate; //raw rate of the previous sample, for trapezoidal integration
+		float last_offset_rate; //offset rate of the previous sample, for trapezoidal integration
 		float accumulated_offset;
 		float rate_offset;
 		unsigned char command[4];
 		unsigned char data[4];
-		SPI * spi;
+		HalSpi * spi;
 		Task * update_task;
 		bool task_started;
 		char sensor_output_1[9];
@@ -51,8 +140,50 @@ class ADXRS453Z {
 		char sensor_output_3[9];
 		char sensor_output_4[9];
 
-		float lastTime;
-		float thisTime;
+		double lastTime;
+		double thisTime;
 		int iLoop;
+
+		GyroSample samples[GYRO_SAMPLE_BUFFER];
+		std::atomic<unsigned> sample_head; //number of samples ever written, only the update task writes
+		std::atomic<unsigned> missed_deadlines; //the update task counts, anyone reads
+
+		//seqlock protected copy of the integrator state, only the update task writes
+		std::atomic<unsigned> snapshot_seq; //odd while a write is in progress
+		std::atomic<float> snapshot_angle; //raw, before zero_reference is taken off
+		std::atomic<float> snapshot_rate;
+		std::atomic<float> snapshot_offset;
+		std::atomic<unsigned> snapshot_samples;
+		std::atomic<double> snapshot_timestamp;
+
+		std::atomic<float> zero_reference; //raw angle at the last Zero(), only Zero() and DoReset() write
+		std::atomic<bool> reset_requested;
+		std::atomic<bool> save_requested;
+
+		std::atomic<GyroState> state;
+		std::atomic<float> temperature;
+		std::atomic<bool> stationary;
+		float bias_variance; //Kalman filter covariance of rate_offset, only the update task writes
+		std::atomic<float> snapshot_bias_variance;
+		FlightChannel flight_rate; //every sample goes to the flight recorder
+		FlightChannel flight_angle;
+		double last_temperature_time;
+		//the saved calibration, only the constructor and then the update task touch these
+		bool saved_valid; //a saved calibration was loaded and matches the temperature
+		float saved_offset;
+		float saved_temperature;
+		long saved_time;
+
+		//response checking, only the update task writes
+		unsigned char last_data[4];
+		unsigned repeated_frames;
+		unsigned consecutive_errors;
+		double last_error_time;
+		std::atomic<unsigned> spi_errors;
+		std::atomic<unsigned> parity_errors;
+		std::atomic<unsigned> status_errors;
+		std::atomic<unsigned> fault_errors;
+		std::atomic<unsigned> repeated_errors;
+		std::atomic<GyroHealth> health;
 };
 #endif /* ADXRS450GYRO_H_ */
@@ -16,6 +16,7 @@
 #include "ComponentBase.h"
 #include "RobotParams.h"
 #include "Autonomous.h"
+#include "RobotLog.h"
 
 using namespace std;
 
@@ -82,7 +83,7 @@ bool Autonomous::Evaluate(std::string rStatement) {
 	string rStatus;
 
 	if(rStatement.empty()) {
-		printf("statement is empty");
+		RobotLog::Printf(LOG_WARNING, "statement is empty");
 		return (bReturn);
 	}
 
@@ -103,7 +104,7 @@ bool Autonomous::Evaluate(std::string rStatement) {
 		SmartDashboard::PutString("Auto Status","DEATH BY PARAMS!");
 		PRINTAUTOERROR;
 		rStatus.append("missing token");
-		printf("%0.3lf %s\n", pDebugTimer->Get(), rStatement.c_str());
+		RobotLog::Printf(LOG_INFO, "%0.3lf %s\n", pDebugTimer->Get(), rStatement.c_str());
 		return (true);
 	}
 
@@ -120,7 +121,7 @@ bool Autonomous::Evaluate(std::string rStatement) {
 	if(iCommand == AUTO_TOKEN_LAST) {
 		// no valid token found
 		rStatus.append("no tokens - check script spelling");
-		printf("%0.3lf %s\n", pDebugTimer->Get(), rStatement.c_str());
+		RobotLog::Printf(LOG_INFO, "%0.3lf %s\n", pDebugTimer->Get(), rStatement.c_str());
 		return (true);
 	}
 
@@ -135,7 +136,7 @@ bool Autonomous::Evaluate(std::string rStatement) {
 
 	if(iAutoDebugMode)
 	{
-		printf("%0.3lf %s %s\n", pDebugTimer->Get(), pToken, pCurrLinePos);
+		RobotLog::Printf(LOG_INFO, "%0.3lf %s %s\n", pDebugTimer->Get(), pToken, pCurrLinePos);
 	}
 
 	switch (iCommand)
@@ -157,7 +158,7 @@ bool Autonomous::Evaluate(std::string rStatement) {
 		break;
 
 	case AUTO_TOKEN_MESSAGE:
-		printf("%0.3lf %03d: %s\n", pDebugTimer->Get(), lineNumber, pCurrLinePos);
+		RobotLog::Printf(LOG_INFO, "%0.3lf %03d: %s\n", pDebugTimer->Get(), lineNumber, pCurrLinePos);
 		break;
 
 	case AUTO_TOKEN_DELAY:
@@ -235,14 +236,14 @@ bool Autonomous::Evaluate(std::string rStatement) {
 		{
 			if(iAutoDebugMode)
 			{
-				printf("%0.3lf Raise Totes\n", pDebugTimer->Get());
+				RobotLog::Printf(LOG_INFO, "%0.3lf Raise Totes\n", pDebugTimer->Get());
 			}
 			Message.command = COMMAND_CANLIFTER_RAISE_TOTES;
 			Message.params.canLifterParams.iNumTotes = iParam1;
 			bReturn = !CommandResponse(CANLIFTER_QUEUE);
 			if(iAutoDebugMode)
 			{
-				printf("%0.3lf Stop Conveyor\n", pDebugTimer->Get());
+				RobotLog::Printf(LOG_INFO, "%0.3lf Stop Conveyor\n", pDebugTimer->Get());
 			}
 			//the conveyor should've pushed the totes. Stop it.
 			Message.command = COMMAND_CONVEYOR_STOP;
@@ -351,23 +352,27 @@ bool Autonomous::Evaluate(std::string rStatement) {
 		}
 		Message.params.autonomous.timeout = atof(pToken);
 
+		//an impact ends this drive, it is the tote
+		Message.command = COMMAND_DRIVETRAIN_START_DRIVE_FWD;
+		CommandNoResponse(DRIVETRAIN_QUEUE);
+
 		//start the drive train
 		if(iAutoDebugMode)
 		{
-			printf("%0.3lf Drive Straight\n", pDebugTimer->Get());
+			RobotLog::Printf(LOG_INFO, "%0.3lf Drive Straight\n", pDebugTimer->Get());
 		}
 		Message.command = COMMAND_DRIVETRAIN_DRIVE_STRAIGHT;//simply drives forward
 		CommandNoResponse(DRIVETRAIN_QUEUE);
 		//when front sensor sees tote, stop drivetrain and conveyor
 		if(iAutoDebugMode)
 		{
-			printf("%0.3lf Seek Front Tote Sensor\n", pDebugTimer->Get());
+			RobotLog::Printf(LOG_INFO, "%0.3lf Seek Front Tote Sensor\n", pDebugTimer->Get());
 		}
 		Message.command = COMMAND_CONVEYOR_SEEK_TOTE_FRONT;
 		bReturn = !CommandResponse(CONVEYOR_QUEUE);
 		if(iAutoDebugMode)
 		{
-			printf("%0.3lf Drive Stop\n", pDebugTimer->Get());
+			RobotLog::Printf(LOG_INFO, "%0.3lf Drive Stop\n", pDebugTimer->Get());
 		}
 		Message.command = COMMAND_DRIVETRAIN_STOP;//stop it!
 		CommandNoResponse(DRIVETRAIN_QUEUE);
@@ -424,20 +429,24 @@ bool Autonomous::Evaluate(std::string rStatement) {
 
 		Message.params.autonomous.timeout = atof(pToken);
 
+		//an impact ends this drive, it is the tote
+		Message.command = COMMAND_DRIVETRAIN_START_DRIVE_BCK;
+		CommandNoResponse(DRIVETRAIN_QUEUE);
+
 		//start the drive train
-		printf("%0.3lf Drive Straight\n", pDebugTimer->Get());
+		RobotLog::Printf(LOG_INFO, "%0.3lf Drive Straight\n", pDebugTimer->Get());
 		Message.command = COMMAND_DRIVETRAIN_DRIVE_STRAIGHT;	//simply drives backwards
 		CommandNoResponse(DRIVETRAIN_QUEUE);
 		//when back sensor sees tote, stop drivetrain and conveyor
 		if(iAutoDebugMode)
 		{
-			printf("%0.3lf Seek Rear Tote Sensor\n", pDebugTimer->Get());
+			RobotLog::Printf(LOG_INFO, "%0.3lf Seek Rear Tote Sensor\n", pDebugTimer->Get());
 		}
 		Message.command = COMMAND_CONVEYOR_SEEK_TOTE_BACK;
 		bReturn = !CommandResponse(CONVEYOR_QUEUE);
 		if(iAutoDebugMode)
 		{
-			printf("%0.3lf Drive Stop\n", pDebugTimer->Get());
+			RobotLog::Printf(LOG_INFO, "%0.3lf Drive Stop\n", pDebugTimer->Get());
 		}
 		Message.command = COMMAND_DRIVETRAIN_STOP;		//stop it!
 		CommandNoResponse(DRIVETRAIN_QUEUE);
@@ -629,7 +638,7 @@ bool Autonomous::Evaluate(std::string rStatement) {
 
 	if(bReturn)
 	{
-		printf("%0.3lf %s\n", pDebugTimer->Get(), rStatement.c_str());
+		RobotLog::Printf(LOG_INFO, "%0.3lf %s\n", pDebugTimer->Get(), rStatement.c_str());
 	}
 
 	SmartDashboard::PutBoolean("bReturn", bReturn);
@@ -20,6 +20,7 @@
 #include "ComponentBase.h"
 #include "RobotParams.h"
 #include "AutoParser.h"
+#include "RobotLog.h"
 
 using namespace std;
 
@@ -39,14 +40,16 @@ bool Autonomous::CommandResponse(const char *szQueueName) {
 
 	bReceivedCommandResponse = false;
 
+	// polled through the clock rather than spun on, so a simulated clock can run the component that answers
+
 	while (!bReceivedCommandResponse)
 	{
-		//purposefully empty
+		pHal->GetClock()->Wait(AUTONOMOUS_RESPONSE_POLL);
 	}
 
 	if(iAutoDebugMode)
 	{
-		printf("%0.3lf Response received\n", pDebugTimer->Get());
+		RobotLog::Printf(LOG_INFO, "%0.3lf Response received\n", pDebugTimer->Get());
 	}
 
 	if (ReceivedCommand == COMMAND_AUTONOMOUS_RESPONSE_OK)
@@ -97,12 +100,12 @@ bool Autonomous::MultiCommandResponse(vector<char*> szQueueNames, vector<Message
 	{
 		while (!bReceivedCommandResponse)
 		{
-			//purposefully empty
+			pHal->GetClock()->Wait(AUTONOMOUS_RESPONSE_POLL);
 		}
 
 		if(iAutoDebugMode)
 		{
-			printf("%0.3lf Response received\n", pDebugTimer->Get());
+			RobotLog::Printf(LOG_INFO, "%0.3lf Response received\n", pDebugTimer->Get());
 		}
 
 		if (ReceivedCommand == COMMAND_AUTONOMOUS_RESPONSE_OK)
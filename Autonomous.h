@@ -7,6 +7,7 @@
 
 //Robot
 #include <string>
+#include <vector>
 
 #include "WPILib.h"
 
@@ -16,6 +17,7 @@
 const int AUTONOMOUS_SCRIPT_LINES = 150;
 const int AUTONOMOUS_CHECKLIST_LINES = 150;
 const char* const AUTONOMOUS_SCRIPT_FILEPATH = "/home/lvuser/RhsScript.txt";
+const double AUTONOMOUS_RESPONSE_POLL = 0.001; //how often the script checks for a component's response
 
 //from 2014
 const float MAX_VELOCITY_PARAM = 1.0;
@@ -24,9 +26,11 @@ const float MAX_DISTANCE_PARAM = 100.0;
 class Autonomous : public ComponentBase
 {
 public:
-	Autonomous();
+	Autonomous(Hal *pHal);
 	~Autonomous();
 	void DoScript();
+	void SetScriptFile(const char *szFile) { scriptFile = szFile; }; //AUTONOMOUS_SCRIPT_FILEPATH until set
+	bool IsRunningScript() { return(bInAutoMode); }; //from autonomous starting until the script ends
 
 	static void *StartTask(void *pThis)
 	{
@@ -48,12 +52,13 @@ protected:
 	bool bPauseAutoMode;
 
 private:
+	std::string scriptFile;
 	std::string script[AUTONOMOUS_SCRIPT_LINES];	//Autonomous script
 	int lineNumber;
 	int iAutoDebugMode;
 	Task *pScript;
-	bool bReceivedCommandResponse;
-	unsigned int uResponseCount;
+	std::atomic<bool> bReceivedCommandResponse;	//set by the component task, polled by the script task
+	std::atomic<unsigned> uResponseCount;
 	MessageCommand ReceivedCommand;
 
 	void Delay(float);
@@ -72,7 +77,7 @@ private:
 
 	bool CommandResponse(const char *szQueueName);
 	bool CommandNoResponse(const char *szQueueName);
-	bool MultiCommandResponse(vector<char*> szQueueNames, vector<MessageCommand> commands);
+	bool MultiCommandResponse(std::vector<char*> szQueueNames, std::vector<MessageCommand> commands);
 
 	void Init();
 	void OnStateChange();
@@ -12,12 +12,14 @@
 
 #include "ComponentBase.h"
 #include "RobotParams.h"
+#include "RobotLog.h"
 
 using namespace std;
 
-Autonomous::Autonomous()
-: ComponentBase(AUTONOMOUS_TASKNAME, AUTONOMOUS_QUEUE, AUTONOMOUS_PRIORITY)
+Autonomous::Autonomous(Hal *pHal)
+: ComponentBase(pHal, AUTONOMOUS_TASKNAME, AUTONOMOUS_QUEUE, AUTONOMOUS_PRIORITY)
 {
+	scriptFile = AUTONOMOUS_SCRIPT_FILEPATH;
 	lineNumber = 0;
 	bInAutoMode = false;
 	iAutoDebugMode = 0;
@@ -27,12 +29,12 @@ Autonomous::Autonomous()
 	pTask = new Task(AUTONOMOUS_TASKNAME, (FUNCPTR) &Autonomous::StartTask,
 		AUTONOMOUS_PRIORITY, AUTONOMOUS_STACKSIZE);
 	wpi_assert(pTask);
-	pTask->Start((int)this);
+	pTask->Start((intptr_t) this);
 
 	pScript = new Task(AUTOEXEC_TASKNAME, (FUNCPTR) &Autonomous::StartScript,
 			AUTOEXEC_PRIORITY, AUTOEXEC_STACKSIZE);
 	wpi_assert(pScript);
-	pScript->Start((int)this);
+	pScript->Start((intptr_t) this);
 }
 
 Autonomous::~Autonomous()	//Destructor
@@ -88,6 +90,16 @@ void Autonomous::Run()
 			ReceivedCommand = COMMAND_AUTONOMOUS_RESPONSE_ERROR;
 			break;
 
+		case COMMAND_SENSORFUSION_IMPACT:
+			// Drivetrain ends its own seek, this is for the script log
+			if(bInAutoMode && iAutoDebugMode)
+			{
+				RobotLog::Printf(LOG_WARNING, "%0.3lf Impact %0.2fg\n", pDebugTimer->Get(),
+						localMessage.params.impact.magnitude);
+			}
+			SmartDashboard::PutNumber("Auto Last Impact", localMessage.params.impact.magnitude);
+			break;
+
 		default:
 			break;
 	}
@@ -98,7 +110,7 @@ bool Autonomous::LoadScriptFile()
 	bool bReturn = true;
 	//printf("Auto Script Filepath: [%s]\n", AUTONOMOUS_SCRIPT_FILEPATH);
 	ifstream scriptStream;
-	scriptStream.open(AUTONOMOUS_SCRIPT_FILEPATH);
+	scriptStream.open(scriptFile.c_str());
 	
 	if(scriptStream.is_open())//not working
 	{
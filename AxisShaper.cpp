@@ -0,0 +1,121 @@
+/** \file
+ * Implementation of the joystick axis response curve class.
+ *
+ * All of the floating point math for a curve happens once, in the constructor,
+ * when the table is filled.  Shape() is called for every axis on every driver
+ * station packet so it only clamps, indexes and interpolates.
+ */
+
+#include "AxisShaper.h"
+
+#include <math.h>
+
+AxisShaper::AxisShaper(const AxisCurveParams &params)
+{
+	for(int i = 0; i <= AXIS_SHAPER_TABLE_SIZE; i++)
+	{
+		float input = ((float)i / (AXIS_SHAPER_TABLE_SIZE / 2)) - 1.0;
+		float magnitude = Evaluate(params, fabs(input));
+
+		table[i] = (input < 0.0) ? -magnitude : magnitude;
+	}
+
+	// the stick at rest must produce exactly zero
+
+	table[AXIS_SHAPER_TABLE_SIZE / 2] = 0.0;
+}
+
+///Returns the shaped value of a raw axis reading from -1.0 to 1.0.
+float AxisShaper::Shape(float value) const
+{
+	float position;
+	int index;
+
+	if(value > 1.0)
+	{
+		value = 1.0;
+	}
+	else if(value < -1.0)
+	{
+		value = -1.0;
+	}
+
+	position = (value + 1.0) * (AXIS_SHAPER_TABLE_SIZE / 2);
+	index = (int)position;
+
+	if(index >= AXIS_SHAPER_TABLE_SIZE)
+	{
+		index = AXIS_SHAPER_TABLE_SIZE - 1;
+	}
+
+	return(table[index] + (position - index) * (table[index + 1] - table[index]));
+}
+
+float AxisShaper::Evaluate(const AxisCurveParams &params, float magnitude)
+{
+	float travel;
+
+	if(magnitude <= params.deadband)
+	{
+		return(0.0);
+	}
+
+	// rescale what is left past the deadband back to 0.0 - 1.0
+
+	if(params.keepScale)
+	{
+		travel = magnitude;
+	}
+	else
+	{
+		travel = (magnitude - params.deadband) / (1.0 - params.deadband);
+	}
+
+	switch(params.curve)
+	{
+	case AXIS_CURVE_EXPO:
+		return(params.expo * travel * travel * travel + (1.0 - params.expo) * travel);
+
+	case AXIS_CURVE_CUBIC:
+		return(travel * travel * travel);
+
+	case AXIS_CURVE_PIECEWISE:
+		return(Piecewise(params, travel));
+
+	case AXIS_CURVE_LINEAR:
+	default:
+		return(travel);
+	}
+}
+
+float AxisShaper::Piecewise(const AxisCurveParams &params, float magnitude)
+{
+	float lastIn = 0.0;
+	float lastOut = 0.0;
+
+	for(int i = 0; (i < params.iPoints) && (i < AXIS_SHAPER_MAX_POINTS); i++)
+	{
+		if(magnitude <= params.pointIn[i])
+		{
+			if(params.pointIn[i] <= lastIn)
+			{
+				return(params.pointOut[i]);
+			}
+
+			return(lastOut + (magnitude - lastIn) * (params.pointOut[i] - lastOut)
+					/ (params.pointIn[i] - lastIn));
+		}
+
+		lastIn = params.pointIn[i];
+		lastOut = params.pointOut[i];
+	}
+
+	// past the last point, head for (1,1)
+
+	if(lastIn >= 1.0)
+	{
+		return(lastOut);
+	}
+
+	return(lastOut + (magnitude - lastIn) * (1.0 - lastOut) / (1.0 - lastIn));
+}
@@ -0,0 +1,60 @@
+/** \file
+ * Definitions of the joystick axis response curve class.
+ *
+ * An AxisShaper bakes a response curve into a fixed size lookup table when it is
+ * constructed.  Shaping a reading on the hot path is then one table lookup and a
+ * linear interpolation, no matter how expensive the curve was to compute.
+ */
+
+#ifndef AXIS_SHAPER_H
+#define AXIS_SHAPER_H
+
+///Shapes of response curve that can be baked into an AxisShaper
+enum AxisCurve {
+	AXIS_CURVE_LINEAR,			//!< output follows input (after the deadband)
+	AXIS_CURVE_EXPO,			//!< blend of linear and cubic, weighted by expo
+	AXIS_CURVE_CUBIC,			//!< output is input cubed
+	AXIS_CURVE_PIECEWISE		//!< straight lines between user supplied points
+};
+
+///number of intervals in the table spanning -1.0 to 1.0, must be even
+const int AXIS_SHAPER_TABLE_SIZE = 256;
+///most points a piecewise-linear curve may have
+const int AXIS_SHAPER_MAX_POINTS = 8;
+
+/** Describes a response curve.
+ *
+ * Curves are odd-symmetric: they are defined for inputs 0.0 to 1.0 and mirrored
+ * for negative inputs.  The deadband is applied first and the remaining travel is
+ * rescaled so the output still reaches full scale, unless keepScale is set, when
+ * the curve sees the raw input past the deadband and jumps to it from zero, as a
+ * plain threshold would.  Piecewise points are given
+ * as increasing inputs with their outputs, both from 0.0 to 1.0; (0,0) and (1,1)
+ * are implied if left out.
+ */
+struct AxisCurveParams {
+	AxisCurve curve;
+	float deadband;
+	float expo;
+	int iPoints;
+	float pointIn[AXIS_SHAPER_MAX_POINTS];
+	float pointOut[AXIS_SHAPER_MAX_POINTS];
+	bool keepScale;
+};
+
+class AxisShaper
+{
+public:
+	AxisShaper(const AxisCurveParams &params);
+	~AxisShaper() {};
+
+	float Shape(float value) const;
+
+private:
+	float table[AXIS_SHAPER_TABLE_SIZE + 1];
+
+	static float Evaluate(const AxisCurveParams &params, float magnitude);
+	static float Piecewise(const AxisCurveParams &params, float magnitude);
+};
+
+#endif //AXIS_SHAPER_H
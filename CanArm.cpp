@@ -2,17 +2,18 @@
 //Robot
 #include "ComponentBase.h"
 #include "RobotParams.h"
+#include "RobotLog.h"
 
 
 
-CanArm::CanArm() : ComponentBase(CANARM_TASKNAME, CANARM_QUEUE, CANARM_PRIORITY) {
+CanArm::CanArm(Hal *pHal) : ComponentBase(pHal, CANARM_TASKNAME, CANARM_QUEUE, CANARM_PRIORITY) {
 
-	armMotor = new CANTalon(CAN_PALLET_JACK_CAN_ARM);
+	armMotor = pHal->NewMotor(CAN_PALLET_JACK_CAN_ARM, "CanArm");
 	wpi_assert(armMotor);
 	armMotor->SetVoltageRampRate(120.0);
 	armMotor->ConfigNeutralMode(
-			CANSpeedController::NeutralMode::kNeutralMode_Brake);
-	armMotor->ConfigLimitMode(CANSpeedController::kLimitMode_SwitchInputsOnly);
+			HAL_NEUTRAL_BRAKE);
+	armMotor->ConfigLimitMode(HAL_LIMIT_SWITCH_INPUTS_ONLY);
 
 	//pAutoTimer = new Timer(); IN COMPONENT BASE
 	//pAutoTimer->Start();
@@ -20,7 +21,7 @@ CanArm::CanArm() : ComponentBase(CANARM_TASKNAME, CANARM_QUEUE, CANARM_PRIORITY)
 	pTask = new Task(CANARM_TASKNAME, (FUNCPTR) &CanArm::StartTask,
 			CANARM_PRIORITY, CANARM_STACKSIZE);
 	wpi_assert(pTask);
-	pTask->Start((int) this);
+	pTask->Start((intptr_t) this);
 }
 
 CanArm::~CanArm() {
@@ -34,7 +35,7 @@ void CanArm::OnStateChange()
 	{
 		case COMMAND_ROBOT_STATE_AUTONOMOUS:
 			armMotor->ConfigNeutralMode(
-						CANSpeedController::NeutralMode::kNeutralMode_Brake);
+						HAL_NEUTRAL_BRAKE);
 			break;
 
 		case COMMAND_ROBOT_STATE_TEST:
@@ -42,13 +43,13 @@ void CanArm::OnStateChange()
 
 		case COMMAND_ROBOT_STATE_TELEOPERATED:
 			armMotor->ConfigNeutralMode(
-				CANSpeedController::NeutralMode::kNeutralMode_Brake);
+				HAL_NEUTRAL_BRAKE);
 			armMotor->Set(0);
 			break;
 
 		case COMMAND_ROBOT_STATE_DISABLED:
 			armMotor->ConfigNeutralMode(
-				CANSpeedController::NeutralMode::kNeutralMode_Coast);
+				HAL_NEUTRAL_COAST);
 			break;
 
 		case COMMAND_ROBOT_STATE_UNKNOWN:
@@ -68,7 +69,7 @@ void CanArm::Run()
 			pAutoTimer->Reset();
 			bOpening = true;
 			bClosing = false;
-			printf("%s opening time %f\n", __FILE__, localMessage.params.autonomous.timeout);
+			RobotLog::Printf(LOG_INFO, "%s opening time %f\n", __FILE__, localMessage.params.autonomous.timeout);
 			armMotor->Set(fOpen);
 			break;
 
@@ -8,7 +8,7 @@
 class CanArm : public ComponentBase
 {
 public:
-	CanArm();
+	CanArm(Hal *pHal);
 	virtual ~CanArm();
 	static void *StartTask(void *pThis)
 	{
@@ -18,7 +18,7 @@ public:
 
 private:
 
-	CANTalon *armMotor;
+	HalMotor *armMotor;
 	//Timer *pAutoTimer;IN COMPONENT BASE
 
 	const float fOpen = -0.65;
@@ -0,0 +1,299 @@
+/** \file
+ * Implementation of the CAN bus monitor.
+ *
+ * The devices are indexed by CAN ID.  The counters only ever go up; the monitor
+ * task keeps what it saw last time and works from the difference, so counting
+ * is one relaxed atomic add in the caller.
+ */
+
+#include "CanBusMonitor.h"
+
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "RobotParams.h"
+#include "Telemetry.h"
+#include "RobotLog.h"
+
+static const float fDefaultStatusPeriods[HAL_STATUS_FRAMES] = { 0.01, 0.02, 0.1, 0.1 };
+static const char *szPhaseNames[] = { "Disabled", "Autonomous", "Teleop", "Test", "Unknown" };
+static const int CANBUS_PHASES = sizeof(szPhaseNames) / sizeof(szPhaseNames[0]);
+
+///One CAN ID
+struct CanDevice {
+	std::atomic<bool> bRegistered;
+	char szName[CANBUS_NAME_LENGTH];
+	CanDeviceType type;
+	std::atomic<float> fBudget;
+	std::atomic<float> fStatusPeriods[HAL_STATUS_FRAMES];
+	std::atomic<unsigned> uControl;
+	std::atomic<unsigned> uConfig;
+	std::atomic<unsigned> uSaved;
+	std::atomic<unsigned> uReads;
+	TelemetryKey keyFrames;
+	TelemetryKey keySaved;
+	TelemetryKey keyReads;
+	TelemetryKey keyOverBudget;
+	//only the monitor task touches these
+	unsigned uLastControl;
+	unsigned uLastConfig;
+	unsigned uLastSaved;
+	unsigned uLastReads;
+	bool bOverBudget;
+};
+
+static CanDevice devices[CANBUS_MAX_DEVICES];
+static pthread_mutex_t register_mutex = PTHREAD_MUTEX_INITIALIZER;
+static std::atomic<int> iPhase(0);
+static std::atomic<float> fLoad(0.0);
+static double fPhaseFrames[CANBUS_PHASES];
+static double fPhaseTime[CANBUS_PHASES];
+static float fPeakLoad = 0.0;
+static TelemetryKey keyLoad = -1;
+static TelemetryKey keyPeakLoad = -1;
+static TelemetryKey keyPhaseLoads[CANBUS_PHASES];
+static Task *pTask = NULL;
+
+///A second registration of an ID shares the first one's counters, two devices on one ID is wiring to fix
+void CanBusMonitor::RegisterDevice(int iDevice, const char *szName, CanDeviceType type)
+{
+	char szKey[TELEMETRY_NAME_LENGTH];
+
+	if((iDevice < 0) || (iDevice >= CANBUS_MAX_DEVICES))
+	{
+		return;
+	}
+
+	CanDevice &device = devices[iDevice];
+
+	pthread_mutex_lock(&register_mutex);
+
+	if(device.bRegistered.load(std::memory_order_relaxed))
+	{
+		RobotLog::Printf(LOG_WARNING, "CAN ID %d is both %s and %s\n", iDevice, device.szName, szName);
+		pthread_mutex_unlock(&register_mutex);
+		return;
+	}
+
+	snprintf(device.szName, sizeof(device.szName), "%s", szName);
+	device.type = type;
+	device.fBudget.store(CANBUS_DEFAULT_BUDGET, std::memory_order_relaxed);
+
+	for(int i = 0; i < HAL_STATUS_FRAMES; i++)
+	{
+		device.fStatusPeriods[i].store(fDefaultStatusPeriods[i], std::memory_order_relaxed);
+	}
+
+	snprintf(szKey, sizeof(szKey), "%s CAN frames/s", device.szName);
+	device.keyFrames = Telemetry::Register(szKey, TELEMETRY_NUMBER);
+	snprintf(szKey, sizeof(szKey), "%s CAN saved/s", device.szName);
+	device.keySaved = Telemetry::Register(szKey, TELEMETRY_NUMBER);
+	snprintf(szKey, sizeof(szKey), "%s CAN reads/s", device.szName);
+	device.keyReads = Telemetry::Register(szKey, TELEMETRY_NUMBER);
+	snprintf(szKey, sizeof(szKey), "%s CAN over budget", device.szName);
+	device.keyOverBudget = Telemetry::Register(szKey, TELEMETRY_BOOLEAN);
+
+	device.bRegistered.store(true, std::memory_order_release);
+
+	pthread_mutex_unlock(&register_mutex);
+}
+
+void CanBusMonitor::SetBudget(int iDevice, float fFramesPerSecond)
+{
+	if((iDevice >= 0) && (iDevice < CANBUS_MAX_DEVICES))
+	{
+		devices[iDevice].fBudget.store(fFramesPerSecond, std::memory_order_relaxed);
+	}
+}
+
+void CanBusMonitor::SetStatusPeriod(int iDevice, HalStatusFrame frame, float fSeconds)
+{
+	if((iDevice >= 0) && (iDevice < CANBUS_MAX_DEVICES) && (frame >= 0) && (frame < HAL_STATUS_FRAMES))
+	{
+		devices[iDevice].fStatusPeriods[frame].store(fSeconds, std::memory_order_relaxed);
+	}
+}
+
+void CanBusMonitor::CountControl(int iDevice)
+{
+	if((iDevice >= 0) && (iDevice < CANBUS_MAX_DEVICES))
+	{
+		devices[iDevice].uControl.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void CanBusMonitor::CountConfig(int iDevice)
+{
+	if((iDevice >= 0) && (iDevice < CANBUS_MAX_DEVICES))
+	{
+		devices[iDevice].uConfig.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void CanBusMonitor::CountSaved(int iDevice)
+{
+	if((iDevice >= 0) && (iDevice < CANBUS_MAX_DEVICES))
+	{
+		devices[iDevice].uSaved.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void CanBusMonitor::CountStatusRead(int iDevice)
+{
+	if((iDevice >= 0) && (iDevice < CANBUS_MAX_DEVICES))
+	{
+		devices[iDevice].uReads.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void CanBusMonitor::SetPhase(MessageCommand command)
+{
+	int iNew = command - COMMAND_ROBOT_STATE_DISABLED;
+
+	if((iNew >= 0) && (iNew < CANBUS_PHASES))
+	{
+		iPhase.store(iNew, std::memory_order_relaxed);
+	}
+}
+
+float CanBusMonitor::GetLoad()
+{
+	return(fLoad.load(std::memory_order_relaxed));
+}
+
+void CanBusMonitor::Start()
+{
+	char szKey[TELEMETRY_NAME_LENGTH];
+
+	if(pTask == NULL)
+	{
+		RegisterDevice(CAN_PDB, "PDB", CANBUS_DEVICE_PDB);
+
+		keyLoad = Telemetry::Register("CAN Load %", TELEMETRY_NUMBER);
+		keyPeakLoad = Telemetry::Register("CAN Load Peak %", TELEMETRY_NUMBER);
+
+		for(int i = 0; i < CANBUS_PHASES; i++)
+		{
+			snprintf(szKey, sizeof(szKey), "CAN Load %s %%", szPhaseNames[i]);
+			keyPhaseLoads[i] = Telemetry::Register(szKey, TELEMETRY_NUMBER);
+		}
+
+		pTask = new Task(CANBUS_TASKNAME, (FUNCPTR) &CanBusMonitor::StartTask,
+				CANBUS_PRIORITY, CANBUS_STACKSIZE);
+		wpi_assert(pTask);
+		pTask->Start();
+	}
+}
+
+void *CanBusMonitor::StartTask(void *pThis)
+{
+	HalClock *pClock = Hal::GetInstance()->GetClock();
+	double fDeadline = pClock->Now();
+
+	while(true)
+	{
+		fDeadline += CANBUS_SAMPLE_PERIOD;
+		pClock->WaitUntil(fDeadline);
+
+		Sample(CANBUS_SAMPLE_PERIOD);
+	}
+
+	return(NULL);
+}
+
+///Turns the counts since the last sample into rates, the bus load and budget warnings
+void CanBusMonitor::Sample(double fElapsed)
+{
+	int iNow = iPhase.load(std::memory_order_relaxed);
+	double fFrames = CANBUS_OTHER_FRAME_RATE;
+
+	for(int i = 0; i < CANBUS_MAX_DEVICES; i++)
+	{
+		CanDevice &device = devices[i];
+		unsigned uControl;
+		unsigned uConfig;
+		unsigned uSaved;
+		unsigned uReads;
+		double fSent;
+		double fPeriodic = 0.0;
+
+		if(!device.bRegistered.load(std::memory_order_acquire))
+		{
+			continue;
+		}
+
+		uControl = device.uControl.load(std::memory_order_relaxed);
+		uConfig = device.uConfig.load(std::memory_order_relaxed);
+		uSaved = device.uSaved.load(std::memory_order_relaxed);
+		uReads = device.uReads.load(std::memory_order_relaxed);
+
+		fSent = ((uControl - device.uLastControl) + (uConfig - device.uLastConfig)) / fElapsed;
+
+		if(device.type == CANBUS_DEVICE_TALON)
+		{
+			fPeriodic = 1.0 / CANBUS_TALON_CONTROL_PERIOD;
+
+			for(int j = 0; j < HAL_STATUS_FRAMES; j++)
+			{
+				float fPeriod = device.fStatusPeriods[j].load(std::memory_order_relaxed);
+
+				if(fPeriod > 0.0)
+				{
+					fPeriodic += 1.0 / fPeriod;
+				}
+			}
+		}
+		else if(device.type == CANBUS_DEVICE_PDB)
+		{
+			fPeriodic = CANBUS_PDB_FRAME_RATE;
+		}
+
+		fFrames += fSent + fPeriodic;
+
+		Telemetry::Put(device.keyFrames, fSent);
+		Telemetry::Put(device.keySaved, (uSaved - device.uLastSaved) / fElapsed);
+		Telemetry::Put(device.keyReads, (uReads - device.uLastReads) / fElapsed);
+
+		// warn once on the way over, not every second it stays there
+
+		if(fSent > device.fBudget.load(std::memory_order_relaxed))
+		{
+			if(!device.bOverBudget)
+			{
+				RobotLog::Printf(LOG_WARNING, "%s (CAN ID %d) sent %0.0f frames/s, over its budget of %0.0f\n",
+						device.szName, i, fSent, device.fBudget.load(std::memory_order_relaxed));
+			}
+
+			device.bOverBudget = true;
+		}
+		else
+		{
+			device.bOverBudget = false;
+		}
+
+		Telemetry::PutBoolean(device.keyOverBudget, device.bOverBudget);
+
+		device.uLastControl = uControl;
+		device.uLastConfig = uConfig;
+		device.uLastSaved = uSaved;
+		device.uLastReads = uReads;
+	}
+
+	float fNewLoad = fFrames * CANBUS_BITS_PER_FRAME / CANBUS_BIT_RATE;
+
+	fLoad.store(fNewLoad, std::memory_order_relaxed);
+
+	if(fNewLoad > fPeakLoad)
+	{
+		fPeakLoad = fNewLoad;
+	}
+
+	fPhaseFrames[iNow] += fFrames * fElapsed;
+	fPhaseTime[iNow] += fElapsed;
+
+	Telemetry::Put(keyLoad, fNewLoad * 100.0);
+	Telemetry::Put(keyPeakLoad, fPeakLoad * 100.0);
+	Telemetry::Put(keyPhaseLoads[iNow],
+			fPhaseFrames[iNow] / fPhaseTime[iNow] * CANBUS_BITS_PER_FRAME / CANBUS_BIT_RATE * 100.0);
+}
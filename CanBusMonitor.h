@@ -0,0 +1,69 @@
+/** \file
+ * Definitions of the CAN bus monitor, which estimates how busy the bus is and who is keeping it busy.
+ *
+ * Nothing on the roboRIO reports bus load, so the monitor builds it up per
+ * device ID.  Each Talon sends its status frames and repeats its control frame
+ * on its own at known periods; that traffic is modelled from the periods the
+ * code asked for.  On top of that the motor proxies count every control and
+ * config frame they send and every call they saved, and the components count
+ * the status values they read.  Once a second the monitor turns that into frames
+ * per second per device and a load estimate for the whole bus, and keeps an
+ * average for each match phase.
+ *
+ * Each device has a budget for the frames the code sends beyond the periodic
+ * traffic.  A device over it is logged once as a warning and flagged on the
+ * dashboard until it comes back under.
+ *
+ * What is published per device, "<name> CAN frames/s", also lands in the flight
+ * recorder, which is where tools/CanPlanner.cpp reads it from.
+ */
+
+#ifndef CAN_BUS_MONITOR_H
+#define CAN_BUS_MONITOR_H
+
+#include "WPILib.h"
+#include "RobotMessage.h"
+#include "Hal.h"
+
+#include <atomic>
+
+const int CANBUS_MAX_DEVICES = 64; //CAN IDs 0 to 62
+const int CANBUS_NAME_LENGTH = 24;
+const float CANBUS_BIT_RATE = 1.0e6;
+const float CANBUS_BITS_PER_FRAME = 150.0; //29 bit ID and 8 data bytes is 131 bits before bit stuffing
+const float CANBUS_SAMPLE_PERIOD = 1.0; //seconds between estimates
+const float CANBUS_DEFAULT_BUDGET = 50.0; //frames a second a device may send beyond its periodic traffic
+const float CANBUS_TALON_CONTROL_PERIOD = 0.01; //the Talon repeats its control frame at this period
+const float CANBUS_PDB_FRAME_RATE = 120.0; //roughly, three status frames every 25 ms
+const float CANBUS_OTHER_FRAME_RATE = 50.0; //the roboRIO heartbeat
+
+///Kinds of device, which decides the periodic traffic the monitor expects from it
+typedef enum eCanDeviceType
+{
+	CANBUS_DEVICE_TALON,			//!< Talon SRX, status frames plus the repeated control frame
+	CANBUS_DEVICE_PDB				//!< power distribution board, status frames only
+} CanDeviceType;
+
+class CanBusMonitor
+{
+public:
+	static void RegisterDevice(int iDevice, const char *szName, CanDeviceType type); //at construction
+	static void SetBudget(int iDevice, float fFramesPerSecond);
+	static void SetStatusPeriod(int iDevice, HalStatusFrame frame, float fSeconds); //what the Talon was told
+
+	static void CountControl(int iDevice);
+	static void CountConfig(int iDevice);
+	static void CountSaved(int iDevice); //a write the proxy didn't need to send
+	static void CountStatusRead(int iDevice);
+
+	static void SetPhase(MessageCommand command); //one of the COMMAND_ROBOT_STATE_ commands
+	static float GetLoad(); //fraction of the bus in use, from the last estimate
+
+	static void Start(); //call once everything is built
+	static void *StartTask(void *pThis);
+
+private:
+	static void Sample(double fElapsed);
+};
+
+#endif //CAN_BUS_MONITOR_H
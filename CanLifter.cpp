@@ -17,24 +17,29 @@
 //Robot
 #include "ComponentBase.h"
 #include "RobotParams.h"
+#include "RobotLog.h"
 
-CanLifter::CanLifter() :
-		ComponentBase(CANLIFTER_TASKNAME, CANLIFTER_QUEUE, CANLIFTER_PRIORITY) {
+CanLifter::CanLifter(Hal *pHal) :
+		ComponentBase(pHal, CANLIFTER_TASKNAME, CANLIFTER_QUEUE, CANLIFTER_PRIORITY) {
 
-	lifterMotor = new CANTalon(CAN_PALLET_JACK_BIN_LIFT);
+	lifterMotor = pHal->NewMotor(CAN_PALLET_JACK_BIN_LIFT, "CanLifter");
 	wpi_assert(lifterMotor);
 	//lifterMotor->SetVoltageRampRate(120.0);
 	lifterMotor->ConfigNeutralMode(
-			CANSpeedController::NeutralMode::kNeutralMode_Brake);
+			HAL_NEUTRAL_BRAKE);
 	// MrB we moved the sensors so this doesn't do anything
-	//lifterMotor->ConfigLimitMode(CANSpeedController::kLimitMode_SwitchInputsOnly);
-	lifterMotor->ConfigLimitMode(CANSpeedController::kLimitMode_SrxDisableSwitchInputs);
+	//lifterMotor->ConfigLimitMode(HAL_LIMIT_SWITCH_INPUTS_ONLY);
+	lifterMotor->ConfigLimitMode(HAL_LIMIT_SWITCH_INPUTS_DISABLED);
 
 	wpi_assert(lifterMotor->IsAlive());
 
-	hoverHallEffect = new DigitalInput(DIO_CANLIFTER_HOVER_HALL_EFFECT);
+	hoverHallEffect = pHal->NewDigitalInput(DIO_CANLIFTER_HOVER_HALL_EFFECT);
 
-	hoverHallDetect = new Counter(hoverHallEffect);
+	iLifterOutput = DeclareSensor(lifterMotor, SENSOR_OUTPUT);
+	iLifterCurrent = DeclareSensor(lifterMotor, SENSOR_OUTPUT_CURRENT);
+	iHoverHallEffect = DeclareSensor(hoverHallEffect);
+
+	hoverHallDetect = pHal->NewCounter(hoverHallEffect);
 	hoverHallDetect->Reset();
 	/*upperHall = new DigitalInput(DIO_CANLIFTER_UPPER_HALL_EFFECT);
 	lowerHall = new DigitalInput(DIO_CANLIFTER_LOWER_HALL_EFFECT);
@@ -46,13 +51,25 @@ CanLifter::CanLifter() :
 
 	pSafetyTimer = new Timer();
 	pSafetyTimer->Start();
+	heldCommand.command = COMMAND_UNKNOWN;
+
+	keyLiftCurrent = Telemetry::Register("Lift Current", TELEMETRY_NUMBER);
+	keyLifterHallEffect = Telemetry::Register("Lifter @ Hall Effect", TELEMETRY_BOOLEAN);
+	keyLifterHoverEnabled = Telemetry::Register("Lifter Hover Enabled", TELEMETRY_BOOLEAN);
+	keyLifterHoverWhileStopped = Telemetry::Register("Lifter Hover while Stopped", TELEMETRY_BOOLEAN);
+	keyLifterRaising = Telemetry::Register("Lifter Raising", TELEMETRY_BOOLEAN);
+	keyLifterLowering = Telemetry::Register("Lifter Lowering", TELEMETRY_BOOLEAN);
+
+	flightLifterMotor = FlightRecorder::Register("CanLifter Motor");
+	flightLifterCurrent = FlightRecorder::Register("CanLifter Current");
+	flightLifterHallEffect = FlightRecorder::Register("CanLifter Hall Effect");
 	//pAutoTimer = new Timer();IN COMPONENT BASE
 	//pAutoTimer->Start();
 
 	pTask = new Task(CANLIFTER_TASKNAME, (FUNCPTR) &CanLifter::StartTask,
 			CANLIFTER_PRIORITY, CANLIFTER_STACKSIZE);
 	wpi_assert(pTask);
-	pTask->Start((int) this);
+	pTask->Start((intptr_t) this);
 }
 
 CanLifter::~CanLifter() {
@@ -63,6 +80,8 @@ CanLifter::~CanLifter() {
 ;
 
 void CanLifter::OnStateChange() {
+	heldCommand.command = COMMAND_UNKNOWN;
+
 	switch (localMessage.command)
 	{
 	case COMMAND_ROBOT_STATE_AUTONOMOUS:
@@ -70,21 +89,21 @@ void CanLifter::OnStateChange() {
 		bHoverEnabled = false;
 		bHoverWhileStopped = false;
 		pSafetyTimer->Reset();
-		//lifterMotor->ConfigLimitMode(CANSpeedController::kLimitMode_SwitchInputsOnly);
+		//lifterMotor->ConfigLimitMode(HAL_LIMIT_SWITCH_INPUTS_ONLY);
 		break;
 	case COMMAND_ROBOT_STATE_TEST:
 		lifterMotor->Set(fLifterStop);
 		bHoverEnabled = false;
 		bHoverWhileStopped = false;
 		pSafetyTimer->Reset();
-		//lifterMotor->ConfigLimitMode(CANSpeedController::kLimitMode_SrxDisableSwitchInputs);
+		//lifterMotor->ConfigLimitMode(HAL_LIMIT_SWITCH_INPUTS_DISABLED);
 		break;
 	case COMMAND_ROBOT_STATE_TELEOPERATED:
 		bHoverEnabled = false;
 		bHoverWhileStopped = false;
 		lifterMotor->Set(fLifterStop);
 		pSafetyTimer->Reset();
-		//lifterMotor->ConfigLimitMode(CANSpeedController::kLimitMode_SrxDisableSwitchInputs);
+		//lifterMotor->ConfigLimitMode(HAL_LIMIT_SWITCH_INPUTS_DISABLED);
 		break;
 	case COMMAND_ROBOT_STATE_DISABLED:
 		lifterMotor->Set(fLifterStop);
@@ -108,10 +127,25 @@ void CanLifter::OnStateChange() {
 }
 
 void CanLifter::Run() {
+	//RhsRobot only sends the triggers when they change, keep checking the hall effect while one is held
+
+	if ((localMessage.command == COMMAND_SYSTEM_MSGTIMEOUT) && ISTELEOPERATED
+			&& ((heldCommand.command == COMMAND_CANLIFTER_RAISE)
+					|| (heldCommand.command == COMMAND_CANLIFTER_LOWER)))
+	{
+		localMessage = heldCommand;
+	}
+	else if ((localMessage.command == COMMAND_CANLIFTER_RAISE)
+			|| (localMessage.command == COMMAND_CANLIFTER_LOWER)
+			|| (localMessage.command == COMMAND_CANLIFTER_STOP))
+	{
+		heldCommand = localMessage;
+	}
+
 	switch (localMessage.command)
 	{
 	case COMMAND_CANLIFTER_RAISE:
-		if (!hoverHallEffect->Get() || hoverHallDetect->Get() > 0)
+		if (!GetSensorBool(iHoverHallEffect) || hoverHallDetect->Get() > 0)
 		{
 			//if the lifter trips the halleffect or it was recorded, see if bHoverEnabled is false
 			hoverHallDetect->Reset();
@@ -159,7 +193,7 @@ void CanLifter::Run() {
 
 		case COMMAND_CANLIFTER_RAISE_TOTES:
 			//to load pos
-			//lifterMotor->ConfigLimitMode(CANSpeedController::kLimitMode_SwitchInputsOnly);
+			//lifterMotor->ConfigLimitMode(HAL_LIMIT_SWITCH_INPUTS_ONLY);
 			bHoverEnabled = true;
 			bLowerHover = false;
 			pSafetyTimer->Reset();
@@ -184,12 +218,12 @@ void CanLifter::Run() {
 			//hovering, so don't stop it
 			lifterMotor->Set(fLifterHover);
 			// MrB - we need to do other things while lifting
-			printf("%s Totes Raised\n", __FILE__);
+			RobotLog::Printf(LOG_INFO, "%s Totes Raised\n", __FILE__);
 			SendCommandResponse(COMMAND_AUTONOMOUS_RESPONSE_OK);
 			break;
 
 		case COMMAND_CANLIFTER_LOWER_TOTES:
-			//lifterMotor->ConfigLimitMode(CANSpeedController::kLimitMode_SwitchInputsOnly);
+			//lifterMotor->ConfigLimitMode(HAL_LIMIT_SWITCH_INPUTS_ONLY);
 			bHoverEnabled = false;
 			bLowerHover = true;
 			pSafetyTimer->Reset();
@@ -203,12 +237,12 @@ void CanLifter::Run() {
 
 			lowerDetect->Reset();
 			lifterMotor->Set(fLifterHover);
-			printf("%s Totes Lowered\n", __FILE__);
+			RobotLog::Printf(LOG_INFO, "%s Totes Lowered\n", __FILE__);
 			SendCommandResponse(COMMAND_AUTONOMOUS_RESPONSE_OK);
 			break;
 
 		case COMMAND_CANLIFTER_START_RAISE_TOTES:
-			//lifterMotor->ConfigLimitMode(CANSpeedController::kLimitMode_SwitchInputsOnly);
+			//lifterMotor->ConfigLimitMode(HAL_LIMIT_SWITCH_INPUTS_ONLY);
 			bHoverEnabled = true;
 			bLowerHover = false;
 			pSafetyTimer->Reset();
@@ -217,7 +251,7 @@ void CanLifter::Run() {
 			break;
 
 		case COMMAND_CANLIFTER_CLAW_TO_TOP:
-			//lifterMotor->ConfigLimitMode(CANSpeedController::kLimitMode_SrxDisableSwitchInputs);
+			//lifterMotor->ConfigLimitMode(HAL_LIMIT_SWITCH_INPUTS_DISABLED);
 			bHoverEnabled = false;
 			bLowerHover = false;
 
@@ -241,7 +275,7 @@ void CanLifter::Run() {
 		case COMMAND_CANLIFTER_CLAW_TO_BOTTOM:
 			bHoverEnabled = false;
 			bLowerHover = false;
-			//	lifterMotor->ConfigLimitMode(CANSpeedController::kLimitMode_SrxDisableSwitchInputs);
+			//	lifterMotor->ConfigLimitMode(HAL_LIMIT_SWITCH_INPUTS_DISABLED);
 
 			while(ISAUTO && LifterCurrentLimitDrive(fLifterLower))
 			{
@@ -256,13 +290,13 @@ void CanLifter::Run() {
 		/*case COMMAND_CANLIFTER_RAISE_CAN:
 			//to hook pos
 			bHover = false;
-			lifterMotor->ConfigLimitMode(CANSpeedController::kLimitMode_SrxDisableSwitchInputs);
+			lifterMotor->ConfigLimitMode(HAL_LIMIT_SWITCH_INPUTS_DISABLED);
 			pSafetyTimer->Reset();
 			break;*/
 		case COMMAND_CANLIFTER_RAISE_LOMID:
 			bLowerHover = true;
 			bHoverEnabled = false;
-			//lifterMotor->ConfigLimitMode(CANSpeedController::kLimitMode_SwitchInputsOnly);
+			//lifterMotor->ConfigLimitMode(HAL_LIMIT_SWITCH_INPUTS_ONLY);
 
 			while(ISAUTO && (lowerDetect->Get()== 0))
 			{
@@ -277,7 +311,7 @@ void CanLifter::Run() {
 			{
 				lifterMotor->Set(fLifterRaise);
 			}*/
-			printf("%s Lomid Reached\n", __FILE__);
+			RobotLog::Printf(LOG_INFO, "%s Lomid Reached\n", __FILE__);
 			lifterMotor->Set(fLifterHover);
 			pSafetyTimer->Reset();
 			break;
@@ -285,7 +319,7 @@ void CanLifter::Run() {
 		case COMMAND_CANLIFTER_LOWER_HIMID:
 			bHoverEnabled = true;
 			bLowerHover = false;
-			//lifterMotor->ConfigLimitMode(CANSpeedController::kLimitMode_SwitchInputsOnly);
+			//lifterMotor->ConfigLimitMode(HAL_LIMIT_SWITCH_INPUTS_ONLY);
 
 			while(ISAUTO && (upperDetect->Get() == 0))
 			{
@@ -294,7 +328,7 @@ void CanLifter::Run() {
 			}
 
 			upperDetect->Reset();
-			printf("%s Himid Reached\n", __FILE__);
+			RobotLog::Printf(LOG_INFO, "%s Himid Reached\n", __FILE__);
 			pSafetyTimer->Reset();
 			break;
 #endif
@@ -327,7 +361,7 @@ void CanLifter::Run() {
 	}
 
 	//check that the lifter is not hurting itself
-	if (lifterMotor->GetOutputCurrent() > fLifterMotorCurrentMax)
+	if (GetSensor(iLifterCurrent) > fLifterMotorCurrentMax)
 	{
 		lifterMotor->Set(fLifterStop);
 	}
@@ -382,14 +416,14 @@ void CanLifter::Run() {
 	{
 		// not hovering, just normal can up and down motions
 
-		if(lifterMotor->Get() < 0.0)
+		if(GetSensor(iLifterOutput) < 0.0)
 		{
 			// was on the way up
 
 			bGoingUp = true;
 			bGoingDown = false;
 		}
-		else if(lifterMotor->Get() > 0.0)
+		else if(GetSensor(iLifterOutput) > 0.0)
 		{
 			// was on the way down
 
@@ -398,24 +432,28 @@ void CanLifter::Run() {
 		}
 	}
 
-	// update the Smart Dashboard periodically to reduce traffic
+	FlightRecorder::Record(flightLifterMotor, GetSensor(iLifterOutput));
+	FlightRecorder::Record(flightLifterCurrent, GetSensor(iLifterCurrent));
+	FlightRecorder::Record(flightLifterHallEffect, !GetSensorBool(iHoverHallEffect));
+
+	// the telemetry publisher batches these for the Smart Dashboard
 	//if (pRemoteUpdateTimer->Get() > 0.2)
 	{
 		pRemoteUpdateTimer->Reset();
 
-		SmartDashboard::PutNumber("Lift Current", lifterMotor->GetOutputCurrent());
+		Telemetry::Put(keyLiftCurrent, GetSensor(iLifterCurrent));
 		//SmartDashboard::PutBoolean("Lifter @ Top", !upperHall->Get());
 		//SmartDashboard::PutBoolean("Lifter @ Bottom", !lowerHall->Get());
-		SmartDashboard::PutBoolean("Lifter @ Hall Effect", !hoverHallEffect->Get());
-		SmartDashboard::PutBoolean("Lifter Hover Enabled", bHoverEnabled);
-		SmartDashboard::PutBoolean("Lifter Hover while Stopped", bHoverWhileStopped);
-		SmartDashboard::PutBoolean("Lifter Raising", bGoingUp);
-		SmartDashboard::PutBoolean("Lifter Lowering", bGoingDown);
+		Telemetry::PutBoolean(keyLifterHallEffect, !GetSensorBool(iHoverHallEffect));
+		Telemetry::PutBoolean(keyLifterHoverEnabled, bHoverEnabled);
+		Telemetry::PutBoolean(keyLifterHoverWhileStopped, bHoverWhileStopped);
+		Telemetry::PutBoolean(keyLifterRaising, bGoingUp);
+		Telemetry::PutBoolean(keyLifterLowering, bGoingDown);
 	}
 }
 
 bool CanLifter::LifterCurrentLimitDrive(float speed) {
-	if (lifterMotor->GetOutputCurrent() > fLifterMotorCurrentMax)
+	if (GetSensor(iLifterCurrent) > fLifterMotorCurrentMax)
 	{
 		lifterMotor->Set(fLifterStop);
 		return false;
@@ -13,12 +13,14 @@
 
 
 #include "ComponentBase.h"			//For ComponentBase class
+#include "Telemetry.h"
+#include "FlightRecorder.h"
 
 
 class CanLifter : public ComponentBase
 {
 public:
-	CanLifter();
+	CanLifter(Hal *pHal);
 	virtual ~CanLifter();
 	static void *StartTask(void *pThis)
 	{
@@ -32,14 +34,27 @@ public:
 
 private:
 
-	CANTalon *lifterMotor;
-	DigitalInput *hoverHallEffect;
-	Counter *hoverHallDetect;
+	HalMotor *lifterMotor;
+	HalDigitalInput *hoverHallEffect;
+	HalCounter *hoverHallDetect;
+	int iLifterOutput;
+	int iLifterCurrent;
+	int iHoverHallEffect;
 	/*DigitalInput *upperHall;
 	DigitalInput *lowerHall;
 	Counter *upperDetect;
 	Counter *lowerDetect;*/
 	Timer *pSafetyTimer;
+	RobotMessage heldCommand;	//the last raise, lower or stop, repeated while no messages come
+	TelemetryKey keyLiftCurrent;
+	TelemetryKey keyLifterHallEffect;
+	TelemetryKey keyLifterHoverEnabled;
+	TelemetryKey keyLifterHoverWhileStopped;
+	TelemetryKey keyLifterRaising;
+	TelemetryKey keyLifterLowering;
+	FlightChannel flightLifterMotor;
+	FlightChannel flightLifterCurrent;
+	FlightChannel flightLifterHallEffect;
 	//Timer *pAutoTimer;IN COMPONENT BASE
 
 
@@ -18,26 +18,29 @@
 #include "ComponentBase.h"
 #include "RobotParams.h"
 
-Claw::Claw() :
-		ComponentBase(CLAW_TASKNAME, CLAW_QUEUE, CLAW_PRIORITY) {
-	clawMotor = new CANTalon(CAN_PALLET_JACK_CLAW);
+Claw::Claw(Hal *pHal) :
+		ComponentBase(pHal, CLAW_TASKNAME, CLAW_QUEUE, CLAW_PRIORITY) {
+	clawMotor = pHal->NewMotor(CAN_PALLET_JACK_CLAW, "Claw");
 	wpi_assert(clawMotor);
 	clawMotor->ConfigNeutralMode(
-			CANSpeedController::NeutralMode::kNeutralMode_Brake);
-	clawMotor->ConfigLimitMode(CANSpeedController::kLimitMode_SwitchInputsOnly);
+			HAL_NEUTRAL_BRAKE);
+	clawMotor->ConfigLimitMode(HAL_LIMIT_SWITCH_INPUTS_ONLY);
 	clawMotor->SetVoltageRampRate(120.0);
 
 	wpi_assert(clawMotor->IsAlive());
+	iClawCurrent = DeclareSensor(clawMotor, SENSOR_OUTPUT_CURRENT);
 
 	pSafetyTimer = new Timer();
 	pSafetyTimer->Start();
 	pClawTimer = new Timer();
 	pClawTimer->Start();
 
+	keyCurrent = Telemetry::Register("Claw Current", TELEMETRY_NUMBER);
+
 	pTask = new Task(CLAW_TASKNAME, (FUNCPTR) &Claw::StartTask,
 			CLAW_PRIORITY, CLAW_STACKSIZE);
 	wpi_assert(pTask);
-	pTask->Start((int) this);
+	pTask->Start((intptr_t) this);
 }
 
 Claw::~Claw() {
@@ -67,7 +70,7 @@ void Claw::Run() {
 	{
 		case COMMAND_CLAW_OPEN:
 			pClawTimer->Reset();
-			if (clawMotor->GetOutputCurrent() < fClawMotorCurrentMax)
+			if (GetSensor(iClawCurrent) < fClawMotorCurrentMax)
 			{
 				clawMotor->Set(fClawOpen);
 			}
@@ -80,7 +83,7 @@ void Claw::Run() {
 
 		case COMMAND_CLAW_CLOSE:
 			pClawTimer->Reset();
-			if (clawMotor->GetOutputCurrent() < fClawMotorCurrentMax)
+			if (GetSensor(iClawCurrent) < fClawMotorCurrentMax)
 			{
 				clawMotor->Set(fClawClose);
 			}
@@ -101,7 +104,7 @@ void Claw::Run() {
 	}	//end of command switch
 
 	//current safety
-	if (clawMotor->GetOutputCurrent() >= fClawMotorCurrentMax)
+	if (GetSensor(iClawCurrent) >= fClawMotorCurrentMax)
 	{
 		clawMotor->Set(fClawStop);
 	}
@@ -119,6 +122,6 @@ void Claw::Run() {
 		pSafetyTimer->Reset();
 	}
 
-	SmartDashboard::PutNumber("Claw Current", TRUNC_THOU(clawMotor->GetOutputCurrent()));
+	Telemetry::Put(keyCurrent, TRUNC_THOU(GetSensor(iClawCurrent)));
 }
 
@@ -15,11 +15,12 @@
 
 
 #include "ComponentBase.h"			//For ComponentBase class
+#include "Telemetry.h"
 
 class Claw : public ComponentBase
 {
 public:
-	Claw();
+	Claw(Hal *pHal);
 	virtual ~Claw();
 	static void *StartTask(void *pThis)
 	{
@@ -29,9 +30,11 @@ public:
 
 private:
 
-	CANTalon *clawMotor;
+	HalMotor *clawMotor;
+	int iClawCurrent;
 	Timer *pSafetyTimer;
 	Timer *pClawTimer;
+	TelemetryKey keyCurrent;
 
 
 	/*
@@ -15,14 +15,14 @@
 #include "ComponentBase.h"
 #include "RobotParams.h"
 
-Component::Component()
-: ComponentBase(COMPONENT_TASKNAME, COMPONENT_QUEUE, COMPONENT_PRIORITY)
+Component::Component(Hal *pHal)
+: ComponentBase(pHal, COMPONENT_TASKNAME, COMPONENT_QUEUE, COMPONENT_PRIORITY)
 {
 	//TODO: add member objects
 	pTask = new Task(COMPONENT_TASKNAME, (FUNCPTR) &Component::StartTask,
 			COMPONENT_PRIORITY, COMPONENT_STACKSIZE);
 	wpi_assert(pTask);
-	pTask->Start((int)this);
+	pTask->Start((intptr_t) this);
 };
 
 Component::~Component()
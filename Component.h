@@ -21,7 +21,7 @@
 class Component : public ComponentBase
 {
 public:
-	Component();
+	Component(Hal *pHal);
 	virtual ~Component();
 	static void *StartTask(void *pThis)
 	{
@@ -20,11 +20,14 @@
 //Robot
 class RhsRobot;
 #include "RobotMessage.h"
+#include "HeartbeatMonitor.h"
+#include "Telemetry.h"
+#include "CanBusMonitor.h"
 
-ComponentBase::ComponentBase(const char* componentName, const char *queueName, int priority)
+ComponentBase::ComponentBase(Hal *pHal, const char* componentName, const char *queueName, int priority)
 {	
+	this->pHal = pHal;
 	iLoop = 0;
-	iPipeRcv = -1;
 	iPipeXmt = -1;
 	pTask = NULL;
 
@@ -39,6 +42,33 @@ ComponentBase::ComponentBase(const char* componentName, const char *queueName, i
 
 	mkfifo(queueName, 0666);
 	queueLocal = queueName;
+
+	// our end is opened now and for reading and writing, so no sender's open waits
+	// on it and the pipe never reads end of file while there are no senders
+
+	iPipeRcv = open(queueName, O_RDWR);
+	assert(iPipeRcv > 0);
+
+	bSafeStopRequested = false;
+	iHeartbeat = HeartbeatMonitor::GetInstance()->Register(componentName, HEARTBEAT_COMPONENT_PERIOD, this);
+
+	char szKey[TELEMETRY_NAME_LENGTH];
+	snprintf(szKey, sizeof(szKey), "%s Run us", componentName);
+	keyRunTime = Telemetry::Register(szKey, TELEMETRY_NUMBER);
+	snprintf(szKey, sizeof(szKey), "%s Command", componentName);
+	flightCommand = FlightRecorder::Register(szKey);
+	snprintf(szKey, sizeof(szKey), "%s Sent", componentName);
+	flightSent = FlightRecorder::Register(szKey);
+	fRunTimeSum = 0.0;
+	iRunTimes = 0;
+	iSensors = 0;
+	uSensorReads = 0;
+	uSensorUses = 0;
+	fSensorRateStart = 0.0;
+	snprintf(szKey, sizeof(szKey), "%s sensor reads/s", componentName);
+	keySensorReads = Telemetry::Register(szKey, TELEMETRY_NUMBER); //only put once a sensor is declared
+	snprintf(szKey, sizeof(szKey), "%s sensor uses/s", componentName);
+	keySensorUses = Telemetry::Register(szKey, TELEMETRY_NUMBER);
 	//printf("COMPONENT: %s\n",componentName); //Added by Talyor for debugging
 }
 
@@ -53,28 +83,15 @@ void ComponentBase::SendMessage(RobotMessage* robotMessage)
 		assert(iPipeXmt > 0);
 	}
 
+	FlightRecorder::Record(flightSent, message.command);
 	write(iPipeXmt, (char*)&message, sizeof(RobotMessage));
 }
 
 void ComponentBase::ReceiveMessage()			//Receives a message and copies it into localMessage
 {
-	fd_set selectSet;
-	struct timeval timeout;
+	// waiting through the HAL's clock lets a simulated clock decide when we wake
 
-	if(iPipeRcv < 0)
-	{
-		//printf("ComponentBase opening pipe\n");
-		iPipeRcv = open(queueLocal.c_str(), O_RDONLY);
-		assert(iPipeRcv > 0);
-	}
-
-	FD_ZERO(&selectSet);
-	FD_SET(iPipeRcv, &selectSet);
-
-	timeout.tv_sec = 0;
-	timeout.tv_usec = 40000;
-
-	if(select(iPipeRcv + 1, &selectSet, NULL, NULL, &timeout) == 0)
+	if(!pHal->GetClock()->WaitForInput(iPipeRcv, COMPONENT_MESSAGE_TIMEOUT))
 	{
 		localMessage.command = COMMAND_SYSTEM_MSGTIMEOUT;
 	}
@@ -106,10 +123,22 @@ void ComponentBase::ClearMessages(void)
 
 void ComponentBase::DoWork()
 {
+	double fStart;
+
 	while(true)
 	{
 		ReceiveMessage();		//Receives a message and copies it into localMessage
 
+		Beat();
+
+		if(localMessage.command != COMMAND_SYSTEM_MSGTIMEOUT)
+		{
+			FlightRecorder::Record(flightCommand, localMessage.command);
+		}
+
+		fStart = Hal::Now();
+		SampleSensors();
+
 		if(localMessage.command == COMMAND_ROBOT_STATE_DISABLED ||			//Tests for state change messages
 				localMessage.command == COMMAND_ROBOT_STATE_AUTONOMOUS ||
 				localMessage.command == COMMAND_ROBOT_STATE_TELEOPERATED ||
@@ -120,6 +149,21 @@ void ComponentBase::DoWork()
 		}
 
 		Run();			//Component logic
+
+		if(bSafeStopRequested.exchange(false))
+		{
+			SafeStop();
+		}
+
+		fRunTimeSum += Hal::Now() - fStart;
+
+		if(++iRunTimes >= COMPONENT_RUN_TIME_PASSES)
+		{
+			Telemetry::Put(keyRunTime, fRunTimeSum * 1.0e6 / iRunTimes);
+			fRunTimeSum = 0.0;
+			iRunTimes = 0;
+			PutSensorRates();
+		}
 		//if(ISAUTO) { AutoBehavior(); } //TODO: add this after world's for easier auto coding
 		//AutoBehavior is where the actual auto stuff is called - it should be periodic rather than stop up the thread
 		//It should be structured as a state machine; Run will change the state.
@@ -128,6 +172,181 @@ void ComponentBase::DoWork()
 		iLoop++;
 	}
 }
+/**
+ * The Talon SRX sends each group of readings in its own status frame at its own
+ * rate; reading one faster than its frame comes in only returns the same value
+ * again, so each signal is only read when its sample is older than its frame.
+ */
+static const float fSensorPeriods[SENSOR_SIGNAL_COUNT] = {
+	0.01,		//SENSOR_FWD_LIMIT
+	0.01,		//SENSOR_REV_LIMIT
+	0.01,		//SENSOR_OUTPUT
+	0.02,		//SENSOR_OUTPUT_CURRENT
+	0.1,		//SENSOR_QUAD_B
+	0.1,		//SENSOR_BUS_VOLTAGE
+	0.0			//SENSOR_DIGITAL_INPUT
+};
+
+int ComponentBase::DeclareSensor(HalMotor *pTalon, SensorSignal signal)
+{
+	wpi_assert(pTalon && (signal != SENSOR_DIGITAL_INPUT));
+	return(AddSensor(signal, pTalon, NULL));
+}
+
+int ComponentBase::DeclareSensor(HalDigitalInput *pInput)
+{
+	wpi_assert(pInput);
+	return(AddSensor(SENSOR_DIGITAL_INPUT, NULL, pInput));
+}
+
+int ComponentBase::AddSensor(SensorSignal signal, HalMotor *pTalon, HalDigitalInput *pInput)
+{
+	wpi_assert(iSensors < COMPONENT_MAX_SENSORS);
+
+	if(iSensors >= COMPONENT_MAX_SENSORS)
+	{
+		return(-1);
+	}
+
+	if(iSensors == 0)
+	{
+		fSensorRateStart = Hal::Now();
+	}
+
+	Sensor &sensor = sensors[iSensors];
+
+	sensor.signal = signal;
+	sensor.pTalon = pTalon;
+	sensor.pInput = pInput;
+	sensor.fPeriod = fSensorPeriods[signal];
+	sensor.fValue = 0.0;
+	sensor.fTime = 0.0;
+
+	return(iSensors++);
+}
+
+///Tells the heartbeat monitor we are still working on localMessage
+void ComponentBase::Beat()
+{
+	HeartbeatMonitor::GetInstance()->Beat(iHeartbeat, localMessage.command);
+}
+
+///Reads every declared signal whose sample is older than its status frame
+void ComponentBase::SampleSensors()
+{
+	double fNow;
+
+	if(iSensors == 0)
+	{
+		return;
+	}
+
+	fNow = Hal::Now();
+
+	for(int i = 0; i < iSensors; i++)
+	{
+		Sensor &sensor = sensors[i];
+
+		if((fNow - sensor.fTime) < sensor.fPeriod)
+		{
+			continue;
+		}
+
+		switch(sensor.signal)
+		{
+		case SENSOR_FWD_LIMIT:
+			sensor.fValue = sensor.pTalon->IsFwdLimitSwitchClosed() ? 1.0 : 0.0;
+			break;
+
+		case SENSOR_REV_LIMIT:
+			sensor.fValue = sensor.pTalon->IsRevLimitSwitchClosed() ? 1.0 : 0.0;
+			break;
+
+		case SENSOR_OUTPUT:
+			sensor.fValue = sensor.pTalon->Get();
+			break;
+
+		case SENSOR_OUTPUT_CURRENT:
+			sensor.fValue = sensor.pTalon->GetOutputCurrent();
+			break;
+
+		case SENSOR_QUAD_B:
+			sensor.fValue = (sensor.pTalon->GetPinStateQuadB() == 1) ? 1.0 : 0.0;
+			break;
+
+		case SENSOR_BUS_VOLTAGE:
+			sensor.fValue = sensor.pTalon->GetBusVoltage();
+			break;
+
+		case SENSOR_DIGITAL_INPUT:
+			sensor.fValue = sensor.pInput->Get() ? 1.0 : 0.0;
+			break;
+
+		default:
+			break;
+		}
+
+		if(sensor.pTalon != NULL)
+		{
+			CanBusMonitor::CountStatusRead(sensor.pTalon->GetDeviceNumber());
+		}
+
+		sensor.fTime = fNow;
+		uSensorReads++;
+	}
+}
+
+float ComponentBase::GetSensor(int iSensor)
+{
+	if((iSensor < 0) || (iSensor >= iSensors))
+	{
+		return(0.0);
+	}
+
+	uSensorUses++;
+	return(sensors[iSensor].fValue);
+}
+
+float ComponentBase::GetSensorAge(int iSensor)
+{
+	if((iSensor < 0) || (iSensor >= iSensors))
+	{
+		return(0.0);
+	}
+
+	return(Hal::Now() - sensors[iSensor].fTime);
+}
+
+///Reads are what the sensors cost now, uses are what they cost when every use was a read
+void ComponentBase::PutSensorRates()
+{
+	double fNow;
+
+	if(iSensors == 0)
+	{
+		return;
+	}
+
+	fNow = Hal::Now();
+	Telemetry::Put(keySensorReads, uSensorReads / (fNow - fSensorRateStart));
+	Telemetry::Put(keySensorUses, uSensorUses / (fNow - fSensorRateStart));
+	uSensorReads = 0;
+	uSensorUses = 0;
+	fSensorRateStart = fNow;
+}
+
+void ComponentBase::RequestSafeStop()
+{
+	bSafeStopRequested.store(true);
+}
+
+///Every component already knows how to be safe when the robot is disabled
+void ComponentBase::SafeStop()
+{
+	localMessage.command = COMMAND_ROBOT_STATE_DISABLED;
+	OnStateChange();
+}
+
 void ComponentBase::SendCommandResponse(MessageCommand command)
 {
 	RobotMessage replyMessage;
@@ -19,17 +19,38 @@
 
 #include <string>
 #include <iostream>
+#include <atomic>
 using namespace std;
 
 #include "WPILib.h"
 
 //Robot
 #include "RobotMessage.h"			//For the RobotMessage struct
+#include "Telemetry.h"
+#include "FlightRecorder.h"
+#include "Hal.h"
+
+const int COMPONENT_RUN_TIME_PASSES = 25; //passes averaged into each Run time sample, about a second when idle
+const double COMPONENT_MESSAGE_TIMEOUT = 0.04; //a pass runs at least this often without messages
+const int COMPONENT_MAX_SENSORS = 8;
+
+///A device reading a component can declare, see ComponentBase::DeclareSensor()
+typedef enum eSensorSignal
+{
+	SENSOR_FWD_LIMIT,				//!< HalMotor::IsFwdLimitSwitchClosed(), general status frame
+	SENSOR_REV_LIMIT,				//!< HalMotor::IsRevLimitSwitchClosed(), general status frame
+	SENSOR_OUTPUT,					//!< HalMotor::Get(), general status frame
+	SENSOR_OUTPUT_CURRENT,			//!< HalMotor::GetOutputCurrent(), feedback status frame
+	SENSOR_QUAD_B,					//!< HalMotor::GetPinStateQuadB(), quadrature encoder status frame
+	SENSOR_BUS_VOLTAGE,				//!< HalMotor::GetBusVoltage(), analog/temperature/battery status frame
+	SENSOR_DIGITAL_INPUT,			//!< HalDigitalInput::Get(), read from the FPGA
+	SENSOR_SIGNAL_COUNT
+} SensorSignal;
 
 class ComponentBase
 {
 public:
-	ComponentBase(const char* componentName, const char *queueName, int priority);
+	ComponentBase(Hal *pHal, const char* componentName, const char *queueName, int priority);
 	virtual ~ComponentBase() {};
 
 	void DoWork();
@@ -39,7 +60,10 @@ public:
 	char* GetComponentName();
 	int GetLoop() { return(iLoop); };
 
+	void RequestSafeStop();			//any task may call this, the component stops at the end of its pass
+
 protected:
+	Hal *pHal;					//where the component gets its devices
 	//Timer *pSafetyTimer; //TODO: add after world's
 	Timer *pAutoTimer;
 	//TODO: move to private after worlds? subclasses shouldn't need access thanks to SmartDashboardUpdate()
@@ -53,22 +77,62 @@ protected:
 	virtual void OnStateChange() = 0;
 	virtual void Run() = 0;
 
+	///long running loops in Run() should give up when this goes true
+	bool SafeStopRequested() { return(bSafeStopRequested.load(std::memory_order_relaxed)); };
+	///and call this beside their Wait() each pass, or the heartbeat monitor takes them for stalled
+	void Beat();
+
 	// virtual void AutoBehavior() = 0; //TODO: add after world's
 	//virtual void SmartDashboardUpdate() = 0; //TODO: add after world's
 
 	///used to send a message back to autonomous or whatever to notify completion of a function
 	void SendCommandResponse(MessageCommand);
 
+	int DeclareSensor(HalMotor *pTalon, SensorSignal signal); //in the constructor, returns the index to read it by
+	int DeclareSensor(HalDigitalInput *pInput);
+	void SampleSensors(); //done before every pass, and after the wait in each pass of a loop inside Run(), it never waits itself
+	float GetSensor(int iSensor); //the value from the last sample
+	bool GetSensorBool(int iSensor) { return(GetSensor(iSensor) != 0.0); };
+	float GetSensorAge(int iSensor); //seconds since the sample was read
+
 private:
 	char* componentName;
 	string queueLocal;
 	int iPipeRcv;
 	int iPipeXmt;
 	int iPipeRpt;
+	int iHeartbeat;
+	std::atomic<bool> bSafeStopRequested;
+	TelemetryKey keyRunTime;			//mean time spent in OnStateChange() and Run(), microseconds
+	double fRunTimeSum;
+	FlightChannel flightCommand;		//every command received, timeouts left out
+	FlightChannel flightSent;			//every command sent through SendMessage(), for the latency
+	int iRunTimes;
+
+	///One declared device reading and its latest sample
+	struct Sensor {
+		SensorSignal signal;
+		HalMotor *pTalon;
+		HalDigitalInput *pInput;
+		float fPeriod;				//the device doesn't report it any faster than this
+		float fValue;
+		double fTime;				//when fValue was read, 0 until it has been
+	};
+
+	Sensor sensors[COMPONENT_MAX_SENSORS];
+	int iSensors;
+	unsigned uSensorReads;			//calls into WPILib for a sensor, what goes on the bus
+	unsigned uSensorUses;			//GetSensor() calls, what went on the bus before the snapshot
+	double fSensorRateStart;
+	TelemetryKey keySensorReads;
+	TelemetryKey keySensorUses;
 	//const float fUpdateDelay = .1; //TODO: add after world's
 
 	void ReceiveMessage();
 	void ReportMessage();
+	void SafeStop();
+	int AddSensor(SensorSignal signal, HalMotor *pTalon, HalDigitalInput *pInput);
+	void PutSensorRates();
 };
 
 #endif //COMPONENT_BASE_H
@@ -15,27 +15,40 @@
 #include "ComponentBase.h"
 #include "RobotParams.h"
 
-Conveyor::Conveyor() :
-		ComponentBase(CONVEYOR_TASKNAME, CONVEYOR_QUEUE, CONVEYOR_PRIORITY) {
+Conveyor::Conveyor(Hal *pHal) :
+		ComponentBase(pHal, CONVEYOR_TASKNAME, CONVEYOR_QUEUE, CONVEYOR_PRIORITY) {
 	bBackStopEnable = true;
+	heldCommand = COMMAND_UNKNOWN;
 
-	conveyorMotor = new CANTalon(CAN_PALLET_JACK_CONVEYOR);
+	keyFrontIR = Telemetry::Register("Pallet Jack Front IR", TELEMETRY_BOOLEAN);
+	keyBackIR = Telemetry::Register("Pallet Jack Back IR", TELEMETRY_BOOLEAN);
+	keyBackStop = Telemetry::Register("Back Stop Enabled", TELEMETRY_BOOLEAN);
+
+	flightConveyorMotor = FlightRecorder::Register("Conveyor Motor");
+	flightFrontIR = FlightRecorder::Register("Conveyor Front IR");
+	flightBackIR = FlightRecorder::Register("Conveyor Back IR");
+
+	conveyorMotor = pHal->NewMotor(CAN_PALLET_JACK_CONVEYOR, "Conveyor");
 	wpi_assert(conveyorMotor);
-	conveyorMotor->SetControlMode(CANSpeedController::kPercentVbus);
+	conveyorMotor->SetControlMode(HAL_CONTROL_PERCENT_VBUS);
 	conveyorMotor->SetVoltageRampRate(24.0);
 	conveyorMotor->ConfigFwdLimitSwitchNormallyOpen(false);
 	conveyorMotor->ConfigRevLimitSwitchNormallyOpen(false);
 	conveyorMotor->ConfigLimitMode(
-			CANSpeedController::kLimitMode_SwitchInputsOnly);
+			HAL_LIMIT_SWITCH_INPUTS_ONLY);
 
 	wpi_assert(conveyorMotor->IsAlive());
 
+	iRevLimit = DeclareSensor(conveyorMotor, SENSOR_REV_LIMIT);
+	iFwdLimit = DeclareSensor(conveyorMotor, SENSOR_FWD_LIMIT);
+	iMotorOutput = DeclareSensor(conveyorMotor, SENSOR_OUTPUT);
+
 	//pAutoTimer = new Timer();IN COMPONENT BASE
 	//pAutoTimer->Start();
 	pTask = new Task(CONVEYOR_TASKNAME, (FUNCPTR) &Conveyor::StartTask,
 			CONVEYOR_PRIORITY, CONVEYOR_STACKSIZE);
 	wpi_assert(pTask);
-	pTask->Start((int) this);
+	pTask->Start((intptr_t) this);
 }
 
 Conveyor::~Conveyor() {
@@ -43,14 +56,16 @@ Conveyor::~Conveyor() {
 }
 
 void Conveyor::OnStateChange() {
+	heldCommand = COMMAND_UNKNOWN;
+
 	switch (localMessage.command)
 	{
 	case COMMAND_ROBOT_STATE_AUTONOMOUS:
 		conveyorMotor->Set(0.0);
 		conveyorMotor->ConfigLimitMode(
-				CANSpeedController::kLimitMode_SrxDisableSwitchInputs);
+				HAL_LIMIT_SWITCH_INPUTS_DISABLED);
 		conveyorMotor->ConfigNeutralMode(
-				CANSpeedController::NeutralMode::kNeutralMode_Brake);
+				HAL_NEUTRAL_BRAKE);
 		break;
 	case COMMAND_ROBOT_STATE_TEST:
 		conveyorMotor->Set(0.0);
@@ -58,9 +73,9 @@ void Conveyor::OnStateChange() {
 	case COMMAND_ROBOT_STATE_TELEOPERATED:
 		conveyorMotor->Set(0.0);
 		conveyorMotor->ConfigLimitMode(
-				CANSpeedController::kLimitMode_SrxDisableSwitchInputs);
+				HAL_LIMIT_SWITCH_INPUTS_DISABLED);
 		conveyorMotor->ConfigNeutralMode(
-				CANSpeedController::NeutralMode::kNeutralMode_Brake);//Coast);
+				HAL_NEUTRAL_BRAKE);//Coast);
 		break;
 	case COMMAND_ROBOT_STATE_DISABLED:
 		conveyorMotor->Set(0.0);
@@ -75,13 +90,27 @@ void Conveyor::OnStateChange() {
 }
 
 void Conveyor::Run() {
+	//RhsRobot only sends a held button when it changes, keep watching for the back stop while it is held
+
+	if ((localMessage.command == COMMAND_SYSTEM_MSGTIMEOUT) && ISTELEOPERATED
+			&& (heldCommand == COMMAND_CONVEYOR_RUN_BCK))
+	{
+		localMessage.command = COMMAND_CONVEYOR_RUN_BCK;
+	}
+	else if ((localMessage.command == COMMAND_CONVEYOR_RUN_FWD)
+			|| (localMessage.command == COMMAND_CONVEYOR_RUN_BCK)
+			|| (localMessage.command == COMMAND_CONVEYOR_STOP))
+	{
+		heldCommand = localMessage.command;
+	}
+
 	switch (localMessage.command)
 	//Reads the message command
 	{
 	case COMMAND_CONVEYOR_RUN_FWD:
 		//SmartDashboard::PutString("Conveyor CMD", "CONVEYOR_RUN_FWD");
 		conveyorMotor->ConfigLimitMode(
-				CANSpeedController::kLimitMode_SrxDisableSwitchInputs);
+				HAL_LIMIT_SWITCH_INPUTS_DISABLED);
 		conveyorMotor->Set(fConveyorSpeedFwd);
 		break;
 
@@ -91,14 +120,14 @@ void Conveyor::Run() {
 		//SmartDashboard::PutString("Conveyor CMD", "CONVEYOR_RUN_BCK");
 		//if(localMessage.params.conveyorParams.bButtonWentDownEvent)
 		//{
-		if (!conveyorMotor->IsFwdLimitSwitchClosed())
+		if (!GetSensorBool(iFwdLimit))
 		{
 			//if there is a tote blocking the back, see if bBackStopEnable is false
 			if (!bBackStopEnable)
 			{
 				//printf("button down: closed, disable switch\n");
 				conveyorMotor->ConfigLimitMode(
-						CANSpeedController::kLimitMode_SrxDisableSwitchInputs);
+						HAL_LIMIT_SWITCH_INPUTS_DISABLED);
 				conveyorMotor->Set(fConveyorSpeed);
 			}
 		}
@@ -107,7 +136,7 @@ void Conveyor::Run() {
 		{
 			//printf("button down: open, enable switch\n");
 			conveyorMotor->ConfigLimitMode(
-					CANSpeedController::kLimitMode_SwitchInputsOnly);
+					HAL_LIMIT_SWITCH_INPUTS_ONLY);
 			conveyorMotor->Set(fConveyorSpeed);
 			bBackStopEnable = true;
 		}
@@ -130,7 +159,7 @@ void Conveyor::Run() {
 	case COMMAND_CONVEYOR_SEEK_TOTE_FRONT:
 		pAutoTimer->Reset();
 		responseCommand = COMMAND_AUTONOMOUS_RESPONSE_OK;
-		while (conveyorMotor->IsRevLimitSwitchClosed() && ISAUTO)
+		while (GetSensorBool(iRevLimit) && ISAUTO && !SafeStopRequested())
 		{
 			//TIMEOUT
 			if(pAutoTimer->Get() > localMessage.params.autonomous.timeout)
@@ -140,6 +169,9 @@ void Conveyor::Run() {
 				break;
 			}
 			conveyorMotor->Set(fLoadSpeed);
+			Beat();
+			pHal->GetClock()->Wait(0.01);
+			SampleSensors();
 		}
 		SendCommandResponse(responseCommand);
 		break;
@@ -147,7 +179,7 @@ void Conveyor::Run() {
 	case COMMAND_CONVEYOR_SEEK_TOTE_BACK:
 		pAutoTimer->Reset();
 		responseCommand = COMMAND_AUTONOMOUS_RESPONSE_OK;
-		while (conveyorMotor->IsFwdLimitSwitchClosed() && ISAUTO)
+		while (GetSensorBool(iFwdLimit) && ISAUTO && !SafeStopRequested())
 		{
 			//TIMEOUT
 			if(pAutoTimer->Get() > localMessage.params.autonomous.timeout)
@@ -157,6 +189,9 @@ void Conveyor::Run() {
 				break;
 			}
 			conveyorMotor->Set(-fLoadSpeed);
+			Beat();
+			pHal->GetClock()->Wait(0.01);
+			SampleSensors();
 		}
 		SendCommandResponse(responseCommand);
 		break;
@@ -165,7 +200,7 @@ void Conveyor::Run() {
 		pAutoTimer->Reset();
 		responseCommand = COMMAND_AUTONOMOUS_RESPONSE_OK;
 		//convey backwards until back sensor
-		while (conveyorMotor->IsFwdLimitSwitchClosed() && ISAUTO)
+		while (GetSensorBool(iFwdLimit) && ISAUTO && !SafeStopRequested())
 		{
 			//TIMEOUT
 			if(pAutoTimer->Get() > localMessage.params.autonomous.timeout)
@@ -175,6 +210,9 @@ void Conveyor::Run() {
 				break;
 			}
 			conveyorMotor->Set(fLoadSpeed);
+			Beat();
+			pHal->GetClock()->Wait(0.01);
+			SampleSensors();
 		}
 		conveyorMotor->Set(0);
 		SendCommandResponse(responseCommand);
@@ -184,7 +222,7 @@ void Conveyor::Run() {
 		pAutoTimer->Reset();
 		responseCommand = COMMAND_AUTONOMOUS_RESPONSE_OK;
 		//convey forwards until forward sensor
-		while (conveyorMotor->IsRevLimitSwitchClosed() && ISAUTO)
+		while (GetSensorBool(iRevLimit) && ISAUTO && !SafeStopRequested())
 		{
 			//TIMEOUT
 			if(pAutoTimer->Get() > localMessage.params.autonomous.timeout)
@@ -194,6 +232,9 @@ void Conveyor::Run() {
 				break;
 			}
 			conveyorMotor->Set(-fLoadSpeed);
+			Beat();
+			pHal->GetClock()->Wait(0.01);
+			SampleSensors();
 		}
 		conveyorMotor->Set(0);
 		SendCommandResponse(responseCommand);
@@ -202,10 +243,13 @@ void Conveyor::Run() {
 	case COMMAND_CONVEYOR_SHIFTTOTES_FWD:
 		pAutoTimer->Reset();
 		//move the stack forward until the back sensor is unblocked
-		while (!conveyorMotor->IsFwdLimitSwitchClosed() && ISAUTO
+		while (!GetSensorBool(iFwdLimit) && ISAUTO && !SafeStopRequested()
 				&& pAutoTimer->Get()< 3.0)
 		{
 			conveyorMotor->Set(-fShiftSpeed);
+			Beat();
+			pHal->GetClock()->Wait(0.01);
+			SampleSensors();
 		}
 		conveyorMotor->Set(0);
 		break;
@@ -213,10 +257,13 @@ void Conveyor::Run() {
 	case COMMAND_CONVEYOR_SHIFTTOTES_BCK:
 		pAutoTimer->Reset();
 		//move the stack forward until the back sensor is blocked
-		while (conveyorMotor->IsFwdLimitSwitchClosed() && ISAUTO
+		while (GetSensorBool(iFwdLimit) && ISAUTO && !SafeStopRequested()
 				&& pAutoTimer->Get()< 3.0)
 		{
 			conveyorMotor->Set(fShiftSpeed);
+			Beat();
+			pHal->GetClock()->Wait(0.01);
+			SampleSensors();
 		}
 		conveyorMotor->Set(0);
 		break;
@@ -224,10 +271,12 @@ void Conveyor::Run() {
 	case COMMAND_CONVEYOR_PUSHTOTES_BCK:
 		pAutoTimer->Reset();
 
-		while (ISAUTO && pAutoTimer->Get()< 0.25)
+		while (ISAUTO && !SafeStopRequested() && pAutoTimer->Get()< 0.25)
 		{
 			conveyorMotor->Set(fShiftSpeed);
 			//conveyorMotor->Set(fPushSpeed);
+			Beat();
+			pHal->GetClock()->Wait(0.01);
 		}
 		conveyorMotor->Set(0);
 		break;
@@ -242,13 +291,16 @@ void Conveyor::Run() {
 
 	case COMMAND_CONVEYOR_DEPOSITTOTES_BCK:
 		conveyorMotor->ConfigLimitMode(
-				CANSpeedController::kLimitMode_SrxDisableSwitchInputs);
+				HAL_LIMIT_SWITCH_INPUTS_DISABLED);
 		responseCommand = COMMAND_AUTONOMOUS_RESPONSE_OK;
 		//move the stack backwards until the both sensors are unblocked
-		while (ISAUTO && (!conveyorMotor->IsRevLimitSwitchClosed()
-				|| !conveyorMotor->IsFwdLimitSwitchClosed()))
+		while (ISAUTO && !SafeStopRequested() && (!GetSensorBool(iRevLimit)
+				|| !GetSensorBool(iFwdLimit)))
 		{
 			conveyorMotor->Set(fDepositSpeed);
+			Beat();
+			pHal->GetClock()->Wait(0.01);
+			SampleSensors();
 		}
 		conveyorMotor->Set(0);
 		SendCommandResponse(responseCommand);
@@ -262,7 +314,7 @@ void Conveyor::Run() {
 
 	if(bReplyFrontSensor)
 	{
-		if(!conveyorMotor->IsRevLimitSwitchClosed())
+		if(!GetSensorBool(iRevLimit))
 		{
 			SendCommandResponse(COMMAND_AUTONOMOUS_RESPONSE_OK);
 			bReplyFrontSensor = false;
@@ -270,7 +322,7 @@ void Conveyor::Run() {
 	}
 	if(bReplyBackSensor)
 	{
-		if(!conveyorMotor->IsFwdLimitSwitchClosed())
+		if(!GetSensorBool(iFwdLimit))
 		{
 			SendCommandResponse(COMMAND_AUTONOMOUS_RESPONSE_OK);
 			bReplyBackSensor = false;
@@ -278,17 +330,14 @@ void Conveyor::Run() {
 	}
 
 
-	//Put out information
-	if (pRemoteUpdateTimer->Get() > 0.2)
-	{
-		pRemoteUpdateTimer->Reset();
-		SmartDashboard::PutBoolean("Pallet Jack Front IR",
-				!conveyorMotor->IsRevLimitSwitchClosed());
-		SmartDashboard::PutBoolean("Pallet Jack Back IR",
-				!conveyorMotor->IsFwdLimitSwitchClosed());
-	}
-	//this needs to be realtime
-	SmartDashboard::PutBoolean("Back Stop Enabled",bBackStopEnable);
+	FlightRecorder::Record(flightConveyorMotor, GetSensor(iMotorOutput));
+	FlightRecorder::Record(flightFrontIR, !GetSensorBool(iRevLimit));
+	FlightRecorder::Record(flightBackIR, !GetSensorBool(iFwdLimit));
+
+	//Put out information, the publisher only sends what changed
+	Telemetry::PutBoolean(keyFrontIR, !GetSensorBool(iRevLimit));
+	Telemetry::PutBoolean(keyBackIR, !GetSensorBool(iFwdLimit));
+	Telemetry::PutBoolean(keyBackStop, bBackStopEnable);
 }
 
 bool Conveyor::RevLimitSwitchClosed()
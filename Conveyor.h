@@ -14,11 +14,13 @@
 
 #include "ComponentBase.h"			//For ComponentBase class
 #include "RobotMessage.h"
+#include "Telemetry.h"
+#include "FlightRecorder.h"
 
 class Conveyor: public ComponentBase
 {
 public:
-	Conveyor();
+	Conveyor(Hal *pHal);
 	virtual ~Conveyor();
 	static void *StartTask(void *pThis)
 	{
@@ -38,7 +40,10 @@ private:
 	 * fwdLimit - at the back
 	 */
 
-	CANTalon *conveyorMotor;
+	HalMotor *conveyorMotor;
+	int iRevLimit;		//sensor snapshot indexes, see ComponentBase::DeclareSensor()
+	int iFwdLimit;
+	int iMotorOutput;
 	//Timer *pAutoTimer;IN COMPONENT BASE
 	const float fConveyorSpeed = 0.75;//1.0;
 	const float fConveyorSpeedBack = 0.5;
@@ -49,9 +54,16 @@ private:
 	const float fPushSpeed = 0.25;
 	const float fDepositSpeed = 1.0;
 	bool bBackStopEnable;
+	MessageCommand heldCommand;	//the last run or stop from the buttons
 	bool bReplyFrontSensor = false; //reply to auto when the front sensor breaks
 	bool bReplyBackSensor = false; //reply to auto when the back sensor breaks
 	MessageCommand responseCommand;
+	TelemetryKey keyFrontIR;
+	TelemetryKey keyBackIR;
+	TelemetryKey keyBackStop;
+	FlightChannel flightConveyorMotor;
+	FlightChannel flightFrontIR;
+	FlightChannel flightBackIR;
 
 	void OnStateChange();
 	void Run();
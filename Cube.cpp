@@ -21,38 +21,46 @@
 //Please DO NOT modify the +/- motor value notes above with out FULL TESTING
 #include "Cube.h"
 
-Cube::Cube() :
-		ComponentBase(CUBE_TASKNAME, CUBE_QUEUE, CUBE_PRIORITY) {
+Cube::Cube(Hal *pHal) :
+		ComponentBase(pHal, CUBE_TASKNAME, CUBE_QUEUE, CUBE_PRIORITY) {
 
-	clickerMotor = new CANTalon(CAN_CUBE_CLICKER);
+	clickerMotor = pHal->NewMotor(CAN_CUBE_CLICKER, "Clicker");
 	wpi_assert(clickerMotor);
 	//clickerMotor->SetVoltageRampRate(120.0);
 	clickerMotor->ConfigNeutralMode(
-			CANSpeedController::NeutralMode::kNeutralMode_Brake);
+			HAL_NEUTRAL_BRAKE);
 	clickerMotor->ConfigLimitMode(
-			CANSpeedController::kLimitMode_SwitchInputsOnly);
+			HAL_LIMIT_SWITCH_INPUTS_ONLY);
 
 	// run the intake motor unless a tote has broken the beam
 
-	intakeMotor = new CANTalon(CAN_CUBE_INTAKE);
+	intakeMotor = pHal->NewMotor(CAN_CUBE_INTAKE, "Intake");
 	wpi_assert(intakeMotor);
 	intakeMotor->ConfigRevLimitSwitchNormallyOpen(false);
 	intakeMotor->ConfigLimitMode(
-			CANSpeedController::kLimitMode_SwitchInputsOnly);
+			HAL_LIMIT_SWITCH_INPUTS_ONLY);
 
 	wpi_assert(clickerMotor->IsAlive());
 	wpi_assert(intakeMotor->IsAlive());
 
+	iIntakeIR = DeclareSensor(intakeMotor, SENSOR_REV_LIMIT);
+	iClickerBottom = DeclareSensor(clickerMotor, SENSOR_REV_LIMIT);
+	iClickerTop = DeclareSensor(clickerMotor, SENSOR_FWD_LIMIT);
+	iTopIR = DeclareSensor(clickerMotor, SENSOR_QUAD_B);
+	iClickerVoltage = DeclareSensor(clickerMotor, SENSOR_BUS_VOLTAGE);
+	iClickerOutput = DeclareSensor(clickerMotor, SENSOR_OUTPUT);
+	SampleSensors();
+
 	clickerLastState = STATE_CLICKER_TOP;
 	bEnableAutoCycle = false;
 	bPrepareToRemove = false;
 	fClickerPaused = 0.0;
 	bFirstTote = true;
 
-	irBlocked = !intakeMotor->IsRevLimitSwitchClosed();
-	clickerHallEffectBottom = clickerMotor->IsRevLimitSwitchClosed();
-	clickerHallEffectTop = clickerMotor->IsFwdLimitSwitchClosed();
-	topBlocked = (clickerMotor->GetPinStateQuadB() == 1);
+	irBlocked = !GetSensorBool(iIntakeIR);
+	clickerHallEffectBottom = GetSensorBool(iClickerBottom);
+	clickerHallEffectTop = GetSensorBool(iClickerTop);
+	topBlocked = GetSensorBool(iTopIR);
 
 	pSafetyTimer = new Timer();
 	pSafetyTimer->Start();
@@ -63,10 +71,17 @@ Cube::Cube() :
 	pGateTimer = new Timer();
 	pGateTimer->Start();
 
+	keyTopIR = Telemetry::Register("Last Tote IR", TELEMETRY_BOOLEAN);
+	keyIntakeIR = Telemetry::Register("Cube IR", TELEMETRY_BOOLEAN);
+	keyClickerTop = Telemetry::Register("Clicker @ Top", TELEMETRY_BOOLEAN);
+	keyClickerBottom = Telemetry::Register("Clicker @ Bottom", TELEMETRY_BOOLEAN);
+	keyClickerVoltage = Telemetry::Register("Clicker Voltage", TELEMETRY_NUMBER);
+	keyAutoCycle = Telemetry::Register("Cube Autocycle", TELEMETRY_BOOLEAN);
+
 	pTask = new Task(CUBE_TASKNAME, (FUNCPTR) &Cube::StartTask, CUBE_PRIORITY,
 			CUBE_STACKSIZE);
 	wpi_assert(pTask);
-	pTask->Start((int) this);
+	pTask->Start((intptr_t) this);
 }
 
 Cube::~Cube() {
@@ -205,7 +220,7 @@ void Cube::Run() {
 		{
 			//SmartDashboard::PutString("Cube CMD", "CUBEAUTOCYCLE_PAUSE");
 			bEnableAutoCycle = false;
-			fClickerPaused = clickerMotor->Get();
+			fClickerPaused = GetSensor(iClickerOutput);
 			//intakeMotor->Set(fIntakeStop);
 			clickerMotor->Set(fClickerStop);
 			pSafetyTimer->Reset();
@@ -249,23 +264,23 @@ void Cube::Run() {
 		pSafetyTimer->Reset();
 	}
 
-	// update the remote indicators periodically so we do not create too much CAN traffic
-	// or Smart Dashboard traffic either, for that matter (This is really what kills)
+	// update the remote indicators periodically, the sensors come from the snapshot
+	// and the telemetry publisher decides when the Smart Dashboard hears about it
 	// NOTE: this segment runs only if we are NOT autocycling
 	if((pRemoteUpdateTimer->Get() > 0.15))//&& !bEnableAutoCycle)
 	{
 		pRemoteUpdateTimer->Reset();
-		irBlocked = !intakeMotor->IsRevLimitSwitchClosed();
-		clickerHallEffectBottom = clickerMotor->IsRevLimitSwitchClosed();
-		clickerHallEffectTop = clickerMotor->IsFwdLimitSwitchClosed();
-		topBlocked = (clickerMotor->GetPinStateQuadB() == 1);
-
-		SmartDashboard::PutBoolean("Last Tote IR", topBlocked);
-		SmartDashboard::PutBoolean("Cube IR", irBlocked);
-		SmartDashboard::PutBoolean("Clicker @ Top", clickerHallEffectTop);
-		SmartDashboard::PutBoolean("Clicker @ Bottom", clickerHallEffectBottom);
-		SmartDashboard::PutNumber("Clicker Voltage", clickerMotor->GetBusVoltage());
-		SmartDashboard::PutBoolean("Cube Autocycle", bEnableAutoCycle);
+		irBlocked = !GetSensorBool(iIntakeIR);
+		clickerHallEffectBottom = GetSensorBool(iClickerBottom);
+		clickerHallEffectTop = GetSensorBool(iClickerTop);
+		topBlocked = GetSensorBool(iTopIR);
+
+		Telemetry::PutBoolean(keyTopIR, topBlocked);
+		Telemetry::PutBoolean(keyIntakeIR, irBlocked);
+		Telemetry::PutBoolean(keyClickerTop, clickerHallEffectTop);
+		Telemetry::PutBoolean(keyClickerBottom, clickerHallEffectBottom);
+		Telemetry::Put(keyClickerVoltage, GetSensor(iClickerVoltage));
+		Telemetry::PutBoolean(keyAutoCycle, bEnableAutoCycle);
 	}
 
 	// run the state machine at a regular rate so we do not create too much CAN traffic
@@ -274,18 +289,18 @@ void Cube::Run() {
 	{
 		pAutoTimer->Reset();
 		pSafetyTimer->Reset();
-		SmartDashboard::PutBoolean("Cube Autocycle", bEnableAutoCycle);
-		SmartDashboard::PutNumber("Clicker Voltage", clickerMotor->GetBusVoltage());
+		Telemetry::PutBoolean(keyAutoCycle, bEnableAutoCycle);
+		Telemetry::Put(keyClickerVoltage, GetSensor(iClickerVoltage));
 
 		switch(clickerLastState) {
 
 		case STATE_CLICKER_TOP:
 			//SmartDashboard::PutString("Cube Clicker State", "TOP");
-			irBlocked = !intakeMotor->IsRevLimitSwitchClosed();
-			SmartDashboard::PutBoolean("Cube IR", irBlocked);
+			irBlocked = !GetSensorBool(iIntakeIR);
+			Telemetry::PutBoolean(keyIntakeIR, irBlocked);
 
-			topBlocked = (clickerMotor->GetPinStateQuadB() == 1);
-			SmartDashboard::PutBoolean("Last Tote IR", topBlocked);
+			topBlocked = GetSensorBool(iTopIR);
+			Telemetry::PutBoolean(keyTopIR, topBlocked);
 
 			if(topBlocked && irBlocked){
 				bPrepareToRemove = true;
@@ -323,7 +338,7 @@ void Cube::Run() {
 			break;
 
 		case STATE_CLICKER_FIRSTTOTEDELAY:
-			irBlocked = !intakeMotor->IsRevLimitSwitchClosed();
+			irBlocked = !GetSensorBool(iIntakeIR);
 
 			if(!irBlocked)
 			{
@@ -334,8 +349,8 @@ void Cube::Run() {
 
 		case STATE_CLICKER_LOWER:
 			//SmartDashboard::PutString("Cube Clicker State", "LOWER");
-			clickerHallEffectBottom = clickerMotor->IsRevLimitSwitchClosed();
-			SmartDashboard::PutBoolean("Clicker @ Bottom", clickerHallEffectBottom);
+			clickerHallEffectBottom = GetSensorBool(iClickerBottom);
+			Telemetry::PutBoolean(keyClickerBottom, clickerHallEffectBottom);
 
 			if(!clickerHallEffectBottom)
 			{
@@ -369,8 +384,8 @@ void Cube::Run() {
 
 		case STATE_CLICKER_BOTTOMHOLD:
 			//SmartDashboard::PutString("Cube Clicker State", "BOTTOMHOLD");
-			irBlocked = !intakeMotor->IsRevLimitSwitchClosed();
-			SmartDashboard::PutBoolean("Cube IR", irBlocked);
+			irBlocked = !GetSensorBool(iIntakeIR);
+			Telemetry::PutBoolean(keyIntakeIR, irBlocked);
 
 			if(!irBlocked)
 			{
@@ -399,8 +414,8 @@ void Cube::Run() {
 
 		case STATE_CLICKER_RAISE:
 			//SmartDashboard::PutString("Cube Clicker State", "RAISE");
-			clickerHallEffectTop = clickerMotor->IsFwdLimitSwitchClosed();
-			SmartDashboard::PutBoolean("Clicker @ Top", clickerHallEffectTop);
+			clickerHallEffectTop = GetSensorBool(iClickerTop);
+			Telemetry::PutBoolean(keyClickerTop, clickerHallEffectTop);
 
 			if(!clickerHallEffectTop)
 			{
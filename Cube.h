@@ -31,11 +31,12 @@ digraph Cube {
 #include "WPILib.h"
 #include "ComponentBase.h"
 #include "RobotParams.h"
+#include "Telemetry.h"
 
 class Cube : public ComponentBase
 {
 public:
-	Cube();
+	Cube(Hal *pHal);
 	virtual ~Cube();
 	static void *StartTask(void *pThis)
 	{
@@ -56,13 +57,25 @@ private:
 			STATE_CLICKER_DELAYAFTERCYLE
 	};
 
-	CANTalon *clickerMotor;
-	CANTalon *intakeMotor;
+	HalMotor *clickerMotor;
+	HalMotor *intakeMotor;
+	int iIntakeIR;		//sensor snapshot indexes, see ComponentBase::DeclareSensor()
+	int iClickerBottom;
+	int iClickerTop;
+	int iTopIR;
+	int iClickerVoltage;
+	int iClickerOutput;
 	Timer *pSafetyTimer;
 	//Timer *pAutoTimer;IN COMPONENT BASE
 	//Timer *pRemoteUpdateTimer;
 	Timer *pInterCycleTimer;
 	Timer *pGateTimer;
+	TelemetryKey keyTopIR;
+	TelemetryKey keyIntakeIR;
+	TelemetryKey keyClickerTop;
+	TelemetryKey keyClickerBottom;
+	TelemetryKey keyClickerVoltage;
+	TelemetryKey keyAutoCycle;
 
 	bool bEnableAutoCycle;
 	bool bPrepareToRemove;
@@ -26,40 +26,73 @@
 #include "RobotParams.h"
 using namespace std;
 
-Drivetrain::Drivetrain() :
-		ComponentBase(DRIVETRAIN_TASKNAME, DRIVETRAIN_QUEUE,
+Drivetrain::Drivetrain(Hal *pHal) :
+		ComponentBase(pHal, DRIVETRAIN_TASKNAME, DRIVETRAIN_QUEUE,
 				DRIVETRAIN_PRIORITY) {
 
-	leftMotor = new CANTalon(CAN_DRIVETRAIN_LEFT_MOTOR);
-	rightMotor = new CANTalon(CAN_DRIVETRAIN_RIGHT_MOTOR);
+	leftMotor = pHal->NewMotor(CAN_DRIVETRAIN_LEFT_MOTOR, "Left Drive");
+	rightMotor = pHal->NewMotor(CAN_DRIVETRAIN_RIGHT_MOTOR, "Right Drive");
 
 	wpi_assert(leftMotor && rightMotor);
 
-	leftMotor->SetControlMode(CANSpeedController::kPercentVbus);
-	rightMotor->SetControlMode(CANSpeedController::kPercentVbus);
+	leftMotor->SetControlMode(HAL_CONTROL_PERCENT_VBUS);
+	rightMotor->SetControlMode(HAL_CONTROL_PERCENT_VBUS);
 	leftMotor->SetVoltageRampRate(120.0);
 	rightMotor->SetVoltageRampRate(120.0);
 
 	wpi_assert(leftMotor->IsAlive());
 	wpi_assert(rightMotor->IsAlive());
 
-	//toteSensor = new DigitalInput(DIO_DRIVETRAIN_BEAM_BREAK);
+	//toteSensor = pHal->NewDigitalInput(DIO_DRIVETRAIN_BEAM_BREAK);
 
 	//pAutoTimer = new Timer();IN COMPONENT BASE
 	//pAutoTimer->Start();
 
-	gyro = new ADXRS453Z;
+	gyro = new ADXRS453Z(pHal->NewSpi(SPI_GYRO));
 	wpi_assert(gyro);
 	gyro->Start();
 
-	//encoder = new Encoder(0, 1, false, Encoder::k4X);
-	//encoder->SetDistancePerPulse(fEncoderRatio); //diameter*pi/encoder_resolution
+	fusion = new SensorFusion(gyro, pHal->NewAccelerometer());
+	wpi_assert(fusion);
+	fusion->Subscribe(DRIVETRAIN_QUEUE);
+
+	pStationaryTimer = new Timer();
+	pStationaryTimer->Start();
+
+	flightLeftMotor = FlightRecorder::Register("Drivetrain Left Motor");
+	flightRightMotor = FlightRecorder::Register("Drivetrain Right Motor");
+	flightGyroAngle = FlightRecorder::Register("Drivetrain Gyro Angle");
+	flightEncoder = FlightRecorder::Register("Drivetrain Encoder");
+
+	keyHeadingHold = Telemetry::Register("Heading Hold", TELEMETRY_BOOLEAN);
+	keyGyroAngle = Telemetry::Register("Gyro Angle", TELEMETRY_NUMBER);
+	keyGyroMissedDeadlines = Telemetry::Register("Gyro Missed Deadlines", TELEMETRY_NUMBER);
+	keyGyroCalibrated = Telemetry::Register("Gyro Calibrated", TELEMETRY_BOOLEAN);
+	keyGyroTemperature = Telemetry::Register("Gyro Temperature", TELEMETRY_NUMBER);
+	keyGyroBias = Telemetry::Register("Gyro Bias", TELEMETRY_NUMBER);
+	keyGyroBiasVariance = Telemetry::Register("Gyro Bias Variance", TELEMETRY_NUMBER);
+	keyGyroHealth = Telemetry::Register("Gyro Health", TELEMETRY_NUMBER);
+	keyPitch = Telemetry::Register("Pitch", TELEMETRY_NUMBER);
+	keyRoll = Telemetry::Register("Roll", TELEMETRY_NUMBER);
+	keyImpacts = Telemetry::Register("Impacts", TELEMETRY_NUMBER);
+	keyGyroSpiErrors = Telemetry::Register("Gyro SPI Errors", TELEMETRY_NUMBER);
+	keyGyroParityErrors = Telemetry::Register("Gyro Parity Errors", TELEMETRY_NUMBER);
+	keyGyroStatusErrors = Telemetry::Register("Gyro Status Errors", TELEMETRY_NUMBER);
+	keyGyroFaultErrors = Telemetry::Register("Gyro Fault Errors", TELEMETRY_NUMBER);
+	keyGyroRepeatedFrames = Telemetry::Register("Gyro Repeated Frames", TELEMETRY_NUMBER);
+	keyAngleError = Telemetry::Register("Angle Error", TELEMETRY_NUMBER);
+	keyTurnSpeed = Telemetry::Register("Turn Speed", TELEMETRY_NUMBER);
+	keyAngleAdjustment = Telemetry::Register("Angle Adjustment", TELEMETRY_NUMBER);
+
+	encoder = NULL;
+	//encoder = pHal->NewEncoder(DIO_DRIVETRAIN_ENCODER_A, DIO_DRIVETRAIN_ENCODER_B, false);
+	//encoder->SetDistancePerPulse(DRIVETRAIN_ENCODER_RATIO);
 	//wpi_assert(encoder);
 
 	pTask = new Task(DRIVETRAIN_TASKNAME, (FUNCPTR) &Drivetrain::StartTask,
 			DRIVETRAIN_PRIORITY, DRIVETRAIN_STACKSIZE);
 	wpi_assert(pTask);
-	pTask->Start((int) this);
+	pTask->Start((intptr_t) this);
 }
 
 Drivetrain::~Drivetrain()			//Destructor
@@ -67,7 +100,9 @@ Drivetrain::~Drivetrain()			//Destructor
 	delete (pTask);
 	delete leftMotor;
 	delete rightMotor;
+	delete fusion;
 	delete gyro;
+	delete pStationaryTimer;
 	//delete encoder;
 }
 
@@ -91,11 +126,17 @@ void Drivetrain::OnStateChange()			//Handles state changes
 	case COMMAND_ROBOT_STATE_TELEOPERATED:
 		leftMotor->Set(0.0);
 		rightMotor->Set(0.0);
+		bTeleopDrive = false;
+		bHoldingHeading = false;
+		Telemetry::PutBoolean(keyHeadingHold, bHeadingHoldEnabled);
 		break;
 
 	case COMMAND_ROBOT_STATE_DISABLED:
 		leftMotor->Set(0.0);
 		rightMotor->Set(0.0);
+		bTeleopDrive = false;
+		//keep whatever the gyro bias has been refined to for the next boot
+		gyro->SaveCalibration();
 		break;
 
 	case COMMAND_ROBOT_STATE_UNKNOWN:
@@ -114,19 +155,13 @@ void Drivetrain::OnStateChange()			//Handles state changes
 void Drivetrain::Run() {
 	switch(localMessage.command) {
 	case COMMAND_DRIVETRAIN_DRIVE_TANK:
-		//SmartDashboard::PutString("Drivetrain CMD", "DRIVETRAIN_DRIVE_TANK");
-		//speed reduction will be controlled by RhsRobot. Power curve is done with raw joystick value
-		bDrivingStraight = false;
-		bTurning = false;
-		leftMotor->Set(localMessage.params.tankDrive.left);
-		rightMotor->Set(-localMessage.params.tankDrive.right);
-		break;
 	case COMMAND_DRIVETRAIN_DRIVE_ARCADE:
-		//SmartDashboard::PutString("Drivetrain CMD", "DRIVETRAIN_DRIVE_ARCADE");
+	case COMMAND_DRIVETRAIN_DRIVE_CURVATURE:
+		//speed reduction will be controlled by RhsRobot. Power curve is done with raw joystick value
 		bDrivingStraight = false;
 		bTurning = false;
-		ArcadeDrive(localMessage.params.arcadeDrive.x,
-				localMessage.params.arcadeDrive.y);
+		bTeleopDrive = true;
+		TeleopDrive(localMessage);
 		break;
 
 	case COMMAND_DRIVETRAIN_DRIVE_STRAIGHT:
@@ -137,8 +172,11 @@ void Drivetrain::Run() {
 	case COMMAND_AUTONOMOUS_RUN:	//when auto starts
 		//SmartDashboard::PutString("Drivetrain CMD", "AUTONOMOUS_RUN");
 		//reset stored values
+		bTeleopDrive = false;
 		bDrivingStraight = false;
 		bTurning = false;
+		bFrontLoadTote = false;
+		bBackLoadTote = false;
 		left = 0;
 		right = 0;
 		pAutoTimer->Reset();
@@ -150,6 +188,8 @@ void Drivetrain::Run() {
 		//reset all auto variables
 		bDrivingStraight = false;
 		bTurning = false;
+		bFrontLoadTote = false;
+		bBackLoadTote = false;
 		left = 0;
 		right = 0;
 		leftMotor->Set(left);
@@ -173,17 +213,34 @@ void Drivetrain::Run() {
 		StartTurn(localMessage.params.autonomous.turnAngle,localMessage.params.autonomous.timeout);
 		break;
 
-	/*case COMMAND_DRIVETRAIN_SEEK_TOTE:
+	case COMMAND_DRIVETRAIN_SEEK_TOTE:
 		SeekTote(localMessage.params.autonomous.timein,localMessage.params.autonomous.timeout);
-		break;*/
+		break;
+
+	case COMMAND_SENSORFUSION_IMPACT:
+		//a seek ran into the tote, no point pushing on until the timeout
+		//any other drive carries on, a bump shouldn't cut a STRAIGHT short
+		if(bDrivingStraight && (bFrontLoadTote || bBackLoadTote))
+		{
+			bDrivingStraight = false;
+			bFrontLoadTote = false;
+			bBackLoadTote = false;
+			left = 0.0;
+			right = 0.0;
+			leftMotor->Set(0.0);
+			rightMotor->Set(0.0);
+		}
+		break;
 
 	case COMMAND_DRIVETRAIN_STOP:
 		//SmartDashboard::PutString("Drivetrain CMD", "DRIVETRAIN_STOP");
 		//reset all auto variables
+		bTeleopDrive = false;
 		bDrivingStraight = false;
 		bTurning = false;
 		bFrontLoadTote = false;
 		bBackLoadTote = false;
+		bHoldingHeading = false;
 		left = 0.0;
 		right = 0.0;
 		leftMotor->Set(left);
@@ -213,8 +270,22 @@ void Drivetrain::Run() {
 		bKeepAligned = false;
 		break;
 
+	case COMMAND_DRIVETRAIN_TOGGLE_HEADINGHOLD:
+		bHeadingHoldEnabled = !bHeadingHoldEnabled;
+		bHoldingHeading = false;
+		Telemetry::PutBoolean(keyHeadingHold, bHeadingHoldEnabled);
+		break;
+
 	case COMMAND_SYSTEM_MSGTIMEOUT:
 		//SmartDashboard::PutString("Drivetrain CMD", "SYSTEM_MSGTIMEOUT");
+		//RhsRobot only sends the sticks when they move, keep heading hold working in between
+		//the sides are reused rather than mixed again, the quick stop accumulator only steps on driver input
+		if(bTeleopDrive && ISTELEOPERATED)
+		{
+			DriveSides(fTeleopLeft, fTeleopRight);
+		}
+		break;
+
 	default:
 		break;
 	}
@@ -229,19 +300,186 @@ void Drivetrain::Run() {
 		IterateTurn();
 	}
 
+	UpdateStationary();
+
+	FlightRecorder::Record(flightLeftMotor, leftMotor->Get());
+	FlightRecorder::Record(flightRightMotor, rightMotor->Get());
+	FlightRecorder::Record(flightGyroAngle, gyro->GetAngle());
+
+	if(encoder)
+	{
+		FlightRecorder::Record(flightEncoder, encoder->GetDistance());
+	}
+
 	//Put out information
 	if (pRemoteUpdateTimer->Get() > 0.2)
 	{
 		pRemoteUpdateTimer->Reset();
 		//SmartDashboard::PutBoolean("Tote Detector", toteSensor->Get());
-		//gyro reading is truncated for the sake of the CSV file.
-		SmartDashboard::PutNumber("Gyro Angle", TRUNC_THOU(gyro->GetAngle()));
+		Telemetry::Put(keyGyroAngle, gyro->GetAngle());
+		Telemetry::Put(keyGyroMissedDeadlines, gyro->GetMissedDeadlines());
+		Telemetry::PutBoolean(keyGyroCalibrated, gyro->IsCalibrated());
+		Telemetry::Put(keyGyroTemperature, gyro->GetTemperature());
+		Telemetry::Put(keyGyroBias, gyro->Offset());
+		Telemetry::Put(keyGyroBiasVariance, gyro->GetBiasVariance());
+		Telemetry::Put(keyGyroHealth, gyro->GetHealth());
+		Telemetry::Put(keyPitch, TRUNC_HUND(fusion->GetPitch()));
+		Telemetry::Put(keyRoll, TRUNC_HUND(fusion->GetRoll()));
+		Telemetry::Put(keyImpacts, fusion->GetImpactCount());
+
+		GyroErrorCounts gyroErrors = gyro->GetErrorCounts();
+		Telemetry::Put(keyGyroSpiErrors, gyroErrors.spi);
+		Telemetry::Put(keyGyroParityErrors, gyroErrors.parity);
+		Telemetry::Put(keyGyroStatusErrors, gyroErrors.status);
+		Telemetry::Put(keyGyroFaultErrors, gyroErrors.fault);
+		Telemetry::Put(keyGyroRepeatedFrames, gyroErrors.repeated);
 	}
 }
 
+/**
+ * Tells the gyro when the robot has been sitting still so it can keep refining
+ * its bias.  Still means both drive motors idle, the wheels not turning (when
+ * there is an encoder) and the accelerometer quiet, all for fStationaryTime.
+ * The accelerometer catches the robot being pushed or a lift moving on top of it.
+ */
+void Drivetrain::UpdateStationary() {
+	if((fabs(leftMotor->Get()) > fStationaryMotorDeadband)
+			|| (fabs(rightMotor->Get()) > fStationaryMotorDeadband)
+			|| (encoder && (fabs(encoder->GetRate()) > fStationaryEncoderRate))
+			|| (fusion->GetAccelVariance() > fStationaryAccelVariance))
+	{
+		pStationaryTimer->Reset();
+	}
+
+	gyro->SetStationary(pStationaryTimer->Get() > fStationaryTime);
+}
+
+///Drives from one of the stick commands
+void Drivetrain::TeleopDrive(const RobotMessage &message) {
+	switch(message.command) {
+	case COMMAND_DRIVETRAIN_DRIVE_TANK:
+		TankDrive(message.params.tankDrive.left, message.params.tankDrive.right);
+		break;
+
+	case COMMAND_DRIVETRAIN_DRIVE_ARCADE:
+		ArcadeDrive(message.params.arcadeDrive.x, message.params.arcadeDrive.y);
+		break;
+
+	case COMMAND_DRIVETRAIN_DRIVE_CURVATURE:
+		CurvatureDrive(message.params.curvatureDrive.throttle,
+				message.params.curvatureDrive.wheel,
+				message.params.curvatureDrive.bQuickTurn);
+		break;
+
+	default:
+		break;
+	}
+}
+
+void Drivetrain::TankDrive(float fLeft, float fRight) {
+	DriveSides(fLeft, fRight);
+}
+
 void Drivetrain::ArcadeDrive(float x, float y) {
-	leftMotor->Set(y + x / 2);
-	rightMotor->Set(-(y - x / 2));
+	DriveSides(y + x * fArcadeTurnGain, y - x * fArcadeTurnGain);
+}
+
+/**
+ * Curvature ("cheesy") drive: the wheel input sets how tightly the robot turns,
+ * not how fast, so turning feels the same at any throttle.  With quick turn the
+ * wheel spins the robot in place like arcade drive.  The quick stop accumulator
+ * cancels the rotation left over when a quick turn ends.
+ */
+void Drivetrain::CurvatureDrive(float throttle, float wheel, bool bQuickTurn) {
+	float fAngular;
+
+	if(bQuickTurn)
+	{
+		if(fabs(throttle) < fQuickStopThreshold)
+		{
+			fQuickStopAccumulator = (1.0 - fQuickStopAlpha) * fQuickStopAccumulator
+					+ fQuickStopAlpha * wheel * 2.0;
+		}
+
+		fAngular = wheel;
+	}
+	else
+	{
+		fAngular = fabs(throttle) * wheel * fCurvatureTurnGain - fQuickStopAccumulator;
+
+		// bleed the accumulator off a little each packet
+
+		if(fQuickStopAccumulator > 1.0)
+		{
+			fQuickStopAccumulator -= 1.0;
+		}
+		else if(fQuickStopAccumulator < -1.0)
+		{
+			fQuickStopAccumulator += 1.0;
+		}
+		else
+		{
+			fQuickStopAccumulator = 0.0;
+		}
+	}
+
+	DriveSides(throttle + fAngular, throttle - fAngular);
+}
+
+///Sends the mixed sides out through heading hold, and keeps them to repeat on a message timeout
+void Drivetrain::DriveSides(float fLeft, float fRight) {
+	fTeleopLeft = fLeft;
+	fTeleopRight = fRight;
+
+	HeadingHold(fLeft, fRight);
+	DesaturateDrive(fLeft, fRight);
+	leftMotor->Set(fLeft);
+	rightMotor->Set(-fRight);
+}
+
+/**
+ * Teleop heading hold.  Takes the left and right side commands (positive is
+ * forward on both sides) and, while the driver is translating without turning,
+ * replaces the residual turn with the same gyro correction StraightDriveLoop
+ * uses.  The heading is captured when the driver stops turning and is let go
+ * the moment turn input comes back.
+ */
+void Drivetrain::HeadingHold(float &fLeft, float &fRight) {
+	float fTranslate = (fLeft + fRight) / 2.0;
+	float fTurn = (fLeft - fRight) / 2.0;
+	float fAdjustment;
+
+	if(!bHeadingHoldEnabled || (fabs(fTurn) > fHeadingHoldTurnDeadband)
+			|| (fabs(fTranslate) < fHeadingHoldMinSpeed))
+	{
+		bHoldingHeading = false;
+		return;
+	}
+
+	if(!bHoldingHeading)
+	{
+		fHeldHeading = gyro->GetAngle();
+		bHoldingHeading = true;
+	}
+
+	// +angle requires more power on the right to fix, whichever way we are headed
+
+	fAdjustment = (gyro->GetAngle() - fHeldHeading) * recoverStrength;
+	ABLIMIT(fAdjustment, fMaxRecoverSpeed);
+
+	fLeft = fTranslate - fAdjustment * fabs(fTranslate);
+	fRight = fTranslate + fAdjustment * fabs(fTranslate);
+}
+
+///Scales both sides down together so the larger is at most 1.0 and the turn survives saturation.
+void Drivetrain::DesaturateDrive(float &fLeft, float &fRight) {
+	float fMagnitude = max(fabs(fLeft), fabs(fRight));
+
+	if(fMagnitude > 1.0)
+	{
+		fLeft /= fMagnitude;
+		fRight /= fMagnitude;
+	}
 }
 void Drivetrain::MeasuredMove(float speed, float targetDist) {
 #if 0
@@ -293,8 +531,8 @@ void Drivetrain::KeepAligned() {
 	leftMotor->Set(motorValue);
 	rightMotor->Set(motorValue);
 
-	SmartDashboard::PutNumber("Angle Error", error);
-	SmartDashboard::PutNumber("Turn Speed", motorValue);
+	Telemetry::Put(keyAngleError, error);
+	Telemetry::Put(keyTurnSpeed, motorValue);
 }
 
 void Drivetrain::Turn(float targetAngle, float timeout) {
@@ -305,7 +543,7 @@ void Drivetrain::Turn(float targetAngle, float timeout) {
 	pAutoTimer->Reset();
 
 	while (pAutoTimer->Get() < timeout
-			&& ISAUTO)
+			&& ISAUTO && !SafeStopRequested())
 	{
 		//if you don't disable this during non-auto, it will keep trying to turn during teleop. Not fun.
 		float degreesLeft = targetAngle - gyro->GetAngle();
@@ -322,8 +560,10 @@ void Drivetrain::Turn(float targetAngle, float timeout) {
 		leftMotor->Set(motorValue);
 		rightMotor->Set(motorValue);
 
-		SmartDashboard::PutNumber("Angle Error", degreesLeft);
-		SmartDashboard::PutNumber("Turn Speed", motorValue);
+		Telemetry::Put(keyAngleError, degreesLeft);
+		Telemetry::Put(keyTurnSpeed, motorValue);
+		Beat();
+		Wait(0.01);
 	}
 
 	leftMotor->Set(0);
@@ -331,23 +571,31 @@ void Drivetrain::Turn(float targetAngle, float timeout) {
 	command = COMMAND_AUTONOMOUS_RESPONSE_OK;
 	SendCommandResponse(command);
 
-	SmartDashboard::PutNumber("Angle Error", 0.0);
-	SmartDashboard::PutNumber("Turn Speed", 0.0);
+	Telemetry::Put(keyAngleError, 0.0);
+	Telemetry::Put(keyTurnSpeed, 0.0);
 }
 
+///Drives at the tote until we bump into it, impacts before timein are ignored
 void Drivetrain::SeekTote(float timein, float timeout) {
 	MessageCommand command = COMMAND_AUTONOMOUS_RESPONSE_ERROR;
+	unsigned uImpacts = fusion->GetImpactCount();
 	pAutoTimer->Reset();
+	gyro->Zero();
 
 	while ((pAutoTimer->Get() < timeout)
-			&& ISAUTO)
+			&& ISAUTO && !SafeStopRequested())
 	{
-		if (toteSensor->Get() && pAutoTimer->Get() > timein)
+		if (pAutoTimer->Get() <= timein)
+		{
+			uImpacts = fusion->GetImpactCount();
+		}
+		else if (fusion->GetImpactCount() != uImpacts)
 		{
 			command = COMMAND_AUTONOMOUS_RESPONSE_OK;
 			break;
 		}
 		StraightDriveLoop(fToteSeekSpeed);
+		Beat();
 		Wait(0.01);
 	}
 
@@ -428,8 +676,8 @@ void Drivetrain::IterateTurn(void)
 
 	leftMotor->Set(motorValue);
 	rightMotor->Set(motorValue);
-	SmartDashboard::PutNumber("Angle Error", 0.0);
-	SmartDashboard::PutNumber("Turn Speed", 0.0);
+	Telemetry::Put(keyAngleError, 0.0);
+	Telemetry::Put(keyTurnSpeed, 0.0);
 }
 
 void Drivetrain::StraightDrive(float speed, float time) {
@@ -439,9 +687,10 @@ void Drivetrain::StraightDrive(float speed, float time) {
 	gyro->Zero();
 
 	while ((pAutoTimer->Get() < time)
-			&& ISAUTO)
+			&& ISAUTO && !SafeStopRequested())
 	{
 		StraightDriveLoop(speed);
+		Beat();
 		Wait(0.01);
 	}
 
@@ -491,8 +740,8 @@ void Drivetrain::StraightDriveLoop(float speed) {
 	{
 		pRemoteUpdateTimer->Reset();
 		//SmartDashboard::PutBoolean("Tote Detector", toteSensor->Get());
-		SmartDashboard::PutNumber("Angle Adjustment", adjustment);
-		SmartDashboard::PutNumber("Gyro Angle", gyro->GetAngle());
+		Telemetry::Put(keyAngleAdjustment, adjustment);
+		Telemetry::Put(keyGyroAngle, gyro->GetAngle());
 	}
 }
 
@@ -16,15 +16,19 @@
 
 #include "ComponentBase.h"			//For ComponentBase class
 #include "ADXRS453Z.h"
+#include "SensorFusion.h"
+#include "Telemetry.h"
+#include "FlightRecorder.h"
 
 
 const float JOYSTICK_DEADZONE = 0.10;
 const float MAX_GAIN_PER_MESSAGE = 0.1;
+const float DRIVETRAIN_ENCODER_RATIO = 0.023009; //inches per pulse, diameter*pi/encoder_resolution : 1.875 * 3.14 / 256
 
 class Drivetrain : public ComponentBase
 {
 public:
-	Drivetrain();
+	Drivetrain(Hal *pHal);
 	~Drivetrain();
 	static void *StartTask(void *pThis)
 	{
@@ -34,14 +38,15 @@ public:
 
 	bool GetToteSensor();
 	bool GetGyroAngle();
+	SensorFusion *GetSensorFusion() { return(fusion); };
 private:
 
-	CANTalon* leftMotor;
-	CANTalon* rightMotor;
+	HalMotor *leftMotor;
+	HalMotor *rightMotor;
 	ADXRS453Z *gyro;
-	Encoder *encoder;
-	BuiltInAccelerometer accelerometer;
-	DigitalInput *toteSensor;
+	HalEncoder *encoder;
+	SensorFusion *fusion;
+	HalDigitalInput *toteSensor;
 	//Timer *pAutoTimer; //watches autonomous time and disables it if needed.IN COMPONENT BASE
 	//stores motor values during autonomous
 	float left = 0.0;
@@ -57,6 +62,63 @@ private:
 	bool bKeepAligned = false;
 	bool bDrivingStraight = false;
 	bool bTurning = false;
+	///the last stick command's mixed sides, before heading hold, repeated while the sticks are still and RhsRobot sends nothing
+	float fTeleopLeft = 0.0;
+	float fTeleopRight = 0.0;
+	bool bTeleopDrive = false;
+
+	///turn input is scaled by this in arcade drive, drivers are used to half
+	const float fArcadeTurnGain = 0.5;
+	///how hard curvature drive turns for a given wheel input at full throttle
+	const float fCurvatureTurnGain = 1.0;
+	///below this throttle, a quick turn winds up the quick stop accumulator
+	const float fQuickStopThreshold = 0.2;
+	///how quickly the quick stop accumulator follows the wheel
+	const float fQuickStopAlpha = 0.1;
+	///wheel applied while quick turning is remembered here and taken back out afterwards
+	float fQuickStopAccumulator = 0.0;
+
+	///teleop heading hold: the gyro keeps the robot straight while the driver is not turning
+	bool bHeadingHoldEnabled = true;
+	bool bHoldingHeading = false;
+	float fHeldHeading = 0.0;
+	///turn input (half the left/right difference) below this counts as not turning
+	const float fHeadingHoldTurnDeadband = 0.04;
+	///the heading is only captured once the robot is actually being driven
+	const float fHeadingHoldMinSpeed = 0.08;
+	//how long the motors must be idle before the gyro may refine its bias
+	const float fStationaryTime = 0.5;
+	//motor output treated as idle
+	const float fStationaryMotorDeadband = 0.01;
+	//encoder speed treated as idle, inches per second
+	const float fStationaryEncoderRate = 0.5;
+	//accelerometer magnitude variance treated as idle, g^2 (about 0.02g of shaking)
+	const float fStationaryAccelVariance = 0.0004;
+	Timer *pStationaryTimer;
+
+	TelemetryKey keyHeadingHold;
+	TelemetryKey keyGyroAngle;
+	TelemetryKey keyGyroMissedDeadlines;
+	TelemetryKey keyGyroCalibrated;
+	TelemetryKey keyGyroTemperature;
+	TelemetryKey keyGyroBias;
+	TelemetryKey keyGyroBiasVariance;
+	TelemetryKey keyGyroHealth;
+	TelemetryKey keyPitch;
+	TelemetryKey keyRoll;
+	TelemetryKey keyImpacts;
+	TelemetryKey keyGyroSpiErrors;
+	TelemetryKey keyGyroParityErrors;
+	TelemetryKey keyGyroStatusErrors;
+	TelemetryKey keyGyroFaultErrors;
+	TelemetryKey keyGyroRepeatedFrames;
+	TelemetryKey keyAngleError;
+	TelemetryKey keyTurnSpeed;
+	TelemetryKey keyAngleAdjustment;
+	FlightChannel flightLeftMotor;
+	FlightChannel flightRightMotor;
+	FlightChannel flightGyroAngle;
+	FlightChannel flightEncoder;
 
 	const float fFrontLoadSpeed = .250;
 	const float fBackLoadSpeed = -.250;
@@ -76,14 +138,18 @@ private:
 
 	//angle * mult = speed to be reduced by limit
 	const float turnSpeedLimit = .50;
-	const float fEncoderRatio = 0.023009;
-
-	//diameter*pi/encoder_resolution : 1.875 * 3.14 / 256
 
 	void OnStateChange();
 	void Run();
 	void Put();//for SmartDashboard
+	void TeleopDrive(const RobotMessage &);
+	void TankDrive(float, float);
 	void ArcadeDrive(float, float);
+	void CurvatureDrive(float, float, bool);
+	void DriveSides(float, float);
+	void DesaturateDrive(float &, float &);
+	void HeadingHold(float &, float &);
+	void UpdateStationary();
 	void MeasuredMove(float,float);
 	void Turn(float,float);
 	void KeepAligned();
@@ -0,0 +1,198 @@
+/** \file
+ * Implementation of the flight recorder.
+ *
+ * A writer claims a slot by adding to the head, clears the slot's sequence so a
+ * reader can't take the old contents for new, fills it in and then publishes the
+ * sequence.  Two writers can only meet in a slot if one of them is stalled for a
+ * whole lap of the ring, and then the sequence shows which one finished.
+ */
+
+#include "FlightRecorder.h"
+#include "Hal.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+static_assert(sizeof(FlightRecord) == 16, "FlightRecord is part of the file format");
+static_assert(sizeof(FlightRecorderHeader) <= FLIGHTRECORDER_HEADER_SIZE, "FlightRecorderHeader overruns the records");
+static_assert((FLIGHTRECORDER_RECORDS & (FLIGHTRECORDER_RECORDS - 1)) == 0, "FLIGHTRECORDER_RECORDS must be a power of 2");
+
+static std::atomic<FlightRecorderHeader *> pHeader(NULL);
+static FlightRecord *pRecords = NULL;
+static size_t uMapSize = 0;
+static bool bOpenFailed = false;
+static pthread_mutex_t register_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+///Returns the channel for szName, registering it if it is new, or -1 if there is no recorder
+FlightChannel FlightRecorder::Register(const char *szName)
+{
+	FlightChannel channel = -1;
+	uint32_t uChannels;
+
+	pthread_mutex_lock(&register_mutex);
+
+	if((pHeader.load(std::memory_order_relaxed) != NULL) || (!bOpenFailed && Open()))
+	{
+		FlightRecorderHeader *pFile = pHeader.load(std::memory_order_relaxed);
+
+		uChannels = pFile->uChannels.load(std::memory_order_relaxed);
+
+		for(uint32_t i = 0; i < uChannels; i++)
+		{
+			if(strncmp(pFile->szChannels[i], szName, FLIGHTRECORDER_NAME_LENGTH - 1) == 0)
+			{
+				channel = i;
+				break;
+			}
+		}
+
+		if((channel < 0) && (uChannels < (uint32_t)FLIGHTRECORDER_MAX_CHANNELS))
+		{
+			strncpy(pFile->szChannels[uChannels], szName, FLIGHTRECORDER_NAME_LENGTH - 1);
+			pFile->szChannels[uChannels][FLIGHTRECORDER_NAME_LENGTH - 1] = '\0';
+			pFile->uChannels.store(uChannels + 1, std::memory_order_release);
+			channel = uChannels;
+		}
+	}
+
+	pthread_mutex_unlock(&register_mutex);
+
+	return(channel);
+}
+
+void FlightRecorder::Record(FlightChannel channel, float fValue)
+{
+	FlightRecorderHeader *pFile = pHeader.load(std::memory_order_acquire);
+	double fNow;
+	uint32_t uIndex;
+	FlightRecord *pRecord;
+
+	if((channel < 0) || (pFile == NULL))
+	{
+		return;
+	}
+
+	fNow = Hal::Now();
+
+	uIndex = pFile->uHead.fetch_add(1, std::memory_order_relaxed);
+	pRecord = &pRecords[uIndex & (FLIGHTRECORDER_RECORDS - 1)];
+
+	pRecord->uSequence.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	pRecord->uTime = (uint32_t)((fNow - pFile->fStartTime) * 1.0e6);
+	pRecord->fValue = fValue;
+	pRecord->uChannel = (uint16_t)channel;
+	pRecord->uReserved = 0;
+	pRecord->uSequence.store(uIndex + 1, std::memory_order_release);
+}
+
+void FlightRecorder::RecordAt(FlightChannel channel, double fTime, float fValue)
+{
+	FlightRecorderHeader *pFile = pHeader.load(std::memory_order_acquire);
+	uint32_t uIndex;
+	FlightRecord *pRecord;
+
+	if((channel < 0) || (pFile == NULL))
+	{
+		return;
+	}
+
+	uIndex = pFile->uHead.fetch_add(1, std::memory_order_relaxed);
+	pRecord = &pRecords[uIndex & (FLIGHTRECORDER_RECORDS - 1)];
+
+	pRecord->uSequence.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	pRecord->uTime = (uint32_t)((fTime - pFile->fStartTime) * 1.0e6);
+	pRecord->fValue = fValue;
+	pRecord->uChannel = (uint16_t)channel;
+	pRecord->uReserved = 0;
+	pRecord->uSequence.store(uIndex + 1, std::memory_order_release);
+}
+
+void FlightRecorder::Flush()
+{
+	FlightRecorderHeader *pFile = pHeader.load(std::memory_order_acquire);
+
+	if(pFile != NULL)
+	{
+		msync(pFile, uMapSize, MS_ASYNC);
+	}
+}
+
+bool FlightRecorder::IsOpen()
+{
+	return(pHeader.load(std::memory_order_relaxed) != NULL);
+}
+
+uint32_t FlightRecorder::GetRecordCount()
+{
+	FlightRecorderHeader *pFile = pHeader.load(std::memory_order_acquire);
+
+	if(pFile == NULL)
+	{
+		return(0);
+	}
+
+	return(pFile->uHead.load(std::memory_order_relaxed));
+}
+
+///Keeps the last run's file, then creates, sizes and maps a new one.  Called with the register lock held.
+bool FlightRecorder::Open()
+{
+	int iFile;
+	void *pMap;
+
+	rename(FLIGHTRECORDER_FILEPATH, FLIGHTRECORDER_PREVIOUS_FILEPATH);
+
+	uMapSize = FLIGHTRECORDER_HEADER_SIZE + FLIGHTRECORDER_RECORDS * sizeof(FlightRecord);
+	iFile = open(FLIGHTRECORDER_FILEPATH, O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+	if(iFile < 0)
+	{
+		printf("Flight recorder can't create %s\n", FLIGHTRECORDER_FILEPATH);
+		bOpenFailed = true;
+		return(false);
+	}
+
+	if(ftruncate(iFile, uMapSize) < 0)
+	{
+		printf("Flight recorder can't size %s\n", FLIGHTRECORDER_FILEPATH);
+		close(iFile);
+		bOpenFailed = true;
+		return(false);
+	}
+
+	pMap = mmap(NULL, uMapSize, PROT_READ | PROT_WRITE, MAP_SHARED, iFile, 0);
+	close(iFile);
+
+	if(pMap == MAP_FAILED)
+	{
+		printf("Flight recorder can't map %s\n", FLIGHTRECORDER_FILEPATH);
+		bOpenFailed = true;
+		return(false);
+	}
+
+	// the file was just truncated, so every record already reads as sequence 0
+
+	FlightRecorderHeader *pNew = (FlightRecorderHeader *)pMap;
+
+	pNew->uMagic = FLIGHTRECORDER_MAGIC;
+	pNew->uVersion = FLIGHTRECORDER_VERSION;
+	pNew->uRecordSize = sizeof(FlightRecord);
+	pNew->uRecords = FLIGHTRECORDER_RECORDS;
+	pNew->iStartWallTime = time(NULL);
+	pNew->fStartTime = Hal::Now();
+	pNew->uHead.store(0, std::memory_order_relaxed);
+	pNew->uChannels.store(0, std::memory_order_relaxed);
+
+	pRecords = (FlightRecord *)((char *)pMap + FLIGHTRECORDER_HEADER_SIZE);
+	pHeader.store(pNew, std::memory_order_release);
+
+	printf("Flight recorder writing %s\n", FLIGHTRECORDER_FILEPATH);
+	return(true);
+}
@@ -0,0 +1,70 @@
+/** \file
+ * Definitions of the flight recorder, a binary log of every value worth looking at after a match.
+ *
+ * Each record is a timestamp, a channel and a float, 16 bytes, written into a
+ * ring in a memory mapped file.  Recording claims a slot with one atomic add and
+ * fills it in, so any task can record at full rate without a lock or a system
+ * call.  The file is mapped shared, so what was recorded is in the page cache the
+ * moment it is written and is still in the file if the robot program crashes;
+ * Flush() asks the kernel to write it out, which is done when the robot is
+ * disabled.  The previous run's file is kept as FLIGHTRECORDER_PREVIOUS_FILEPATH.
+ *
+ * Channels are registered by name and the names are kept in the file header, so
+ * a recording can be read back without this build of the code.  The structures
+ * below are the file format; they use fixed size types for the host tools.
+ */
+
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <stdint.h>
+#include <atomic>
+
+const char* const FLIGHTRECORDER_FILEPATH = "/home/lvuser/FlightRecorder.bin";
+const char* const FLIGHTRECORDER_PREVIOUS_FILEPATH = "/home/lvuser/FlightRecorder.prev.bin";
+const uint32_t FLIGHTRECORDER_MAGIC = 0x46534852; //"RHSF"
+const uint32_t FLIGHTRECORDER_VERSION = 2; //2 has room for 192 channels
+const uint32_t FLIGHTRECORDER_RECORDS = 1 << 20; //16MB, ten minutes at a few thousand records a second, must be a power of 2
+const int FLIGHTRECORDER_MAX_CHANNELS = 192;
+const int FLIGHTRECORDER_NAME_LENGTH = 32;
+const uint32_t FLIGHTRECORDER_HEADER_SIZE = 8192; //records start here, a whole number of pages
+
+typedef int FlightChannel;
+
+///One record in the ring
+struct FlightRecord {
+	std::atomic<uint32_t> uSequence;	//index of the record plus one, written last; anything else means torn or stale
+	uint32_t uTime;						//microseconds since the header start time
+	float fValue;
+	uint16_t uChannel;
+	uint16_t uReserved;
+};
+
+///The start of the file
+struct FlightRecorderHeader {
+	uint32_t uMagic;
+	uint32_t uVersion;
+	uint32_t uRecordSize;
+	uint32_t uRecords;					//capacity of the ring
+	int64_t iStartWallTime;				//time(NULL) when the file was opened
+	double fStartTime;					//HAL clock seconds at record time zero
+	std::atomic<uint32_t> uHead;		//records ever claimed, the next one goes in slot uHead % uRecords
+	std::atomic<uint32_t> uChannels;
+	char szChannels[FLIGHTRECORDER_MAX_CHANNELS][FLIGHTRECORDER_NAME_LENGTH];
+};
+
+class FlightRecorder
+{
+public:
+	static FlightChannel Register(const char *szName); //at construction, not in loops; opens the file the first time
+	static void Record(FlightChannel channel, float fValue);
+	static void RecordAt(FlightChannel channel, double fTime, float fValue); //fTime in HAL clock seconds, saves reading the clock again
+	static void Flush(); //start writing the file out, not for the hot paths
+	static bool IsOpen();
+	static uint32_t GetRecordCount(); //records since the file was opened
+
+private:
+	static bool Open();
+};
+
+#endif //FLIGHT_RECORDER_H
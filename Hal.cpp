@@ -0,0 +1,41 @@
+/** \file
+ * Implementation of the parts of the hardware abstraction layer every backend shares.
+ */
+
+#include "Hal.h"
+
+#include <stddef.h>
+#include <time.h>
+
+#include "MotorProxy.h"
+
+static Hal *pInstance = NULL;
+
+///Every motor the code gets is a proxy, so the backends don't each have to cache and count
+HalMotor *Hal::NewMotor(int iCanId, const char *szName)
+{
+	return(new MotorProxy(NewTalon(iCanId), szName));
+}
+
+void Hal::SetInstance(Hal *pHal)
+{
+	pInstance = pHal;
+}
+
+Hal *Hal::GetInstance()
+{
+	return(pInstance);
+}
+
+double Hal::Now()
+{
+	struct timespec now;
+
+	if(pInstance)
+	{
+		return(pInstance->GetClock()->Now());
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec + now.tv_nsec * 1.0e-9);
+}
@@ -0,0 +1,183 @@
+/** \file
+ * Definitions of the hardware abstraction layer, the only way the components reach a device.
+ *
+ * Each kind of device the robot code uses is an interface here, with only the
+ * calls the code makes.  A backend implements them: HalWpilib drives the real
+ * hardware through WPILib and sim/HalSim keeps everything in memory so the
+ * components build and run on a Linux box.  Components are handed the backend
+ * in their constructors and ask it for their devices by CAN ID or channel.
+ *
+ * This header must not include WPILib.h; the enums below stand in for the
+ * WPILib ones and the robot backend translates them.
+ */
+
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdint.h>
+
+///How a motor controller reads its setpoint, CANSpeedController::ControlMode
+typedef enum eHalControlMode
+{
+	HAL_CONTROL_PERCENT_VBUS		//!< -1.0 to 1.0 of the bus voltage
+} HalControlMode;
+
+///What stops a motor controller at the ends of travel, CANSpeedController::LimitMode
+typedef enum eHalLimitMode
+{
+	HAL_LIMIT_SWITCH_INPUTS_ONLY,	//!< the limit switch inputs stop the motor
+	HAL_LIMIT_SOFT_POSITION,		//!< the switches and the soft position limits do
+	HAL_LIMIT_SWITCH_INPUTS_DISABLED	//!< nothing does, the switches can still be read
+} HalLimitMode;
+
+///What a motor controller does at zero output, CANSpeedController::NeutralMode
+typedef enum eHalNeutralMode
+{
+	HAL_NEUTRAL_JUMPER,				//!< whatever the jumper on the controller says
+	HAL_NEUTRAL_BRAKE,
+	HAL_NEUTRAL_COAST
+} HalNeutralMode;
+
+///A Talon's status frames, in the order of CANTalon::StatusFrameRate
+typedef enum eHalStatusFrame
+{
+	HAL_STATUS_GENERAL,				//!< limit switches and output, 10 ms by default
+	HAL_STATUS_FEEDBACK,			//!< current and the selected sensor, 20 ms by default
+	HAL_STATUS_QUAD_ENCODER,		//!< quadrature position, velocity and pins, 100 ms by default
+	HAL_STATUS_ANALOG_TEMP_VBAT,	//!< analog input, temperature and bus voltage, 100 ms by default
+	HAL_STATUS_FRAMES
+} HalStatusFrame;
+
+///A motor controller on the CAN bus
+class HalMotor
+{
+public:
+	virtual ~HalMotor() {};
+
+	virtual void Set(float fValue) = 0;
+	virtual float Get() = 0; //the output the controller reports
+	virtual void SetControlMode(HalControlMode mode) = 0;
+	virtual void SetVoltageRampRate(double fRampRate) = 0; //volts per second
+	virtual void ConfigLimitMode(HalLimitMode mode) = 0;
+	virtual void ConfigNeutralMode(HalNeutralMode mode) = 0;
+	virtual void ConfigFwdLimitSwitchNormallyOpen(bool bNormallyOpen) = 0;
+	virtual void ConfigRevLimitSwitchNormallyOpen(bool bNormallyOpen) = 0;
+	virtual void SetStatusFrameRateMs(HalStatusFrame frame, int iPeriodMs) = 0;
+
+	virtual bool IsAlive() = 0;
+	virtual bool IsFwdLimitSwitchClosed() = 0;
+	virtual bool IsRevLimitSwitchClosed() = 0;
+	virtual float GetOutputCurrent() = 0; //amps
+	virtual float GetBusVoltage() = 0;
+	virtual int GetPinStateQuadB() = 0;
+	virtual int GetDeviceNumber() = 0; //the CAN ID
+};
+
+///A digital input on the roboRIO
+class HalDigitalInput
+{
+public:
+	virtual ~HalDigitalInput() {};
+
+	virtual bool Get() = 0;
+};
+
+///Counts the edges of a digital input in the FPGA, so none are missed between reads
+class HalCounter
+{
+public:
+	virtual ~HalCounter() {};
+
+	virtual void Reset() = 0;
+	virtual int32_t Get() = 0;
+};
+
+///A quadrature encoder on two digital inputs
+class HalEncoder
+{
+public:
+	virtual ~HalEncoder() {};
+
+	virtual void Reset() = 0;
+	virtual void SetDistancePerPulse(double fDistance) = 0;
+	virtual double GetDistance() = 0;
+	virtual double GetRate() = 0; //distance per second
+};
+
+///An SPI port
+class HalSpi
+{
+public:
+	virtual ~HalSpi() {};
+
+	virtual void SetClockRate(double fHz) = 0;
+	virtual void SetClockActiveHigh() = 0;
+	virtual void SetChipSelectActiveLow() = 0;
+	virtual void SetMSBFirst() = 0;
+	virtual int32_t Transaction(uint8_t *pSend, uint8_t *pReceive, uint8_t uSize) = 0; //bytes moved
+};
+
+///The roboRIO's built in accelerometer
+class HalAccelerometer
+{
+public:
+	virtual ~HalAccelerometer() {};
+
+	virtual double GetX() = 0; //g
+	virtual double GetY() = 0;
+	virtual double GetZ() = 0;
+};
+
+/**
+ * The time every task goes by.  A task blocks only in these calls, so a backend
+ * whose clock isn't the wall clock decides when each task runs.
+ */
+class HalClock
+{
+public:
+	virtual ~HalClock() {};
+
+	virtual double Now() = 0; //seconds, monotonic
+	virtual void Wait(double fSeconds) = 0;
+	virtual void WaitUntil(double fDeadline) = 0; //a Now() time, for tasks that run at a fixed rate
+	virtual bool WaitForInput(int iFd, double fTimeout) = 0; //true once iFd can be read, false on timeout
+};
+
+///What the driver station tells the robot: the match mode and the joysticks
+class HalDriverStation
+{
+public:
+	virtual ~HalDriverStation() {};
+
+	virtual bool IsEnabled() = 0;
+	virtual bool IsAutonomous() = 0;
+	virtual bool IsOperatorControl() = 0;
+	virtual bool IsTest() = 0;
+	virtual float GetStickAxis(int iStick, int iAxis) = 0;
+	virtual bool GetStickButton(int iStick, int iButton) = 0;
+};
+
+///A backend, which makes the devices
+class Hal
+{
+public:
+	virtual ~Hal() {};
+
+	HalMotor *NewMotor(int iCanId, const char *szName); //write on change, counted by the CAN bus monitor
+	virtual HalDigitalInput *NewDigitalInput(int iChannel) = 0;
+	virtual HalCounter *NewCounter(HalDigitalInput *pInput) = 0; //pInput must come from this backend
+	virtual HalEncoder *NewEncoder(int iChannelA, int iChannelB, bool bReverse) = 0;
+	virtual HalSpi *NewSpi(int iPort) = 0;
+	virtual HalAccelerometer *NewAccelerometer() = 0;
+	virtual HalClock *GetClock() = 0;
+	virtual HalDriverStation *GetDriverStation() = 0;
+
+	static void SetInstance(Hal *pHal); //once, before anything is built
+	static Hal *GetInstance(); //for code that has no component to be handed the backend, the mode macros
+	static double Now(); //the instance's clock, CLOCK_MONOTONIC until there is one
+
+protected:
+	virtual HalMotor *NewTalon(int iCanId) = 0;
+};
+
+#endif //HAL_H
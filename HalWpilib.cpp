@@ -0,0 +1,257 @@
+/** \file
+ * Implementation of the robot's HAL backend.
+ */
+
+#include "HalWpilib.h"
+
+#include <time.h>
+#include <sys/select.h>
+
+///A Talon SRX
+class WpilibTalon : public HalMotor
+{
+public:
+	WpilibTalon(int iCanId) : talon(iCanId) { iDeviceNumber = iCanId; };
+
+	void Set(float fValue) { talon.Set(fValue); };
+	float Get() { return(talon.Get()); };
+	void SetControlMode(HalControlMode mode);
+	void SetVoltageRampRate(double fRampRate) { talon.SetVoltageRampRate(fRampRate); };
+	void ConfigLimitMode(HalLimitMode mode);
+	void ConfigNeutralMode(HalNeutralMode mode);
+	void ConfigFwdLimitSwitchNormallyOpen(bool bNormallyOpen) { talon.ConfigFwdLimitSwitchNormallyOpen(bNormallyOpen); };
+	void ConfigRevLimitSwitchNormallyOpen(bool bNormallyOpen) { talon.ConfigRevLimitSwitchNormallyOpen(bNormallyOpen); };
+	void SetStatusFrameRateMs(HalStatusFrame frame, int iPeriodMs)
+	{
+		talon.SetStatusFrameRateMs((CANTalon::StatusFrameRate)frame, iPeriodMs); //same order
+	};
+
+	bool IsAlive() { return(talon.IsAlive()); };
+	bool IsFwdLimitSwitchClosed() { return(talon.IsFwdLimitSwitchClosed()); };
+	bool IsRevLimitSwitchClosed() { return(talon.IsRevLimitSwitchClosed()); };
+	float GetOutputCurrent() { return(talon.GetOutputCurrent()); };
+	float GetBusVoltage() { return(talon.GetBusVoltage()); };
+	int GetPinStateQuadB() { return(talon.GetPinStateQuadB()); };
+	int GetDeviceNumber() { return(iDeviceNumber); };
+
+private:
+	CANTalon talon;
+	int iDeviceNumber;
+};
+
+void WpilibTalon::SetControlMode(HalControlMode mode)
+{
+	switch(mode)
+	{
+	case HAL_CONTROL_PERCENT_VBUS:
+	default:
+		talon.SetControlMode(CANSpeedController::kPercentVbus);
+		break;
+	}
+}
+
+void WpilibTalon::ConfigLimitMode(HalLimitMode mode)
+{
+	switch(mode)
+	{
+	case HAL_LIMIT_SOFT_POSITION:
+		talon.ConfigLimitMode(CANSpeedController::kLimitMode_SoftPositionLimits);
+		break;
+
+	case HAL_LIMIT_SWITCH_INPUTS_DISABLED:
+		talon.ConfigLimitMode(CANSpeedController::kLimitMode_SrxDisableSwitchInputs);
+		break;
+
+	case HAL_LIMIT_SWITCH_INPUTS_ONLY:
+	default:
+		talon.ConfigLimitMode(CANSpeedController::kLimitMode_SwitchInputsOnly);
+		break;
+	}
+}
+
+void WpilibTalon::ConfigNeutralMode(HalNeutralMode mode)
+{
+	switch(mode)
+	{
+	case HAL_NEUTRAL_BRAKE:
+		talon.ConfigNeutralMode(CANSpeedController::kNeutralMode_Brake);
+		break;
+
+	case HAL_NEUTRAL_COAST:
+		talon.ConfigNeutralMode(CANSpeedController::kNeutralMode_Coast);
+		break;
+
+	case HAL_NEUTRAL_JUMPER:
+	default:
+		talon.ConfigNeutralMode(CANSpeedController::kNeutralMode_Jumper);
+		break;
+	}
+}
+
+///A digital input, which a counter can be built on
+class WpilibDigitalInput : public HalDigitalInput
+{
+public:
+	WpilibDigitalInput(int iChannel) : input(iChannel) {};
+
+	bool Get() { return(input.Get()); };
+	DigitalInput *GetInput() { return(&input); };
+
+private:
+	DigitalInput input;
+};
+
+class WpilibCounter : public HalCounter
+{
+public:
+	WpilibCounter(DigitalInput *pInput) : counter(pInput) {};
+
+	void Reset() { counter.Reset(); };
+	int32_t Get() { return(counter.Get()); };
+
+private:
+	Counter counter;
+};
+
+class WpilibEncoder : public HalEncoder
+{
+public:
+	WpilibEncoder(int iChannelA, int iChannelB, bool bReverse) :
+		encoder(iChannelA, iChannelB, bReverse, Encoder::k4X) {};
+
+	void Reset() { encoder.Reset(); };
+	void SetDistancePerPulse(double fDistance) { encoder.SetDistancePerPulse(fDistance); };
+	double GetDistance() { return(encoder.GetDistance()); };
+	double GetRate() { return(encoder.GetRate()); };
+
+private:
+	Encoder encoder;
+};
+
+class WpilibSpi : public HalSpi
+{
+public:
+	WpilibSpi(int iPort) : spi((SPI::Port)iPort) {};
+
+	void SetClockRate(double fHz) { spi.SetClockRate(fHz); };
+	void SetClockActiveHigh() { spi.SetClockActiveHigh(); };
+	void SetChipSelectActiveLow() { spi.SetChipSelectActiveLow(); };
+	void SetMSBFirst() { spi.SetMSBFirst(); };
+	int32_t Transaction(uint8_t *pSend, uint8_t *pReceive, uint8_t uSize)
+	{
+		return(spi.Transaction(pSend, pReceive, uSize));
+	};
+
+private:
+	SPI spi;
+};
+
+class WpilibAccelerometer : public HalAccelerometer
+{
+public:
+	double GetX() { return(accelerometer.GetX()); };
+	double GetY() { return(accelerometer.GetY()); };
+	double GetZ() { return(accelerometer.GetZ()); };
+
+private:
+	BuiltInAccelerometer accelerometer;
+};
+
+///CLOCK_MONOTONIC, what the rest of the robot code already stamps things with
+class WpilibClock : public HalClock
+{
+public:
+	double Now()
+	{
+		struct timespec now;
+
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		return (now.tv_sec + now.tv_nsec * 1.0e-9);
+	};
+
+	void Wait(double fSeconds) { ::Wait(fSeconds); };
+	void WaitUntil(double fDeadline);
+	bool WaitForInput(int iFd, double fTimeout);
+};
+
+void WpilibClock::WaitUntil(double fDeadline)
+{
+	struct timespec deadline;
+
+	deadline.tv_sec = (time_t)fDeadline;
+	deadline.tv_nsec = (long)((fDeadline - deadline.tv_sec) * 1.0e9);
+	clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+}
+
+bool WpilibClock::WaitForInput(int iFd, double fTimeout)
+{
+	fd_set selectSet;
+	struct timeval timeout;
+
+	FD_ZERO(&selectSet);
+	FD_SET(iFd, &selectSet);
+
+	timeout.tv_sec = (time_t)fTimeout;
+	timeout.tv_usec = (long)((fTimeout - timeout.tv_sec) * 1.0e6);
+
+	return(select(iFd + 1, &selectSet, NULL, NULL, &timeout) > 0);
+}
+
+class WpilibDriverStation : public HalDriverStation
+{
+public:
+	bool IsEnabled() { return(RobotBase::getInstance().IsEnabled()); };
+	bool IsAutonomous() { return(RobotBase::getInstance().IsAutonomous()); };
+	bool IsOperatorControl() { return(RobotBase::getInstance().IsOperatorControl()); };
+	bool IsTest() { return(RobotBase::getInstance().IsTest()); };
+	float GetStickAxis(int iStick, int iAxis)
+	{
+		return(DriverStation::GetInstance()->GetStickAxis(iStick, iAxis));
+	};
+	bool GetStickButton(int iStick, int iButton)
+	{
+		return(DriverStation::GetInstance()->GetStickButton(iStick, iButton));
+	};
+};
+
+HalWpilib::HalWpilib()
+{
+	pClock = new WpilibClock();
+	pDriverStation = new WpilibDriverStation();
+}
+
+HalWpilib::~HalWpilib()
+{
+	delete pClock;
+	delete pDriverStation;
+}
+
+HalMotor *HalWpilib::NewTalon(int iCanId)
+{
+	return(new WpilibTalon(iCanId));
+}
+
+HalDigitalInput *HalWpilib::NewDigitalInput(int iChannel)
+{
+	return(new WpilibDigitalInput(iChannel));
+}
+
+HalCounter *HalWpilib::NewCounter(HalDigitalInput *pInput)
+{
+	return(new WpilibCounter(((WpilibDigitalInput *)pInput)->GetInput()));
+}
+
+HalEncoder *HalWpilib::NewEncoder(int iChannelA, int iChannelB, bool bReverse)
+{
+	return(new WpilibEncoder(iChannelA, iChannelB, bReverse));
+}
+
+HalSpi *HalWpilib::NewSpi(int iPort)
+{
+	return(new WpilibSpi(iPort));
+}
+
+HalAccelerometer *HalWpilib::NewAccelerometer()
+{
+	return(new WpilibAccelerometer());
+}
@@ -0,0 +1,36 @@
+/** \file
+ * Definitions of the robot's HAL backend, which hands WPILib devices to the components.
+ *
+ * The devices are thin wrappers; each call goes straight to the WPILib object.
+ * RhsRobotBase makes the one instance before anything else is built.
+ */
+
+#ifndef HAL_WPILIB_H
+#define HAL_WPILIB_H
+
+#include "WPILib.h"
+#include "Hal.h"
+
+class HalWpilib : public Hal
+{
+public:
+	HalWpilib();
+	virtual ~HalWpilib();
+
+	HalDigitalInput *NewDigitalInput(int iChannel);
+	HalCounter *NewCounter(HalDigitalInput *pInput);
+	HalEncoder *NewEncoder(int iChannelA, int iChannelB, bool bReverse);
+	HalSpi *NewSpi(int iPort);
+	HalAccelerometer *NewAccelerometer();
+	HalClock *GetClock() { return(pClock); };
+	HalDriverStation *GetDriverStation() { return(pDriverStation); };
+
+protected:
+	HalMotor *NewTalon(int iCanId);
+
+private:
+	HalClock *pClock;
+	HalDriverStation *pDriverStation;
+};
+
+#endif //HAL_WPILIB_H
@@ -0,0 +1,199 @@
+/** \file
+ * Implementation of the heartbeat monitor.
+ *
+ * Beat() is two relaxed stores and one release store, cheap enough for every pass
+ * of every task.  The monitor is the only reader; a stall is reported when it
+ * starts and again when the task recovers, never once per check.
+ */
+
+#include "HeartbeatMonitor.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#include "ComponentBase.h"
+#include "RobotParams.h"
+#include "RobotLog.h"
+#include "Hal.h"
+
+static HeartbeatMonitor *pInstance = NULL;
+
+HeartbeatMonitor *HeartbeatMonitor::GetInstance()
+{
+	//the first call is from the main thread while the robot is built
+
+	if(pInstance == NULL)
+	{
+		pInstance = new HeartbeatMonitor();
+	}
+
+	return(pInstance);
+}
+
+HeartbeatMonitor::HeartbeatMonitor()
+{
+	iHeartbeats = 0;
+	pTask = NULL;
+}
+
+HeartbeatMonitor::~HeartbeatMonitor()
+{
+	delete pTask;
+}
+
+double HeartbeatMonitor::Now()
+{
+	return(Hal::Now());
+}
+
+///Returns the heartbeat number to Beat() with, or -1 if the table is full
+int HeartbeatMonitor::Register(const char *szName, float fPeriod, ComponentBase *pComponent)
+{
+	int iHeartbeat = iHeartbeats.load(std::memory_order_relaxed);
+
+	wpi_assert(iHeartbeat < HEARTBEAT_MAX);
+
+	if(iHeartbeat >= HEARTBEAT_MAX)
+	{
+		return(-1);
+	}
+
+	Heartbeat &heartbeat = heartbeats[iHeartbeat];
+
+	heartbeat.szName = szName;
+	heartbeat.fPeriod = fPeriod;
+	heartbeat.pComponent = pComponent;
+	heartbeat.uLoop = 0;
+	heartbeat.fTime = Now();
+	heartbeat.iCommand = COMMAND_UNKNOWN;
+	heartbeat.bStalled = false;
+	heartbeat.iStalls = 0;
+	heartbeat.bStopped = false;
+
+	iHeartbeats.store(iHeartbeat + 1, std::memory_order_release);
+	return(iHeartbeat);
+}
+
+void HeartbeatMonitor::Beat(int iHeartbeat, MessageCommand command)
+{
+	if((iHeartbeat < 0) || (iHeartbeat >= HEARTBEAT_MAX))
+	{
+		return;
+	}
+
+	Heartbeat &heartbeat = heartbeats[iHeartbeat];
+
+	heartbeat.iCommand.store(command, std::memory_order_relaxed);
+	heartbeat.uLoop.fetch_add(1, std::memory_order_relaxed);
+	heartbeat.fTime.store(Now(), std::memory_order_release);
+}
+
+void HeartbeatMonitor::Start()
+{
+	if(pTask == NULL)
+	{
+		pTask = new Task(HEARTBEAT_TASKNAME, (FUNCPTR) &HeartbeatMonitor::StartTask,
+				HEARTBEAT_PRIORITY, HEARTBEAT_STACKSIZE);
+		wpi_assert(pTask);
+		pTask->Start((intptr_t) this);
+	}
+}
+
+bool HeartbeatMonitor::IsStalled(int iHeartbeat)
+{
+	if((iHeartbeat < 0) || (iHeartbeat >= HEARTBEAT_MAX))
+	{
+		return(false);
+	}
+
+	return(heartbeats[iHeartbeat].bStalled.load(std::memory_order_relaxed));
+}
+
+int HeartbeatMonitor::GetStallCount(int iHeartbeat)
+{
+	if((iHeartbeat < 0) || (iHeartbeat >= HEARTBEAT_MAX))
+	{
+		return(0);
+	}
+
+	return(heartbeats[iHeartbeat].iStalls.load(std::memory_order_relaxed));
+}
+
+void HeartbeatMonitor::DoWork()
+{
+	HalClock *pClock = Hal::GetInstance()->GetClock();
+	double fDeadline = pClock->Now();
+
+	while(true)
+	{
+		Check();
+
+		fDeadline += HEARTBEAT_CHECK_PERIOD;
+		pClock->WaitUntil(fDeadline);
+	}
+}
+
+/**
+ * A heartbeat is late once it is older than its period, so a stall is reported
+ * at most HEARTBEAT_CHECK_PERIOD after that.
+ */
+void HeartbeatMonitor::Check()
+{
+	int iCount = iHeartbeats.load(std::memory_order_acquire);
+	float fSafeStopTime = ISAUTO ? HEARTBEAT_AUTO_SAFESTOP_TIME : HEARTBEAT_SAFESTOP_TIME;
+	bool bStopAll = false;
+	double fNow = Now();
+
+	for(int i = 0; i < iCount; i++)
+	{
+		Heartbeat &heartbeat = heartbeats[i];
+		double fQuiet = fNow - heartbeat.fTime.load(std::memory_order_acquire);
+
+		if(fQuiet <= heartbeat.fPeriod)
+		{
+			if(heartbeat.bStalled.load(std::memory_order_relaxed))
+			{
+				RobotLog::Printf(LOG_INFO, "Heartbeat %s recovered\n", heartbeat.szName);
+				heartbeat.bStalled.store(false, std::memory_order_relaxed);
+				heartbeat.bStopped = false;
+			}
+			continue;
+		}
+
+		if(!heartbeat.bStalled.load(std::memory_order_relaxed))
+		{
+			heartbeat.bStalled.store(true, std::memory_order_relaxed);
+			heartbeat.iStalls.fetch_add(1, std::memory_order_relaxed);
+			RobotLog::Printf(LOG_WARNING, "Heartbeat %s stalled in %s, loop %u, %0.3lfs since its last beat\n",
+					heartbeat.szName,
+					GetMessageCommandName((MessageCommand)heartbeat.iCommand.load(std::memory_order_relaxed)),
+					heartbeat.uLoop.load(std::memory_order_relaxed), fQuiet);
+		}
+
+		if(!heartbeat.bStopped && (fQuiet > fSafeStopTime))
+		{
+			heartbeat.bStopped = true;
+			RobotLog::Printf(LOG_ERROR, "Heartbeat %s still stalled after %0.3lfs, safe stop\n", heartbeat.szName, fQuiet);
+
+			if(heartbeat.pComponent)
+			{
+				heartbeat.pComponent->RequestSafeStop();
+			}
+			else
+			{
+				bStopAll = true;
+			}
+		}
+	}
+
+	if(bStopAll)
+	{
+		for(int i = 0; i < iCount; i++)
+		{
+			if(heartbeats[i].pComponent)
+			{
+				heartbeats[i].pComponent->RequestSafeStop();
+			}
+		}
+	}
+}
@@ -0,0 +1,72 @@
+/** \file
+ * Definitions of the heartbeat monitor, a watchdog for the main loop and the component tasks.
+ *
+ * The main loop and every component publish a heartbeat - a loop count, the time
+ * and the command being worked on - into a shared table once per pass.  The
+ * monitor task checks the table every HEARTBEAT_CHECK_PERIOD and flags anything
+ * that has been quiet longer than its expected period, printing the command it
+ * stalled in.  A component still stuck after the safe stop time is asked to stop;
+ * if it is the main loop that is stuck every component is, since nothing else will
+ * tell them the sticks have been let go.  A component whose Run() blocks in a
+ * loop, as the autonomous steps do, beats from the loop with ComponentBase::Beat().
+ */
+
+#ifndef HEARTBEAT_MONITOR_H
+#define HEARTBEAT_MONITOR_H
+
+#include "WPILib.h"
+
+#include <atomic>
+
+#include "RobotMessage.h"
+
+class ComponentBase;
+
+const int HEARTBEAT_MAX = 16;
+const float HEARTBEAT_CHECK_PERIOD = 0.02; //seconds between checks of the table
+const float HEARTBEAT_COMPONENT_PERIOD = 0.07; //the 40ms component message timeout plus a Run()
+const float HEARTBEAT_SAFESTOP_TIME = 0.5; //seconds stalled before a safe stop
+const float HEARTBEAT_AUTO_SAFESTOP_TIME = 4.0; //in autonomous, where a step that blocks beats from its loop but scripts are less watched
+
+class HeartbeatMonitor
+{
+public:
+	static HeartbeatMonitor *GetInstance();
+	static void *StartTask(void *pThis)
+	{
+		((HeartbeatMonitor *)pThis)->DoWork();
+		return(NULL);
+	}
+
+	int Register(const char *szName, float fPeriod, ComponentBase *pComponent); //NULL component for the main loop
+	void Beat(int iHeartbeat, MessageCommand command);
+	void Start(); //call once everything is built
+	bool IsStalled(int iHeartbeat);
+	int GetStallCount(int iHeartbeat);
+
+private:
+	HeartbeatMonitor();
+	~HeartbeatMonitor();
+
+	void DoWork();
+	void Check();
+	static double Now();
+
+	struct Heartbeat {
+		const char *szName;
+		float fPeriod;
+		ComponentBase *pComponent;
+		std::atomic<unsigned> uLoop;
+		std::atomic<double> fTime;
+		std::atomic<int> iCommand;		//the MessageCommand being worked on
+		std::atomic<bool> bStalled;
+		std::atomic<int> iStalls;
+		bool bStopped;					//only the monitor task touches this
+	};
+
+	Heartbeat heartbeats[HEARTBEAT_MAX];
+	std::atomic<int> iHeartbeats;
+	Task *pTask;
+};
+
+#endif //HEARTBEAT_MONITOR_H
@@ -0,0 +1,646 @@
+/** \file
+ * Implementation of the controller input binding table.
+ *
+ * Everything that involves a name - reading the file, looking up commands,
+ * components and shapers - happens once when the robot starts.  Dispatch() only
+ * walks an array of plain structs holding pointers, so the per packet cost is a
+ * snapshot lookup and a compare for each binding.
+ */
+
+#include "InputBindings.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <math.h>
+
+#include <algorithm>
+
+#include "RobotParams.h"
+
+///Offset of a MessageParams field in 32 bit words, every field is a float, int or bool on a word boundary
+#define BINDING_SLOT(field)		(offsetof(MessageParams, field) / sizeof(float))
+
+static const char *szDelimiters = " \t\r\n";
+
+//same order as DriveMode
+static const char* const szModeNames[] = { "tank", "arcade", "curvature" };
+
+//same order as BindingTarget
+static const char* const szTargetNames[BINDING_TARGET_COUNT] = {
+	"drivetrain", "conveyor", "cube", "canlifter", "claw", "noodlefan"
+};
+
+//same order as BindingShaper
+static const char* const szShaperNames[BINDING_SHAPER_COUNT] = {
+	"none", "tank", "arcade", "canlifter", "cubeclicker"
+};
+
+//same order as BindingTrigger
+static const char* const szTriggerNames[] = {
+	"always", "held", "pressed", "released", "positive", "negative"
+};
+
+//same order as BindingParamKind
+static const char* const szParamKindNames[] = { "axis", "nearzero" };
+
+///The message fields a binding may fill in
+static const struct {
+	const char *szName;
+	int iSlot;
+} bindingSlots[] = {
+	{ "tankDrive.left",					BINDING_SLOT(tankDrive.left) },
+	{ "tankDrive.right",				BINDING_SLOT(tankDrive.right) },
+	{ "arcadeDrive.x",					BINDING_SLOT(arcadeDrive.x) },
+	{ "arcadeDrive.y",					BINDING_SLOT(arcadeDrive.y) },
+	{ "curvatureDrive.throttle",		BINDING_SLOT(curvatureDrive.throttle) },
+	{ "curvatureDrive.wheel",			BINDING_SLOT(curvatureDrive.wheel) },
+	{ "curvatureDrive.bQuickTurn",		BINDING_SLOT(curvatureDrive.bQuickTurn) },
+	{ "conveyorParams.right",			BINDING_SLOT(conveyorParams.right) },
+	{ "conveyorParams.intakeSpeed",		BINDING_SLOT(conveyorParams.intakeSpeed) },
+	{ "canLifterParams.lifterSpeed",	BINDING_SLOT(canLifterParams.lifterSpeed) },
+};
+
+/**
+ * The layout the robot shipped with, the same mapping the controller macros in
+ * RobotParams.h used to make.  Used when there is no bindings file or it has an error.
+ */
+static const InputBindingSpec defaultBindings[] = {
+	{ DRIVE_MODE_TANK, BINDING_TARGET_DRIVETRAIN, 0, COMMAND_DRIVETRAIN_DRIVE_TANK,
+			1, BINDING_TRIGGER_ALWAYS, 0, BINDING_SHAPER_NONE, 1.0, 2, {
+			{ BINDING_SLOT(tankDrive.left), BINDING_PARAM_AXIS, 1, TANK_DRIVE_LEFT_ID,
+					BINDING_SHAPER_TANK, -DRIVE_MAX_OUTPUT, 0.0 },
+			{ BINDING_SLOT(tankDrive.right), BINDING_PARAM_AXIS, 1, TANK_DRIVE_RIGHT_ID,
+					BINDING_SHAPER_TANK, -DRIVE_MAX_OUTPUT, 0.0 } }, true },
+	{ DRIVE_MODE_ARCADE, BINDING_TARGET_DRIVETRAIN, 0, COMMAND_DRIVETRAIN_DRIVE_ARCADE,
+			1, BINDING_TRIGGER_ALWAYS, 0, BINDING_SHAPER_NONE, 1.0, 2, {
+			{ BINDING_SLOT(arcadeDrive.x), BINDING_PARAM_AXIS, 1, ARCADE_DRIVE_X_ID,
+					BINDING_SHAPER_ARCADE, DRIVE_MAX_OUTPUT, 0.0 },
+			{ BINDING_SLOT(arcadeDrive.y), BINDING_PARAM_AXIS, 1, ARCADE_DRIVE_Y_ID,
+					BINDING_SHAPER_ARCADE, -DRIVE_MAX_OUTPUT, 0.0 } }, true },
+	{ DRIVE_MODE_CURVATURE, BINDING_TARGET_DRIVETRAIN, 0, COMMAND_DRIVETRAIN_DRIVE_CURVATURE,
+			1, BINDING_TRIGGER_ALWAYS, 0, BINDING_SHAPER_NONE, 1.0, 3, {
+			{ BINDING_SLOT(curvatureDrive.throttle), BINDING_PARAM_AXIS, 1, CURVATURE_DRIVE_THROTTLE_ID,
+					BINDING_SHAPER_ARCADE, -DRIVE_MAX_OUTPUT, 0.0 },
+			{ BINDING_SLOT(curvatureDrive.wheel), BINDING_PARAM_AXIS, 1, CURVATURE_DRIVE_WHEEL_ID,
+					BINDING_SHAPER_ARCADE, DRIVE_MAX_OUTPUT, 0.0 },
+			{ BINDING_SLOT(curvatureDrive.bQuickTurn), BINDING_PARAM_NEARZERO, 1, CURVATURE_DRIVE_THROTTLE_ID,
+					BINDING_SHAPER_ARCADE, -DRIVE_MAX_OUTPUT, CURVATURE_QUICKTURN_THRESHOLD } }, true },
+	{ INPUT_BINDING_MODE_ANY, BINDING_TARGET_DRIVETRAIN, 1, COMMAND_DRIVETRAIN_TOGGLE_HEADINGHOLD,
+			1, BINDING_TRIGGER_PRESSED, HEADINGHOLD_TOGGLE_ID, BINDING_SHAPER_NONE, 1.0, 0, {} },
+
+	{ INPUT_BINDING_MODE_ANY, BINDING_TARGET_CONVEYOR, 0, COMMAND_CONVEYOR_RUN_FWD,
+			1, BINDING_TRIGGER_HELD, CONVEYOR_FWD_ID, BINDING_SHAPER_NONE, 1.0, 0, {} },
+	{ INPUT_BINDING_MODE_ANY, BINDING_TARGET_CONVEYOR, 0, COMMAND_CONVEYOR_RUN_BCK,
+			1, BINDING_TRIGGER_HELD, CONVEYOR_BCK_ID, BINDING_SHAPER_NONE, 1.0, 0, {} },
+	{ INPUT_BINDING_MODE_ANY, BINDING_TARGET_CONVEYOR, 0, COMMAND_CONVEYOR_STOP,
+			1, BINDING_TRIGGER_ALWAYS, 0, BINDING_SHAPER_NONE, 1.0, 0, {} },
+
+	{ INPUT_BINDING_MODE_ANY, BINDING_TARGET_CUBE, 0, COMMAND_CUBEAUTOCYCLE_START,
+			1, BINDING_TRIGGER_PRESSED, CUBEAUTO_START_ID, BINDING_SHAPER_NONE, 1.0, 0, {} },
+	{ INPUT_BINDING_MODE_ANY, BINDING_TARGET_CUBE, 0, COMMAND_CUBEAUTOCYCLE_START,
+			2, BINDING_TRIGGER_PRESSED, CUBEAUTO_START_ID, BINDING_SHAPER_NONE, 1.0, 0, {} },
+	{ INPUT_BINDING_MODE_ANY, BINDING_TARGET_CUBE, 0, COMMAND_CUBEAUTOCYCLE_STOP,
+			1, BINDING_TRIGGER_PRESSED, CUBEAUTO_STOP_ID, BINDING_SHAPER_NONE, 1.0, 0, {} },
+	{ INPUT_BINDING_MODE_ANY, BINDING_TARGET_CUBE, 0, COMMAND_CUBEAUTOCYCLE_STOP,
+			2, BINDING_TRIGGER_PRESSED, CUBEAUTO_STOP_ID, BINDING_SHAPER_NONE, 1.0, 0, {} },
+	{ INPUT_BINDING_MODE_ANY, BINDING_TARGET_CUBE, 0, COMMAND_CUBEAUTOCYCLE_HOLD,
+			1, BINDING_TRIGGER_PRESSED, CUBEAUTO_HOLD_ID, BINDING_SHAPER_NONE, 1.0, 0, {} },
+	{ INPUT_BINDING_MODE_ANY, BINDING_TARGET_CUBE, 0, COMMAND_CUBEAUTOCYCLE_HOLD,
+			2, BINDING_TRIGGER_PRESSED, CUBEAUTO_HOLD_ID, BINDING_SHAPER_NONE, 1.0, 0, {} },
+	{ INPUT_BINDING_MODE_ANY, BINDING_TARGET_CUBE, 0, COMMAND_CUBEAUTOCYCLE_RELEASE,
+			1, BINDING_TRIGGER_PRESSED, CUBEAUTO_RELEASE_ID, BINDING_SHAPER_NONE, 1.0, 0, {} },
+	{ INPUT_BINDING_MODE_ANY, BINDING_TARGET_CUBE, 0, COMMAND_CUBEAUTOCYCLE_RELEASE,
+			2, BINDING_TRIGGER_PRESSED, CUBEAUTO_RELEASE_ID, BINDING_SHAPER_NONE, 1.0, 0, {} },
+	{ INPUT_BINDING_MODE_ANY, BINDING_TARGET_CUBE, 1, COMMAND_CUBECLICKER_RAISE,
+			2, BINDING_TRIGGER_POSITIVE, CUBECLICKER_RAISE_ID, BINDING_SHAPER_CUBECLICKER, -1.0, 0, {}, true },
+	{ INPUT_BINDING_MODE_ANY, BINDING_TARGET_CUBE, 1, COMMAND_CUBECLICKER_LOWER,
+			2, BINDING_TRIGGER_NEGATIVE, CUBECLICKER_LOWER_ID, BINDING_SHAPER_CUBECLICKER, -1.0, 0, {}, true },
+	{ INPUT_BINDING_MODE_ANY, BINDING_TARGET_CUBE, 1, COMMAND_CUBECLICKER_STOP,
+			2, BINDING_TRIGGER_ALWAYS, 0, BINDING_SHAPER_NONE, 1.0, 0, {}, true },
+
+	{ INPUT_BINDING_MODE_ANY, BINDING_TARGET_CANLIFTER, 0, COMMAND_CANLIFTER_RAISE,
+			1, BINDING_TRIGGER_POSITIVE, CANLIFTER_RAISE_ID, BINDING_SHAPER_CANLIFTER, 1.0, 1, {
+			{ BINDING_SLOT(canLifterParams.lifterSpeed), BINDING_PARAM_AXIS, 1, CANLIFTER_RAISE_ID,
+					BINDING_SHAPER_CANLIFTER, 1.0, 0.0 } }, true },
+	{ INPUT_BINDING_MODE_ANY, BINDING_TARGET_CANLIFTER, 0, COMMAND_CANLIFTER_LOWER,
+			1, BINDING_TRIGGER_POSITIVE, CANLIFTER_LOWER_ID, BINDING_SHAPER_CANLIFTER, 1.0, 1, {
+			{ BINDING_SLOT(canLifterParams.lifterSpeed), BINDING_PARAM_AXIS, 1, CANLIFTER_LOWER_ID,
+					BINDING_SHAPER_CANLIFTER, 1.0, 0.0 } }, true },
+	{ INPUT_BINDING_MODE_ANY, BINDING_TARGET_CANLIFTER, 0, COMMAND_CANLIFTER_STOP,
+			1, BINDING_TRIGGER_ALWAYS, 0, BINDING_SHAPER_NONE, 1.0, 0, {}, true },
+
+	{ INPUT_BINDING_MODE_ANY, BINDING_TARGET_CLAW, 0, COMMAND_CLAW_OPEN,
+			1, BINDING_TRIGGER_PRESSED, CLAW_OPEN_ID, BINDING_SHAPER_NONE, 1.0, 0, {} },
+	{ INPUT_BINDING_MODE_ANY, BINDING_TARGET_CLAW, 0, COMMAND_CLAW_CLOSE,
+			1, BINDING_TRIGGER_PRESSED, CLAW_CLOSE_ID, BINDING_SHAPER_NONE, 1.0, 0, {} },
+
+	{ INPUT_BINDING_MODE_ANY, BINDING_TARGET_NOODLEFAN, 0, COMMAND_NOODLEFAN_TOGGLE,
+			1, BINDING_TRIGGER_PRESSED, NOODLEFAN_TOGGLE_ID, BINDING_SHAPER_NONE, 1.0, 0, {} },
+};
+
+///Returns the position of szName in a name table, -1 if it isn't there
+static int FindName(const char *szName, const char* const szNames[], int iNames)
+{
+	for(int i = 0; i < iNames; i++)
+	{
+		if(strcmp(szName, szNames[i]) == 0)
+		{
+			return(i);
+		}
+	}
+
+	return(-1);
+}
+
+#define FIND_NAME(name, table)		FindName(name, table, sizeof(table) / sizeof(table[0]))
+
+InputBindings::InputBindings()
+{
+	iSpecs = 0;
+	iBindings = 0;
+	uPacket = 0;
+	iShadows = 0;
+	memset(shadows, 0, sizeof(shadows));
+	pRateTimer = new Timer();
+	pRateTimer->Start();
+	LoadDefaults();
+}
+
+InputBindings::~InputBindings()
+{
+	delete pRateTimer;
+}
+
+void InputBindings::LoadDefaults()
+{
+	iSpecs = sizeof(defaultBindings) / sizeof(defaultBindings[0]);
+	wpi_assert(iSpecs <= INPUT_BINDINGS_MAX);
+	memcpy(specs, defaultBindings, sizeof(defaultBindings));
+}
+
+/**
+ * Reads a bindings file.  The whole file must parse or none of it is used, a
+ * typo should never leave the robot with half a controller.
+ */
+bool InputBindings::Load(const char *szPath)
+{
+	FILE *bindingsFile = fopen(szPath, "r");
+	InputBindingSpec newSpecs[INPUT_BINDINGS_MAX];
+	int iNewSpecs = 0;
+	int iLine = 0;
+	bool bReturn = true;
+	char szLine[256];
+
+	if(bindingsFile == NULL)
+	{
+		printf("No input bindings file %s, using the defaults\n", szPath);
+		return(false);
+	}
+
+	while(bReturn && fgets(szLine, sizeof(szLine), bindingsFile))
+	{
+		char *pComment = strchr(szLine, '#');
+
+		iLine++;
+
+		if(pComment)
+		{
+			*pComment = '\0';
+		}
+
+		if(strspn(szLine, szDelimiters) == strlen(szLine))
+		{
+			continue;
+		}
+
+		if(iNewSpecs >= INPUT_BINDINGS_MAX)
+		{
+			printf("%s:%d too many bindings\n", szPath, iLine);
+			bReturn = false;
+		}
+		else if(!ParseLine(szLine, newSpecs[iNewSpecs]))
+		{
+			printf("%s:%d bad binding\n", szPath, iLine);
+			bReturn = false;
+		}
+		else
+		{
+			iNewSpecs++;
+		}
+	}
+
+	fclose(bindingsFile);
+
+	if(bReturn)
+	{
+		memcpy(specs, newSpecs, iNewSpecs * sizeof(InputBindingSpec));
+		iSpecs = iNewSpecs;
+		printf("Loaded %d input bindings from %s\n", iSpecs, szPath);
+	}
+	else
+	{
+		printf("Input bindings file %s ignored, using the defaults\n", szPath);
+	}
+
+	return(bReturn);
+}
+
+bool InputBindings::ParseLine(char *szLine, InputBindingSpec &spec)
+{
+	char *pNext = szLine;
+	char *pToken[9];
+	int iTarget;
+	int iTrigger;
+	int iShaper;
+
+	memset(&spec, 0, sizeof(spec));
+
+	for(int i = 0; i < 9; i++)
+	{
+		pToken[i] = strtok_r(pNext, szDelimiters, &pNext);
+
+		if(pToken[i] == NULL)
+		{
+			return(false);
+		}
+	}
+
+	spec.iMode = (strcmp(pToken[0], "any") == 0) ? INPUT_BINDING_MODE_ANY : FIND_NAME(pToken[0], szModeNames);
+	iTarget = FIND_NAME(pToken[1], szTargetNames);
+	spec.target = (BindingTarget)iTarget;
+	spec.iGroup = atoi(pToken[2]);
+	spec.command = GetMessageCommand(pToken[3]);
+	spec.iDevice = atoi(pToken[4]);
+	iTrigger = FIND_NAME(pToken[5], szTriggerNames);
+	spec.trigger = (BindingTrigger)iTrigger;
+	spec.iInput = atoi(pToken[6]);
+	iShaper = FIND_NAME(pToken[7], szShaperNames);
+	spec.shaper = (BindingShaper)iShaper;
+	spec.fScale = atof(pToken[8]);
+
+	if(((spec.iMode < 0) && (strcmp(pToken[0], "any") != 0))
+			|| (iTarget < 0) || (spec.command == COMMAND_UNKNOWN)
+			|| (spec.iDevice < 1) || (spec.iDevice > INPUT_BINDING_DEVICES)
+			|| (iTrigger < 0) || (iShaper < 0))
+	{
+		return(false);
+	}
+
+	pToken[0] = strtok_r(pNext, szDelimiters, &pNext);
+
+	if(pToken[0] && (strcmp(pToken[0], "onchange") == 0))
+	{
+		spec.bOnChange = true;
+		pToken[0] = strtok_r(pNext, szDelimiters, &pNext);
+	}
+
+	// any number of parameters, seven tokens each
+
+	for( ; pToken[0] != NULL; pToken[0] = strtok_r(pNext, szDelimiters, &pNext))
+	{
+		if(spec.iParams >= INPUT_BINDING_MAX_PARAMS)
+		{
+			return(false);
+		}
+
+		InputBindingParamSpec &param = spec.params[spec.iParams];
+		int iKind;
+		int iSlot = -1;
+
+		for(int i = 1; i < 7; i++)
+		{
+			pToken[i] = strtok_r(pNext, szDelimiters, &pNext);
+
+			if(pToken[i] == NULL)
+			{
+				return(false);
+			}
+		}
+
+		for(unsigned i = 0; i < sizeof(bindingSlots) / sizeof(bindingSlots[0]); i++)
+		{
+			if(strcmp(pToken[0], bindingSlots[i].szName) == 0)
+			{
+				iSlot = bindingSlots[i].iSlot;
+			}
+		}
+
+		iKind = FIND_NAME(pToken[1], szParamKindNames);
+		iShaper = FIND_NAME(pToken[4], szShaperNames);
+
+		param.iSlot = iSlot;
+		param.kind = (BindingParamKind)iKind;
+		param.iDevice = atoi(pToken[2]);
+		param.iAxis = atoi(pToken[3]);
+		param.shaper = (BindingShaper)iShaper;
+		param.fScale = atof(pToken[5]);
+		param.fThreshold = atof(pToken[6]);
+
+		if((iSlot < 0) || (iKind < 0) || (iShaper < 0)
+				|| (param.iDevice < 1) || (param.iDevice > INPUT_BINDING_DEVICES))
+		{
+			return(false);
+		}
+
+		spec.iParams++;
+	}
+
+	return(true);
+}
+
+/**
+ * Builds the dispatch array.  Bindings for components that weren't built are
+ * dropped, and each group is gathered together so a fired binding can jump
+ * straight past the rest of its group.
+ */
+void InputBindings::Compile(ComponentBase *pTargets[BINDING_TARGET_COUNT],
+		JoystickListener *pListeners[INPUT_BINDING_DEVICES],
+		AxisShaper *pShapers[BINDING_SHAPER_COUNT])
+{
+	InputBindingSpec *pSorted[INPUT_BINDINGS_MAX];
+	int iSorted = 0;
+
+	for(int i = 0; i < iSpecs; i++)
+	{
+		if(pTargets[specs[i].target] && pListeners[specs[i].iDevice - 1])
+		{
+			pSorted[iSorted++] = &specs[i];
+		}
+	}
+
+	std::stable_sort(pSorted, pSorted + iSorted,
+			[](const InputBindingSpec *a, const InputBindingSpec *b)
+			{
+				return((a->target < b->target)
+						|| ((a->target == b->target) && (a->iGroup < b->iGroup)));
+			});
+
+	iBindings = 0;
+
+	for(int i = 0; i < iSorted; i++)
+	{
+		InputBindingSpec &spec = *pSorted[i];
+		Binding &binding = bindings[iBindings];
+
+		binding.iMode = spec.iMode;
+		binding.trigger = spec.trigger;
+		binding.pListener = pListeners[spec.iDevice - 1];
+		binding.uInput = spec.iInput;
+		binding.pShaper = pShapers[spec.shaper];
+		binding.fScale = spec.fScale;
+		binding.pTarget = pTargets[spec.target];
+		binding.target = spec.target;
+		binding.command = spec.command;
+		binding.bOnChange = spec.bOnChange;
+		binding.bLastSent = false;
+		binding.iParams = 0;
+
+		for(int j = 0; j < spec.iParams; j++)
+		{
+			Param &param = binding.params[binding.iParams];
+
+			if(pListeners[spec.params[j].iDevice - 1] == NULL)
+			{
+				continue;
+			}
+
+			param.iSlot = spec.params[j].iSlot;
+			param.kind = spec.params[j].kind;
+			param.pListener = pListeners[spec.params[j].iDevice - 1];
+			param.uAxis = spec.params[j].iAxis;
+			param.pShaper = pShapers[spec.params[j].shaper];
+			param.fScale = spec.params[j].fScale;
+			param.fThreshold = spec.params[j].fThreshold;
+			param.uSentCount = 0;
+			binding.iParams++;
+		}
+
+		iBindings++;
+	}
+
+	// every binding learns where its group ends, and each group gets a shadow
+
+	iShadows = 0;
+	memset(shadows, 0, sizeof(shadows));
+
+	for(int iStart = 0; iStart < iBindings; )
+	{
+		int iEnd = iStart + 1;
+
+		while((iEnd < iBindings) && (pSorted[iEnd]->target == pSorted[iStart]->target)
+				&& (pSorted[iEnd]->iGroup == pSorted[iStart]->iGroup))
+		{
+			iEnd++;
+		}
+
+		for(int i = iStart; i < iEnd; i++)
+		{
+			bindings[i].iGroupEnd = iEnd;
+			bindings[i].iShadow = iShadows;
+		}
+
+		Shadow &shadow = shadows[iShadows++];
+		char szKey[TELEMETRY_NAME_LENGTH];
+
+		shadow.target = bindings[iStart].target;
+		snprintf(szKey, sizeof(szKey), "%s %d msgs/s offered", szTargetNames[shadow.target], pSorted[iStart]->iGroup);
+		shadow.keyOffered = Telemetry::Register(szKey, TELEMETRY_NUMBER);
+		snprintf(szKey, sizeof(szKey), "%s %d msgs/s sent", szTargetNames[shadow.target], pSorted[iStart]->iGroup);
+		shadow.keySent = Telemetry::Register(szKey, TELEMETRY_NUMBER);
+		iStart = iEnd;
+	}
+}
+
+float InputBindings::ReadAxis(JoystickListener *pListener, unsigned uAxis, AxisShaper *pShaper, float fScale)
+{
+	float fValue = pListener->GetAxis(uAxis);
+
+	if(pShaper)
+	{
+		fValue = pShaper->Shape(fValue);
+	}
+
+	return(fValue * fScale);
+}
+
+///Sends the command of the first binding that fires in each group, call once per packet after the listeners update
+void InputBindings::Dispatch(int iMode)
+{
+	RobotMessage message;
+	int i = 0;
+
+	uPacket++;
+
+	while(i < iBindings)
+	{
+		Binding &binding = bindings[i];
+		bool bFire;
+
+		if((binding.iMode != INPUT_BINDING_MODE_ANY) && (binding.iMode != iMode))
+		{
+			i++;
+			continue;
+		}
+
+		switch(binding.trigger)
+		{
+		case BINDING_TRIGGER_HELD:
+			bFire = binding.pListener->ButtonDown(binding.uInput);
+			break;
+
+		case BINDING_TRIGGER_PRESSED:
+			bFire = binding.pListener->ButtonPressed(binding.uInput);
+			break;
+
+		case BINDING_TRIGGER_RELEASED:
+			bFire = binding.pListener->ButtonReleased(binding.uInput);
+			break;
+
+		case BINDING_TRIGGER_POSITIVE:
+			bFire = (ReadAxis(binding.pListener, binding.uInput, binding.pShaper, binding.fScale) > 0.0);
+			break;
+
+		case BINDING_TRIGGER_NEGATIVE:
+			bFire = (ReadAxis(binding.pListener, binding.uInput, binding.pShaper, binding.fScale) < 0.0);
+			break;
+
+		case BINDING_TRIGGER_ALWAYS:
+		default:
+			bFire = true;
+			break;
+		}
+
+		if(!bFire)
+		{
+			i++;
+			continue;
+		}
+
+		shadows[binding.iShadow].uOffered++;
+
+		if(binding.bOnChange && binding.bLastSent && !ParamsMoved(binding)
+				&& ((uPacket - shadows[binding.iShadow].uSentPacket) < INPUT_BINDING_REFRESH_PACKETS))
+		{
+			i = binding.iGroupEnd;
+			continue;
+		}
+
+		memset(&message, 0, sizeof(message));
+		message.command = binding.command;
+
+		for(int j = 0; j < binding.iParams; j++)
+		{
+			Param &param = binding.params[j];
+			float fValue = ReadAxis(param.pListener, param.uAxis, param.pShaper, param.fScale);
+			char *pSlot = (char *)&message.params + param.iSlot * sizeof(float);
+
+			param.uSentCount = param.pListener->GetAxisChangeCount(param.uAxis);
+
+			if(param.kind == BINDING_PARAM_NEARZERO)
+			{
+				bool bValue = (fabs(fValue) < param.fThreshold);
+				memcpy(pSlot, &bValue, sizeof(bValue));
+			}
+			else
+			{
+				memcpy(pSlot, &fValue, sizeof(fValue));
+			}
+		}
+
+		Send(binding, message);
+
+		// the group start is found by walking back, groups are a handful of bindings
+
+		for(int k = i; (k >= 0) && (bindings[k].iGroupEnd == binding.iGroupEnd); k--)
+		{
+			bindings[k].bLastSent = false;
+		}
+
+		for(int k = i + 1; k < binding.iGroupEnd; k++)
+		{
+			bindings[k].bLastSent = false;
+		}
+
+		binding.bLastSent = true;
+		i = binding.iGroupEnd;
+	}
+}
+
+/**
+ * Sends a message unless it matches the shadow of the last one the binding's
+ * group sent and the keep alive isn't due.
+ */
+void InputBindings::Send(const Binding &binding, const RobotMessage &message)
+{
+	Shadow &shadow = shadows[binding.iShadow];
+	bool bEvent = (binding.trigger == BINDING_TRIGGER_PRESSED) || (binding.trigger == BINDING_TRIGGER_RELEASED);
+
+	if(!bEvent && shadow.bValid
+			&& ((uPacket - shadow.uSentPacket) < INPUT_BINDING_REFRESH_PACKETS)
+			&& (memcmp(&shadow.message, &message, sizeof(message)) == 0))
+	{
+		return;
+	}
+
+	binding.pTarget->SendMessage((RobotMessage *)&message);
+	shadow.bValid = true;
+	shadow.message = message;
+	shadow.uSentPacket = uPacket;
+	shadow.uSent++;
+}
+
+///Returns true if any parameter axis has moved since the binding was last sent
+bool InputBindings::ParamsMoved(const Binding &binding)
+{
+	for(int j = 0; j < binding.iParams; j++)
+	{
+		const Param &param = binding.params[j];
+
+		if(param.pListener->GetAxisChangeCount(param.uAxis) != param.uSentCount)
+		{
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
+///Forgets what was sent, so every onchange binding that fires is sent on the next Dispatch()
+void InputBindings::Reset()
+{
+	for(int i = 0; i < iBindings; i++)
+	{
+		bindings[i].bLastSent = false;
+	}
+
+	for(int i = 0; i < iShadows; i++)
+	{
+		shadows[i].bValid = false;
+	}
+}
+
+///Puts the messages per second each group was offered and sent on the dashboard
+void InputBindings::PutMessageRates()
+{
+	float fElapsed = pRateTimer->Get();
+
+	if(fElapsed <= 0.0)
+	{
+		return;
+	}
+
+	for(int i = 0; i < iShadows; i++)
+	{
+		Shadow &shadow = shadows[i];
+
+		Telemetry::Put(shadow.keyOffered, (shadow.uOffered - shadow.uLastOffered) / fElapsed);
+		Telemetry::Put(shadow.keySent, (shadow.uSent - shadow.uLastSent) / fElapsed);
+
+		shadow.uLastOffered = shadow.uOffered;
+		shadow.uLastSent = shadow.uSent;
+	}
+
+	pRateTimer->Reset();
+}
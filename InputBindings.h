@@ -0,0 +1,211 @@
+/** \file
+ * Definitions of the table that binds controller inputs to component commands.
+ *
+ * Each binding says: when this button or axis on this controller does this,
+ * send this command to this component, filling these parameters from these axes.
+ * The bindings are read from INPUT_BINDINGS_FILEPATH when the robot starts (or
+ * taken from the default table, which matches RobotParams.h) and compiled into
+ * a flat array that RhsRobot::Run walks once per driver station packet.
+ *
+ * Bindings for the same component with the same group number form a chain: the
+ * first one in the chain that fires is sent and the rest are skipped, so a group
+ * ending in an "always" binding acts like an if / else if / else.
+ *
+ * Every group has a shadow of the last message it sent.  A button held or an
+ * axis sending the same command and parameters as its group sent last time is
+ * not sent again, except every INPUT_BINDING_REFRESH_PACKETS as a keep alive for
+ * the component safety timers.  Two groups sending to the same component each
+ * keep their own shadow, so one doesn't make the other send every packet.
+ * Pressed and released bindings are events and always go out.  A binding marked
+ * onchange is not even built while it stays the one firing in its group and none
+ * of its parameter axes have moved.  Either way the component must hold (or
+ * repeat) the last value itself, see Drivetrain::TeleopDrive().
+ *
+ * File format, one binding per line, '#' starts a comment:
+ * \verbatim
+ mode component group command device trigger input shaper scale [onchange] [slot kind device axis shaper scale threshold]...
+
+ mode		any, tank, arcade or curvature (the drive mode picked on the dashboard)
+ component	drivetrain, conveyor, cube, canlifter, claw or noodlefan
+ command	a MessageCommand name, eg. COMMAND_CONVEYOR_RUN_FWD
+ device		1 or 2
+ trigger	always, held, pressed, released, positive or negative
+ input		button ID (from 1) for the button triggers, axis ID (from 0) for positive and negative
+ shaper		none, tank, arcade, canlifter or cubeclicker
+ scale		multiplies the shaped axis, -1 flips it
+ onchange	only send when the binding starts firing or a parameter axis moves
+ slot		a MessageParams field, eg. tankDrive.left
+ kind		axis to copy the scaled axis, nearzero to set a bool when it is under threshold
+ \endverbatim
+ */
+
+#ifndef INPUT_BINDINGS_H
+#define INPUT_BINDINGS_H
+
+#include "ComponentBase.h"
+#include "JoystickListener.h"
+#include "AxisShaper.h"
+#include "RobotMessage.h"
+#include "Telemetry.h"
+
+const char* const INPUT_BINDINGS_FILEPATH = "/home/lvuser/InputBindings.txt";
+const int INPUT_BINDINGS_MAX = 64;
+const int INPUT_BINDING_MAX_PARAMS = 3;
+const int INPUT_BINDING_DEVICES = 2;
+const int INPUT_BINDING_MODE_ANY = -1;
+const int INPUT_BINDING_REFRESH_PACKETS = 50;	//an unchanged command is sent again after this many packets, about 1s
+
+///How the driver's sticks are turned into Drivetrain commands, picked on the Smart Dashboard
+typedef enum eDriveMode
+{
+	DRIVE_MODE_TANK,
+	DRIVE_MODE_ARCADE,
+	DRIVE_MODE_CURVATURE
+} DriveMode;
+
+///What makes a binding send its command
+typedef enum eBindingTrigger
+{
+	BINDING_TRIGGER_ALWAYS,			//!< every packet, use it last in a group as the default
+	BINDING_TRIGGER_HELD,			//!< while the button is down
+	BINDING_TRIGGER_PRESSED,		//!< on the packet the button goes down
+	BINDING_TRIGGER_RELEASED,		//!< on the packet the button comes up
+	BINDING_TRIGGER_POSITIVE,		//!< while the shaped, scaled axis is above zero
+	BINDING_TRIGGER_NEGATIVE		//!< while the shaped, scaled axis is below zero
+} BindingTrigger;
+
+///Components that bindings can send to
+typedef enum eBindingTarget
+{
+	BINDING_TARGET_DRIVETRAIN,
+	BINDING_TARGET_CONVEYOR,
+	BINDING_TARGET_CUBE,
+	BINDING_TARGET_CANLIFTER,
+	BINDING_TARGET_CLAW,
+	BINDING_TARGET_NOODLEFAN,
+	BINDING_TARGET_COUNT
+} BindingTarget;
+
+///Response curves that bindings can shape an axis with
+typedef enum eBindingShaper
+{
+	BINDING_SHAPER_NONE,
+	BINDING_SHAPER_TANK,
+	BINDING_SHAPER_ARCADE,
+	BINDING_SHAPER_CANLIFTER,
+	BINDING_SHAPER_CUBECLICKER,
+	BINDING_SHAPER_COUNT
+} BindingShaper;
+
+///How a message parameter is filled in
+typedef enum eBindingParamKind
+{
+	BINDING_PARAM_AXIS,				//!< float, the shaped, scaled axis
+	BINDING_PARAM_NEARZERO			//!< bool, the shaped, scaled axis is within threshold of zero
+} BindingParamKind;
+
+///One parameter of a binding as written in the table
+struct InputBindingParamSpec {
+	int iSlot;				//offset of the field in MessageParams, in 32 bit words
+	BindingParamKind kind;
+	int iDevice;
+	int iAxis;
+	BindingShaper shaper;
+	float fScale;
+	float fThreshold;
+};
+
+///One binding as written in the table, see the file format above
+struct InputBindingSpec {
+	int iMode;				//a DriveMode or INPUT_BINDING_MODE_ANY
+	BindingTarget target;
+	int iGroup;
+	MessageCommand command;
+	int iDevice;
+	BindingTrigger trigger;
+	int iInput;
+	BindingShaper shaper;
+	float fScale;
+	int iParams;
+	InputBindingParamSpec params[INPUT_BINDING_MAX_PARAMS];
+	bool bOnChange;
+};
+
+class InputBindings
+{
+public:
+	InputBindings();
+	~InputBindings();
+
+	bool Load(const char *szPath);
+	void Compile(ComponentBase *pTargets[BINDING_TARGET_COUNT],
+			JoystickListener *pListeners[INPUT_BINDING_DEVICES],
+			AxisShaper *pShapers[BINDING_SHAPER_COUNT]);
+	void Dispatch(int iMode);
+	void Reset();
+	void PutMessageRates();
+	int GetCount() { return(iBindings); };
+
+private:
+	///A parameter with its pointers looked up
+	struct Param {
+		int iSlot;
+		BindingParamKind kind;
+		JoystickListener *pListener;
+		unsigned uAxis;
+		AxisShaper *pShaper;
+		float fScale;
+		float fThreshold;
+		unsigned uSentCount;	//axis change count when the binding was last sent
+	};
+
+	///A binding with its pointers looked up, laid out for the per packet loop
+	struct Binding {
+		int iMode;
+		int iGroupEnd;		//index just past the last binding of this group
+		BindingTrigger trigger;
+		JoystickListener *pListener;
+		unsigned uInput;
+		AxisShaper *pShaper;
+		float fScale;
+		ComponentBase *pTarget;
+		BindingTarget target;
+		MessageCommand command;
+		bool bOnChange;
+		bool bLastSent;		//this was the last binding of its group to be sent
+		int iShadow;		//the group's shadow
+		int iParams;
+		Param params[INPUT_BINDING_MAX_PARAMS];
+	};
+
+	///The last message a group sent and how many were wanted and sent
+	struct Shadow {
+		BindingTarget target;
+		bool bValid;
+		RobotMessage message;
+		unsigned uSentPacket;
+		unsigned uOffered;		//messages the bindings fired, what would go out with no shadow
+		unsigned uSent;
+		unsigned uLastOffered;	//at the last PutMessageRates()
+		unsigned uLastSent;
+		TelemetryKey keyOffered;	//"<component> <group> msgs/s offered", registered by Compile()
+		TelemetryKey keySent;
+	};
+
+	InputBindingSpec specs[INPUT_BINDINGS_MAX];
+	int iSpecs;
+	Binding bindings[INPUT_BINDINGS_MAX];
+	int iBindings;
+	Shadow shadows[INPUT_BINDINGS_MAX];	//one for each group
+	int iShadows;
+	unsigned uPacket;
+	Timer *pRateTimer;
+
+	void LoadDefaults();
+	bool ParseLine(char *szLine, InputBindingSpec &spec);
+	static bool ParamsMoved(const Binding &binding);
+	void Send(const Binding &binding, const RobotMessage &message);
+	static float ReadAxis(JoystickListener *pListener, unsigned uAxis, AxisShaper *pShaper, float fScale);
+};
+
+#endif //INPUT_BINDINGS_H
@@ -6,72 +6,162 @@
 
 JoystickListener::JoystickListener(Joystick *j) {
 	stick = j;
-	axisTolerance = .0001;
+	buttonsDown = 0;
+	buttonsPressed = 0;
+	buttonsReleased = 0;
+	axesMoved = 0;
 
-	for (int i = 0; i < JOYSTICK_BUTTON_COUNT; i++)
-	{
-		buttonsDown.push_back(stick->GetRawButton(i + 1));
-	}
 	for (int i = 0; i < JOYSTICK_AXIS_COUNT; i++)
 	{
-		//the ID is 1 greater than the location in the vector
-		axisValues.push_back(stick->GetRawAxis(i + 1));
+		axisValues[i] = 0.0;
+		filteredAxisValues[i] = 0.0;
+		axisTolerance[i] = JOYSTICK_AXIS_TOLERANCE;
+		axisFilter[i] = JOYSTICK_AXIS_FILTER;
+		axisChangeCount[i] = 0;
 	}
+
+	// take a first snapshot so nothing held at boot shows up as a press
+
+	Update();
+	buttonsPressed = 0;
+	buttonsReleased = 0;
 }
 JoystickListener::~JoystickListener() {
 
 }
 
 /**
- * Updates the stored "previous" values of each button and axis.
- * Be sure to call this at the END of the run function so that you have these values during the next cycle.
+ * Reads every button and axis once and works out the edges since the last call.
+ * Be sure to call this at the START of the run function, before any of the queries.
  */
-void JoystickListener::FinalUpdate() {
-	for (unsigned int i = 0; i < buttonsDown.size(); i++)
+void JoystickListener::Update() {
+	uint32_t buttonsLast = buttonsDown;
+	uint32_t buttonsChanged;
+
+	buttonsDown = 0;
+
+	for (int i = 0; i < JOYSTICK_BUTTON_COUNT; i++)
 	{
-		buttonsDown[i] = stick->GetRawButton(i + 1);
+		if (stick->GetRawButton(i + 1))
+		{
+			buttonsDown |= ButtonBit(i + 1);
+		}
 	}
-	for (unsigned int i = 0; i < axisValues.size(); i++)
+
+	buttonsChanged = buttonsDown ^ buttonsLast;
+	buttonsPressed = buttonsChanged & buttonsDown;
+	buttonsReleased = buttonsChanged & buttonsLast;
+
+	axesMoved = 0;
+
+	for (int i = 0; i < JOYSTICK_AXIS_COUNT; i++)
 	{
-		axisValues[i] = stick->GetRawAxis(i + 1);
+		float target;
+
+		filteredAxisValues[i] += axisFilter[i] * (stick->GetRawAxis(i) - filteredAxisValues[i]);
+		target = filteredAxisValues[i];
+
+		// the filter only creeps toward rest and full scale, snap to them inside the band
+
+		if (std::abs(target) < axisTolerance[i])
+		{
+			target = 0.0;
+		}
+		else if (target > 1.0 - axisTolerance[i])
+		{
+			target = 1.0;
+		}
+		else if (target < -1.0 + axisTolerance[i])
+		{
+			target = -1.0;
+		}
+
+		if ((target != axisValues[i])
+				&& ((std::abs(target - axisValues[i]) > axisTolerance[i])
+						|| (target == 0.0) || (std::abs(target) == 1.0)))
+		{
+			axisValues[i] = target;
+			axisChangeCount[i]++;
+			axesMoved |= (uint32_t) 1 << i;
+		}
 	}
 }
 
+///Returns true if the target button is down in this cycle.
+bool JoystickListener::ButtonDown(unsigned int button) {
+	return (button > 0 && button <= JOYSTICK_BUTTON_COUNT
+			&& (buttonsDown & ButtonBit(button)));
+}
+
 ///Returns true if the target button was up in the previous cycle but is down in the current cycle.
 bool JoystickListener::ButtonPressed(unsigned int button) {
-	if (button > 0 && button <= buttonsDown.size()
-			&& stick->GetRawButton(button) && !buttonsDown[button - 1])
-	{
-		return true;
-	}
-	return false;
+	return (button > 0 && button <= JOYSTICK_BUTTON_COUNT
+			&& (buttonsPressed & ButtonBit(button)));
 }
 
 ///Returns true if the target button was down in the previous cycle but is up in the current cycle.
 bool JoystickListener::ButtonReleased(unsigned int button) {
-	if (button > 0 && button <= buttonsDown.size()
-			&& !stick->GetRawButton(button) && buttonsDown[button - 1])
+	return (button > 0 && button <= JOYSTICK_BUTTON_COUNT
+			&& (buttonsReleased & ButtonBit(button)));
+}
+
+///Returns the value of the axis in this cycle, 0.0 for an axis that isn't watched.
+float JoystickListener::GetAxis(unsigned int axis) {
+	if (axis < JOYSTICK_AXIS_COUNT)
 	{
-		return true;
+		return axisValues[axis];
 	}
-	return false;
+	return 0.0;
 }
 
-///Returns true if given axis moved at least the tolerated distance between the cycles.
+///Returns true if given axis moved out of its hysteresis band this cycle.
 bool JoystickListener::AxisMoved(unsigned int axis) {
-	if (axis > 0 && axis <= axisValues.size()
-			&& std::abs(stick->GetRawAxis(axis) - axisValues[axis - 1])
-					> axisTolerance)
+	return (axis < JOYSTICK_AXIS_COUNT && (axesMoved & ((uint32_t) 1 << axis)));
+}
+
+///Returns how many times the axis has moved, compare with an earlier count to see if it changed since.
+unsigned JoystickListener::GetAxisChangeCount(unsigned int axis) {
+	if (axis < JOYSTICK_AXIS_COUNT)
 	{
-		return true;
+		return axisChangeCount[axis];
 	}
-	return false;
+	return 0;
 }
 
+///Sets the hysteresis band of every axis.
 void JoystickListener::SetAxisTolerance(float tolerance) {
-	axisTolerance = tolerance;
+	for (int i = 0; i < JOYSTICK_AXIS_COUNT; i++)
+	{
+		axisTolerance[i] = tolerance;
+	}
 }
 
-float JoystickListener::GetAxisTolerance() {
-	return axisTolerance;
+void JoystickListener::SetAxisTolerance(unsigned int axis, float tolerance) {
+	if (axis < JOYSTICK_AXIS_COUNT)
+	{
+		axisTolerance[axis] = tolerance;
+	}
+}
+
+float JoystickListener::GetAxisTolerance(unsigned int axis) {
+	if (axis < JOYSTICK_AXIS_COUNT)
+	{
+		return axisTolerance[axis];
+	}
+	return 0.0;
+}
+
+///Sets the low pass filter of every axis, the weight given to each new reading: 1.0 turns it off.
+void JoystickListener::SetAxisFilter(float filter) {
+	for (int i = 0; i < JOYSTICK_AXIS_COUNT; i++)
+	{
+		axisFilter[i] = filter;
+	}
+}
+
+void JoystickListener::SetAxisFilter(unsigned int axis, float filter) {
+	if (axis < JOYSTICK_AXIS_COUNT)
+	{
+		axisFilter[axis] = filter;
+	}
 }
@@ -2,31 +2,59 @@
  * The JoystickListener class monitors the inputs of a joystick
  * and can be used to register when a button was pressed or released.
  *
- * the input's ID is 1 greater than its representative location in
- * the vector, which is accounted for in the code.
+ * Call Update() once at the start of each driver station packet.  It reads
+ * every button and axis exactly once into a snapshot: the buttons are packed
+ * into a bitmask (button ID n is bit n - 1) and the axes into an array indexed
+ * by axis ID.  Every query during the cycle answers from that snapshot, so the
+ * inputs are consistent with each other and cost nothing to ask for twice.
  *
- * NOTE: the axis movement feature currently does not work.
+ * Axes are smoothed by a low pass filter and then held inside a hysteresis band:
+ * the value GetAxis() returns only moves when the filtered stick has moved more
+ * than the tolerance, snapping to exactly 0.0 and +-1.0 near the ends.  Every
+ * move bumps the axis's change count, so a user can tell if an axis has changed
+ * since it last sent a value by comparing counts.
  */
 
 #ifndef JOYSTICKLISTENER_H_
 #define JOYSTICKLISTENER_H_
 
 #include "WPILib.h"
+#include "RobotParams.h"
+
+#include <stdint.h>
+
 class JoystickListener {
 public:
 	JoystickListener(Joystick*);
 	~JoystickListener();
-	void FinalUpdate();
+	void Update();
+	bool ButtonDown(unsigned int);
 	bool ButtonPressed(unsigned int);
 	bool ButtonReleased(unsigned int);
+	float GetAxis(unsigned int);
 	bool AxisMoved(unsigned int);
+	unsigned GetAxisChangeCount(unsigned int);
+	uint32_t GetButtons() { return buttonsDown; };
+	uint32_t GetPressed() { return buttonsPressed; };
+	uint32_t GetReleased() { return buttonsReleased; };
 	void SetAxisTolerance(float);
-	float GetAxisTolerance();
+	void SetAxisTolerance(unsigned int, float);
+	float GetAxisTolerance(unsigned int);
+	void SetAxisFilter(float);
+	void SetAxisFilter(unsigned int, float);
 private:
 	Joystick *stick;
-	std::vector<bool> buttonsDown;
-	std::vector<float> axisValues;
-	float axisTolerance;
+	uint32_t buttonsDown;
+	uint32_t buttonsPressed;
+	uint32_t buttonsReleased;
+	uint32_t axesMoved; //bit n set if axis n moved this cycle
+	float axisValues[JOYSTICK_AXIS_COUNT]; //filtered and held in the hysteresis band
+	float filteredAxisValues[JOYSTICK_AXIS_COUNT];
+	float axisTolerance[JOYSTICK_AXIS_COUNT]; //hysteresis band
+	float axisFilter[JOYSTICK_AXIS_COUNT]; //weight of each new reading, 1.0 is no filtering
+	unsigned axisChangeCount[JOYSTICK_AXIS_COUNT];
+
+	static uint32_t ButtonBit(unsigned int button) { return (uint32_t) 1 << (button - 1); };
 };
 
 #endif /* JOYSTICKLISTENER_H_ */
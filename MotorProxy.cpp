@@ -0,0 +1,223 @@
+/** \file
+ * Implementation of the motor proxy.
+ *
+ * Each kind of write keeps the value last sent and whether one has been sent at
+ * all; until one has, the call always goes through.
+ */
+
+#include "MotorProxy.h"
+
+#include <time.h>
+
+#include "CanBusMonitor.h"
+
+MotorProxy::MotorProxy(HalMotor *pMotor, const char *szName)
+{
+	this->pMotor = pMotor;
+	iDeviceNumber = pMotor->GetDeviceNumber();
+	fSetpoint = 0.0;
+	controlMode = HAL_CONTROL_PERCENT_VBUS;
+	fRampRate = 0.0;
+	limitMode = HAL_LIMIT_SWITCH_INPUTS_ONLY;
+	neutralMode = HAL_NEUTRAL_JUMPER;
+	Invalidate();
+
+	fRefreshPeriod = 0.0;
+	fLastFrame = Now();
+	uFrames = 0;
+	uSaved = 0;
+
+	CanBusMonitor::RegisterDevice(iDeviceNumber, szName, CANBUS_DEVICE_TALON);
+}
+
+MotorProxy::~MotorProxy()
+{
+	delete pMotor;
+}
+
+void MotorProxy::Set(float fValue)
+{
+	double fNow = Now();
+
+	CheckRefresh(fNow);
+
+	if(bSetpointSent && (fValue == fSetpoint))
+	{
+		Skipped();
+		return;
+	}
+
+	pMotor->Set(fValue);
+	fSetpoint = fValue;
+	bSetpointSent = true;
+	Sent(fNow, false);
+}
+
+///A new mode changes what the setpoint means, so the next Set() is sent too
+void MotorProxy::SetControlMode(HalControlMode mode)
+{
+	double fNow = Now();
+
+	if(bControlModeSent && (mode == controlMode))
+	{
+		Skipped();
+		return;
+	}
+
+	pMotor->SetControlMode(mode);
+	controlMode = mode;
+	bControlModeSent = true;
+	bSetpointSent = false;
+	Sent(fNow, true);
+}
+
+void MotorProxy::SetVoltageRampRate(double fRate)
+{
+	double fNow = Now();
+
+	if(bRampRateSent && (fRate == fRampRate))
+	{
+		Skipped();
+		return;
+	}
+
+	pMotor->SetVoltageRampRate(fRate);
+	fRampRate = fRate;
+	bRampRateSent = true;
+	Sent(fNow, true);
+}
+
+void MotorProxy::ConfigLimitMode(HalLimitMode mode)
+{
+	double fNow = Now();
+
+	if(bLimitModeSent && (mode == limitMode))
+	{
+		Skipped();
+		return;
+	}
+
+	pMotor->ConfigLimitMode(mode);
+	limitMode = mode;
+	bLimitModeSent = true;
+	Sent(fNow, true);
+}
+
+void MotorProxy::ConfigNeutralMode(HalNeutralMode mode)
+{
+	double fNow = Now();
+
+	if(bNeutralModeSent && (mode == neutralMode))
+	{
+		Skipped();
+		return;
+	}
+
+	pMotor->ConfigNeutralMode(mode);
+	neutralMode = mode;
+	bNeutralModeSent = true;
+	Sent(fNow, true);
+}
+
+void MotorProxy::SetRefreshPeriod(float fSeconds)
+{
+	fRefreshPeriod = fSeconds;
+}
+
+void MotorProxy::Invalidate()
+{
+	bSetpointSent = false;
+	bControlModeSent = false;
+	bRampRateSent = false;
+	bLimitModeSent = false;
+	bNeutralModeSent = false;
+}
+
+///Only set at construction, so these aren't cached
+void MotorProxy::ConfigFwdLimitSwitchNormallyOpen(bool bNormallyOpen)
+{
+	pMotor->ConfigFwdLimitSwitchNormallyOpen(bNormallyOpen);
+	uFrames++;
+	CanBusMonitor::CountConfig(iDeviceNumber);
+}
+
+void MotorProxy::ConfigRevLimitSwitchNormallyOpen(bool bNormallyOpen)
+{
+	pMotor->ConfigRevLimitSwitchNormallyOpen(bNormallyOpen);
+	uFrames++;
+	CanBusMonitor::CountConfig(iDeviceNumber);
+}
+
+void MotorProxy::SetStatusFrameRateMs(HalStatusFrame frame, int iPeriodMs)
+{
+	pMotor->SetStatusFrameRateMs(frame, iPeriodMs);
+	CanBusMonitor::SetStatusPeriod(iDeviceNumber, frame, iPeriodMs * 1.0e-3);
+	uFrames++;
+	CanBusMonitor::CountConfig(iDeviceNumber);
+}
+
+void MotorProxy::Sent(double fNow, bool bConfig)
+{
+	uFrames++;
+	fLastFrame = fNow;
+
+	if(bConfig)
+	{
+		CanBusMonitor::CountConfig(iDeviceNumber);
+	}
+	else
+	{
+		CanBusMonitor::CountControl(iDeviceNumber);
+	}
+}
+
+void MotorProxy::Skipped()
+{
+	uSaved++;
+	CanBusMonitor::CountSaved(iDeviceNumber);
+}
+
+///Once the Talon has heard nothing for a refresh period, sends it the configuration it should have
+void MotorProxy::CheckRefresh(double fNow)
+{
+	bool bControlMode = bControlModeSent;
+	bool bRampRate = bRampRateSent;
+	bool bLimitMode = bLimitModeSent;
+	bool bNeutralMode = bNeutralModeSent;
+
+	if((fRefreshPeriod <= 0.0) || ((fNow - fLastFrame) < fRefreshPeriod))
+	{
+		return;
+	}
+
+	Invalidate();
+
+	if(bControlMode)
+	{
+		SetControlMode(controlMode);
+	}
+
+	if(bLimitMode)
+	{
+		ConfigLimitMode(limitMode);
+	}
+
+	if(bNeutralMode)
+	{
+		ConfigNeutralMode(neutralMode);
+	}
+
+	if(bRampRate)
+	{
+		SetVoltageRampRate(fRampRate);
+	}
+
+	// the setpoint goes out with the Set() that got us here
+
+	fLastFrame = fNow;
+}
+
+double MotorProxy::Now()
+{
+	return(Hal::Now());
+}
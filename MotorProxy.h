@@ -0,0 +1,80 @@
+/** \file
+ * Definitions of the motor proxy, a motor that only talks to the bus when something changes.
+ *
+ * Every Set() and every Config call on a CANTalon becomes a CAN frame, and the
+ * components call them every pass whether or not the value changed.  The proxy
+ * keeps the last setpoint and the last limit mode, neutral mode, ramp rate and
+ * control mode it sent and passes a call on only if it differs.  The Talon
+ * repeats its control frame on its own, so skipping a repeated Set() does not
+ * let the motor time out.
+ *
+ * A Talon that browns out comes back with its defaults, so SetRefreshPeriod()
+ * can have the proxy send everything again once the last frame is that old.
+ * The proxy registers its device with the CAN bus monitor and counts every
+ * frame it sends and every call it saves there.
+ *
+ * The proxy wraps whatever motor the HAL backend made; Hal::NewMotor() hands
+ * out nothing else.  It belongs to the one task that drives the motor and is
+ * not locked.  Reads go straight to the motor underneath.
+ */
+
+#ifndef MOTOR_PROXY_H
+#define MOTOR_PROXY_H
+
+#include "Hal.h"
+
+class MotorProxy : public HalMotor
+{
+public:
+	MotorProxy(HalMotor *pMotor, const char *szName); //takes ownership of pMotor
+	virtual ~MotorProxy();
+
+	void Set(float fValue);
+	float Get() { return(pMotor->Get()); };
+	void SetControlMode(HalControlMode mode);
+	void SetVoltageRampRate(double fRampRate);
+	void ConfigLimitMode(HalLimitMode mode);
+	void ConfigNeutralMode(HalNeutralMode mode);
+	void ConfigFwdLimitSwitchNormallyOpen(bool bNormallyOpen);
+	void ConfigRevLimitSwitchNormallyOpen(bool bNormallyOpen);
+	void SetStatusFrameRateMs(HalStatusFrame frame, int iPeriodMs); //also tells the monitor
+
+	bool IsAlive() { return(pMotor->IsAlive()); };
+	bool IsFwdLimitSwitchClosed() { return(pMotor->IsFwdLimitSwitchClosed()); };
+	bool IsRevLimitSwitchClosed() { return(pMotor->IsRevLimitSwitchClosed()); };
+	float GetOutputCurrent() { return(pMotor->GetOutputCurrent()); };
+	float GetBusVoltage() { return(pMotor->GetBusVoltage()); };
+	int GetPinStateQuadB() { return(pMotor->GetPinStateQuadB()); };
+	int GetDeviceNumber() { return(iDeviceNumber); };
+
+	void SetRefreshPeriod(float fSeconds); //send everything again when the last frame is this old, 0 never does
+	void Invalidate(); //the next call of each kind goes to the Talon
+	unsigned GetFrameCount() { return(uFrames); }; //frames sent since construction
+	unsigned GetSavedCount() { return(uSaved); }; //calls that matched what the Talon already had
+
+private:
+	HalMotor *pMotor;
+	int iDeviceNumber;
+	float fSetpoint;
+	HalControlMode controlMode;
+	double fRampRate;
+	HalLimitMode limitMode;
+	HalNeutralMode neutralMode;
+	bool bSetpointSent;
+	bool bControlModeSent;
+	bool bRampRateSent;
+	bool bLimitModeSent;
+	bool bNeutralModeSent;
+
+	float fRefreshPeriod;
+	double fLastFrame;
+	unsigned uFrames;
+	unsigned uSaved;
+
+	void Sent(double fNow, bool bConfig);
+	void Skipped();
+	void CheckRefresh(double fNow);
+	static double Now();
+};
+
+#endif //MOTOR_PROXY_H
@@ -13,21 +13,21 @@
 #include "ComponentBase.h"
 #include "RobotParams.h"
 
-NoodleFan::NoodleFan() :
-		ComponentBase(NOODLEFAN_TASKNAME, NOODLEFAN_QUEUE, NOODLEFAN_PRIORITY) {
+NoodleFan::NoodleFan(Hal *pHal) :
+		ComponentBase(pHal, NOODLEFAN_TASKNAME, NOODLEFAN_QUEUE, NOODLEFAN_PRIORITY) {
 
-	fanMotor = new CANTalon(CAN_PALLET_JACK_NOODLE_FAN);
+	fanMotor = pHal->NewMotor(CAN_PALLET_JACK_NOODLE_FAN, "NoodleFan");
 	wpi_assert(fanMotor);
 	fanMotor->SetVoltageRampRate(120.0);
 
 	fanMotor->ConfigNeutralMode(
-			CANSpeedController::NeutralMode::kNeutralMode_Brake);
+			HAL_NEUTRAL_BRAKE);
 
 	wpi_assert(fanMotor->IsAlive());
 	pTask = new Task(NOODLEFAN_TASKNAME, (FUNCPTR) &NoodleFan::StartTask,
 			NOODLEFAN_PRIORITY, NOODLEFAN_STACKSIZE);
 	wpi_assert(pTask);
-	pTask->Start((int) this);
+	pTask->Start((intptr_t) this);
 }
 
 NoodleFan::~NoodleFan() {
@@ -15,7 +15,7 @@
 class NoodleFan : public ComponentBase
 {
 public:
-	NoodleFan();
+	NoodleFan(Hal *pHal);
 	virtual ~NoodleFan();
 	static void *StartTask(void *pThis)
 	{
@@ -25,7 +25,7 @@ public:
 
 private:
 
-	CANTalon *fanMotor;
+	HalMotor *fanMotor;
 	const float fPower = 1.0;
 
 	bool bBlowing = false;
@@ -8,16 +8,26 @@
 
 #include "RhsRobot.h"
 #include "WPILib.h"
+#include <math.h>
 
 //Robot
 #include "ComponentBase.h"
 #include "RobotParams.h"
 
+//the drive mode chooser hands back pointers, these are what it points to
+static DriveMode driveModeTank = DRIVE_MODE_TANK;
+static DriveMode driveModeArcade = DRIVE_MODE_ARCADE;
+static DriveMode driveModeCurvature = DRIVE_MODE_CURVATURE;
+
 RhsRobot::RhsRobot() {
 	Controller_1 = NULL;
 	Controller_2 = NULL;
 	ControllerListen_1 = NULL;
 	ControllerListen_2 = NULL;
+	tankDriveShaper = NULL;
+	arcadeDriveShaper = NULL;
+	canLifterShaper = NULL;
+	cubeClickerShaper = NULL;
 	drivetrain = NULL;
 	autonomous = NULL;
 	conveyor = NULL;
@@ -26,7 +36,10 @@ RhsRobot::RhsRobot() {
 	claw = NULL;
 	//canarm = NULL;
 	noodlefan = NULL;
+	driveModeChooser = NULL;
+	inputBindings = NULL;
 
+	driveMode = DRIVE_MODE_TANK;
 	bLastConveyorButtonDown = false;
 	bCanlifterNearBottom = false;
 
@@ -45,28 +58,61 @@ RhsRobot::~RhsRobot() {
 	delete Controller_2;
 	delete ControllerListen_1;
 	delete ControllerListen_2;
+	delete tankDriveShaper;
+	delete arcadeDriveShaper;
+	delete canLifterShaper;
+	delete cubeClickerShaper;
+	delete driveModeChooser;
+	delete inputBindings;
 }
 
 void RhsRobot::Init() {
 	/* 
 	 * Set all pointers to null and then allocate memory and construct objects
 	 * EXAMPLE:	drivetrain = NULL; (in constructor)
-	 * 			drivetrain = new Drivetrain(); (in RhsRobot::Init())
+	 * 			drivetrain = new Drivetrain(pHal); (in RhsRobot::Init())
 	 */
 	Controller_1 = new Joystick(0);
 	Controller_2 = new Joystick(1);
 	ControllerListen_1 = new JoystickListener(Controller_1);
 	ControllerListen_2 = new JoystickListener(Controller_2);
-	ControllerListen_1->SetAxisTolerance(.05);
-	ControllerListen_2->SetAxisTolerance(.05);
-	drivetrain = new Drivetrain();
-	conveyor = new Conveyor();
-	canlifter = new CanLifter();
-	claw = new Claw();
-	cube = new Cube();
-	//canarm = new CanArm();
-	noodlefan = new NoodleFan();
-	autonomous = new Autonomous();
+	// response curves are baked into lookup tables once, here, not per packet
+	tankDriveShaper = new AxisShaper(TANK_DRIVE_CURVE);
+	arcadeDriveShaper = new AxisShaper(ARCADE_DRIVE_CURVE);
+	canLifterShaper = new AxisShaper(CANLIFTER_CURVE);
+	cubeClickerShaper = new AxisShaper(CUBECLICKER_CURVE);
+
+	driveModeChooser = new SendableChooser();
+	driveModeChooser->AddDefault("Tank", &driveModeTank);
+	driveModeChooser->AddObject("Arcade", &driveModeArcade);
+	driveModeChooser->AddObject("Curvature", &driveModeCurvature);
+	SmartDashboard::PutData("Drive Mode", driveModeChooser);
+
+	drivetrain = new Drivetrain(pHal);
+	conveyor = new Conveyor(pHal);
+	canlifter = new CanLifter(pHal);
+	claw = new Claw(pHal);
+	cube = new Cube(pHal);
+	//canarm = new CanArm(pHal);
+	noodlefan = new NoodleFan(pHal);
+	autonomous = new Autonomous(pHal);
+
+	if(drivetrain && autonomous)
+	{
+		// so autonomous hears when a seek runs into the tote
+		drivetrain->GetSensorFusion()->Subscribe(AUTONOMOUS_QUEUE);
+	}
+
+	// controller layouts come from a file so they can be swapped without a rebuild
+
+	ComponentBase *pBindingTargets[BINDING_TARGET_COUNT] = { drivetrain, conveyor, cube, canlifter, claw, noodlefan };
+	JoystickListener *pBindingListeners[INPUT_BINDING_DEVICES] = { ControllerListen_1, ControllerListen_2 };
+	AxisShaper *pBindingShapers[BINDING_SHAPER_COUNT] = { NULL, tankDriveShaper, arcadeDriveShaper,
+			canLifterShaper, cubeClickerShaper };
+
+	inputBindings = new InputBindings();
+	inputBindings->Load(INPUT_BINDINGS_FILEPATH);
+	inputBindings->Compile(pBindingTargets, pBindingListeners, pBindingShapers);
 
 	std::vector<ComponentBase *>::iterator nextComponent = ComponentSet.begin();
 
@@ -114,6 +160,13 @@ void RhsRobot::Init() {
 void RhsRobot::OnStateChange() {
 	std::vector<ComponentBase *>::iterator nextComponent;
 
+	// components drop their setpoints on a state change, send them all again
+
+	if(inputBindings)
+	{
+		inputBindings->Reset();
+	}
+
 	for(nextComponent = ComponentSet.begin();
 			nextComponent != ComponentSet.end(); ++nextComponent)
 	{
@@ -123,14 +176,15 @@ void RhsRobot::OnStateChange() {
 
 void RhsRobot::Run() {
 	//SmartDashboard::PutString("ROBOT STATUS", "Running");
-	/* Poll for control data and send messages to each subsystem. Surround blocks with if(component) so entire components can be disabled
-	 * by commenting out their construction.
-	 * EXAMPLE: if(drivetrain) 
-	 * 			{ 
-	 * 				//Check joysticks and send messages 
-	 * 			}
+	/* Poll for control data and send messages to each subsystem. Components can still be disabled by commenting
+	 * out their construction, their bindings are dropped when the table is compiled in Init().
 	 */
 
+	// one read of each controller per packet, everything below answers from the snapshot
+
+	ControllerListen_1->Update();
+	ControllerListen_2->Update();
+
 	if(autonomous)
 	{
 		if(GetCurrentRobotState() == ROBOT_STATE_AUTONOMOUS)
@@ -140,211 +194,27 @@ void RhsRobot::Run() {
 		}
 	}
 
-	if (drivetrain)
-	{
-		//for keepalign tests: comment out everything to the sendMessage
-		//also comment out the if (ISAUTO) at the bottom of Drivetrain::Run()
-		//robotMessage.command = COMMAND_DRIVETRAIN_START_KEEPALIGN;
-
-#if 1
-		robotMessage.command = COMMAND_DRIVETRAIN_DRIVE_TANK;
-			robotMessage.params.tankDrive.left = TANK_DRIVE_LEFT * fDriveMax;
-			robotMessage.params.tankDrive.right = TANK_DRIVE_RIGHT * fDriveMax;
-
-#else
-		robotMessage.command = COMMAND_DRIVETRAIN_DRIVE_ARCADE;
-		robotMessage.params.arcadeDrive.x = ARCADE_DRIVE_X;
-		robotMessage.params.arcadeDrive.y = ARCADE_DRIVE_Y;
-#endif
-		drivetrain->SendMessage(&robotMessage);
-	}
+	// the drivers can change modes from the dashboard without a rebuild
 
-	if(conveyor)
+	if((iLoop % iDriveModePollLoops) == 0)
 	{
-		if(CONVEYOR_FWD)
-		{ //only used for autonomous and depositing cans
-			//SmartDashboard::PutString("Conveyor Mode", "Output Front");
-			robotMessage.command = COMMAND_CONVEYOR_RUN_FWD;
-			//if(!bLastConveyorButtonDown)
-			//{
-			//	robotMessage.params.conveyorParams.bButtonWentDownEvent = true;
-			//	bLastConveyorButtonDown = true;
-			//}
-			//else
-			//{
-			//	robotMessage.params.conveyorParams.bButtonWentDownEvent = false;
-			//}
-		}
-		else if(CONVEYOR_BCK)
-		{ //used to intake and deposit totes
-			//SmartDashboard::PutString("Conveyor Mode", "Output Back");
-			robotMessage.command = COMMAND_CONVEYOR_RUN_BCK;
-
-			//if(!bLastConveyorButtonDown)
-			//{
-			//	robotMessage.params.conveyorParams.bButtonWentDownEvent = true;
-			//	bLastConveyorButtonDown = true;
-			//}
-			//else
-			//{
-			//	robotMessage.params.conveyorParams.bButtonWentDownEvent = false;
-			//}
-		}
-		else
-		{
-			//SmartDashboard::PutString("Conveyor Mode", "Stopped");
-			robotMessage.command = COMMAND_CONVEYOR_STOP;
-			//robotMessage.params.conveyorParams.bButtonWentDownEvent = false;
-			//bLastConveyorButtonDown = false;
-		}
-
-		conveyor->SendMessage(&robotMessage);
-	}
-
-	if(cube)
-	{
-		if(ControllerListen_1->ButtonPressed(CUBEAUTO_START_ID) ||
-				ControllerListen_2->ButtonPressed(CUBEAUTO_START_ID))
-		{
-			//SmartDashboard::PutString("Robot->Cube", "Auto Start");
-			robotMessage.command = COMMAND_CUBEAUTOCYCLE_START;
-			cube->SendMessage(&robotMessage);
-		}
-		else if(ControllerListen_1->ButtonPressed(CUBEAUTO_STOP_ID) ||
-				ControllerListen_2->ButtonPressed(CUBEAUTO_STOP_ID))
-		{
-			//SmartDashboard::PutString("Robot->Cube", "Auto Stop");
-			robotMessage.command = COMMAND_CUBEAUTOCYCLE_STOP;
-			cube->SendMessage(&robotMessage);
-		}
-		else if(ControllerListen_1->ButtonPressed(CUBEAUTO_HOLD_ID) ||
-				ControllerListen_2->ButtonPressed(CUBEAUTO_HOLD_ID))
-		{
-			//SmartDashboard::PutString("Robot->Cube", "Hold");
-			robotMessage.command = COMMAND_CUBEAUTOCYCLE_HOLD;
-			cube->SendMessage(&robotMessage);
-		}
-		else if(ControllerListen_1->ButtonPressed(CUBEAUTO_RELEASE_ID) ||
-				ControllerListen_2->ButtonPressed(CUBEAUTO_RELEASE_ID))
-		{
-			//SmartDashboard::PutString("Robot->Cube", "Release");
-			robotMessage.command = COMMAND_CUBEAUTOCYCLE_RELEASE;
-			cube->SendMessage(&robotMessage);
-		}
-
-		if(CUBECLICKER_RAISE)
-		{
-			robotMessage.command = COMMAND_CUBECLICKER_RAISE;
-		}
-		else if(CUBECLICKER_LOWER)
-		{
-			robotMessage.command = COMMAND_CUBECLICKER_LOWER;
-		}
-		else
-		{
-			robotMessage.command = COMMAND_CUBECLICKER_STOP;
-		}
-
-		cube->SendMessage(&robotMessage);
+		DriveMode *pSelected = (DriveMode *)driveModeChooser->GetSelected();
 
-		//Intake should always run
-		/*if(CUBEINTAKE_RUN)
+		if(pSelected)
 		{
-			robotMessage.command = COMMAND_CUBEINTAKE_RUN;
+			driveMode = *pSelected;
 		}
-		else
-		{
-			robotMessage.command = COMMAND_CUBEINTAKE_STOP;
-		}
-
-		cube->SendMessage(&robotMessage);*/
-	}
-
-	if(canlifter)
-	{
-		/*if (canlifter->GetHallEffectBottom()
-				|| (canlifter->GetHallEffectMiddle() && CANLIFTER_LOWER > .1))
-		{
-			//if lift is at bottom or lowering past the middle hall effect
-			bCanlifterNearBottom = true;
-		}
-		if (canlifter->GetHallEffectTop()
-				|| (canlifter->GetHallEffectMiddle() && CANLIFTER_RAISE > .1))
-		{
-			//if lift is at top or raising past the middle hall effect
-			bCanlifterNearBottom = false;
-		}
-
-		SmartDashboard::PutBoolean("Can Lift near bottom", bCanlifterNearBottom);*/
-
-		if(CANLIFTER_RAISE > .1)
-		{
-			robotMessage.command = COMMAND_CANLIFTER_RAISE;
-			robotMessage.params.canLifterParams.lifterSpeed = CANLIFTER_RAISE;
-		}
-		else if(CANLIFTER_LOWER > .1)
-		{
-			robotMessage.command = COMMAND_CANLIFTER_LOWER;
-			robotMessage.params.canLifterParams.lifterSpeed = CANLIFTER_LOWER;
-		}
-		/*else if(ControllerListen_1->ButtonPressed(CANLIFTER_HOVER_ID))
-		{
-			robotMessage.command = COMMAND_CANLIFTER_HOVER;
-		}*/
-		else
-		{
-			robotMessage.command = COMMAND_CANLIFTER_STOP;
-		}
-
-		canlifter->SendMessage(&robotMessage);
 	}
 
-	if (claw)
-	{
-		claw->SendMessage(&robotMessage);
+	// every button and axis the drivers use is in the binding table
 
-		if (ControllerListen_1->ButtonPressed(CLAW_OPEN_ID))
-		{
-			robotMessage.command = COMMAND_CLAW_OPEN;
-		}
-		else if (ControllerListen_1->ButtonPressed(CLAW_CLOSE_ID))
-		{
-			robotMessage.command = COMMAND_CLAW_CLOSE;
-		}
+	inputBindings->Dispatch(driveMode);
 
-		claw->SendMessage(&robotMessage);
-	}
-
-	/*if (canarm)
+	if((iLoop % iMessageRateLoops) == 0)
 	{
-		if(CANARM_OPEN)
-		{
-			robotMessage.command = COMMAND_CANARM_OPEN;
-		}
-		else if(CANARM_CLOSE)
-		{
-			robotMessage.command = COMMAND_CANARM_CLOSE;
-		}
-		else
-		{
-			robotMessage.command = COMMAND_CANARM_STOP;
-		}
-
-		canarm->SendMessage(&robotMessage);
-
-	}*/
-
-	if(noodlefan)
-	{
-		if(ControllerListen_1->ButtonPressed(NOODLEFAN_TOGGLE_ID))
-		{
-			robotMessage.command = COMMAND_NOODLEFAN_TOGGLE;
-		}
-		noodlefan->SendMessage(&robotMessage);
+		inputBindings->PutMessageRates();
 	}
 
-	ControllerListen_1->FinalUpdate();
-	ControllerListen_2->FinalUpdate();
 	iLoop++;
 }
 
@@ -19,6 +19,8 @@
 #include "NoodleFan.h"
 #include "RhsRobotBase.h"
 #include "JoystickListener.h"
+#include "AxisShaper.h"
+#include "InputBindings.h"
 
 class RhsRobot : public RhsRobotBase
 {
@@ -31,6 +33,10 @@ private:
 	Joystick* Controller_2;
 	JoystickListener* ControllerListen_1;
 	JoystickListener* ControllerListen_2;
+	AxisShaper* tankDriveShaper;
+	AxisShaper* arcadeDriveShaper;
+	AxisShaper* canLifterShaper;
+	AxisShaper* cubeClickerShaper;
 	Drivetrain* drivetrain;
 	Autonomous* autonomous;
 	Conveyor* conveyor;
@@ -39,6 +45,8 @@ private:
 	Claw* claw;
 	//CanArm* canarm;
 	NoodleFan *noodlefan;
+	SendableChooser *driveModeChooser;
+	InputBindings *inputBindings;
 
 	std::vector <ComponentBase *> ComponentSet;
 	
@@ -51,7 +59,9 @@ private:
 	bool bLastConveyorButtonDown;
 	bool bCanlifterNearBottom; //used for speed changes in driving
 	const float fDriveReduction = .5;
-	const float fDriveMax = 0.75;
+	const int iDriveModePollLoops = 25;		//how often the drive mode chooser is read, in packets
+	const int iMessageRateLoops = 250;		//how often the message rates go to the dashboard, in packets
+	DriveMode driveMode;
 	int iLoop;
 };
 
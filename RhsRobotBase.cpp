@@ -9,6 +9,9 @@
 #include "RhsRobotBase.h"			//For the local header file
 #include <assert.h>
 #include <sched.h>
+#include <errno.h>
+#include <math.h>
+#include <time.h>
 
 //Built-In
 
@@ -17,6 +20,12 @@
 //Local
 #include "RobotParams.h"			//For various robot parameters
 #include "Autonomous.h"
+#include "HeartbeatMonitor.h"
+#include "Telemetry.h"
+#include "FlightRecorder.h"
+#include "RobotLog.h"
+#include "CanBusMonitor.h"
+#include "HalWpilib.h"
 
 RhsRobotBase::RhsRobotBase()			//Constructor
 {
@@ -31,6 +40,16 @@ RhsRobotBase::RhsRobotBase()			//Constructor
 	CPU_SET(1, &mask);
 	sched_setaffinity(0, sizeof(mask), &mask);
 
+	// the devices come from here, the mode macros ask its driver station and every
+	// task keeps time by its clock, so it comes before any task is started
+
+	pHal = new HalWpilib();
+	Hal::SetInstance(pHal);
+
+	// the console is written by the log task from here on, not the control loops
+
+	RobotLog::Start();
+
     //param.sched_priority = 10;
     //printf("did this work %d\n", sched_setscheduler(0, SCHED_FIFO, &param));
 
@@ -40,10 +59,51 @@ RhsRobotBase::RhsRobotBase()			//Constructor
 	currentRobotState = ROBOT_STATE_UNKNOWN;
 	SmartDashboard::init();
 	loop = 0;			//Initializes the loop counter
+	iHeartbeat = -1;
+	flightState = FlightRecorder::Register("Robot State Command");
+	flightLatency = FlightRecorder::Register("Input Latency");
+	keyLoopPeriod = Telemetry::Register("Loop Period ms", TELEMETRY_NUMBER);
+	keyLoopJitter = Telemetry::Register("Loop Jitter ms", TELEMETRY_NUMBER);
+	keyLoopPeriodMax = Telemetry::Register("Loop Period Max ms", TELEMETRY_NUMBER);
+	keyInputLatency = Telemetry::Register("Input Latency ms", TELEMETRY_NUMBER);
+	keyInputLatencyMax = Telemetry::Register("Input Latency Max ms", TELEMETRY_NUMBER);
+	keyPacketTimeouts = Telemetry::Register("DS Packet Timeouts", TELEMETRY_NUMBER);
+
+	fPacketTime = 0.0;
+	fLastWake = 0.0;
+	fPeriodSum = 0.0;
+	fPeriodSquaredSum = 0.0;
+	fPeriodMax = 0.0;
+	fLatencySum = 0.0;
+	fLatencyMax = 0.0;
+	iPeriods = 0;
+	iPacketTimeouts = 0;
+	fLoopPeriod = 0.0;
+	fLoopJitter = 0.0;
+	fLoopPeriodMax = 0.0;
+	fInputLatency = 0.0;
+
+	pthread_condattr_t condAttr;
+
+	pthread_mutex_init(&packetMutex, NULL);
+	pthread_condattr_init(&condAttr);
+	pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC);
+	pthread_cond_init(&packetCond, &condAttr);
+	pthread_condattr_destroy(&condAttr);
+	bPacketReady = false;
+
+	pDSWaitTask = new Task(DSWAIT_TASKNAME, (FUNCPTR) &RhsRobotBase::DSWaitTask,
+			DSWAIT_PRIORITY, DSWAIT_STACKSIZE);
+	wpi_assert(pDSWaitTask);
 }
 
 RhsRobotBase::~RhsRobotBase()			//Destructor
 {	
+	delete pDSWaitTask;
+	pthread_cond_destroy(&packetCond);
+	pthread_mutex_destroy(&packetMutex);
+	Hal::SetInstance(NULL);
+	delete pHal;
 }
 
 RobotOpMode RhsRobotBase::GetCurrentRobotState()			//Returns the current robot state
@@ -66,20 +126,178 @@ int RhsRobotBase::GetLoop()			//Returns the loop number
 	return loop;
 }
 
+float RhsRobotBase::GetLoopPeriod()
+{
+	return fLoopPeriod;
+}
+
+float RhsRobotBase::GetLoopJitter()
+{
+	return fLoopJitter;
+}
+
+float RhsRobotBase::GetLoopPeriodMax()
+{
+	return fLoopPeriodMax;
+}
+
+float RhsRobotBase::GetInputLatency()
+{
+	return fInputLatency;
+}
+
+int RhsRobotBase::GetPacketTimeouts()
+{
+	return iPacketTimeouts;
+}
+
+double RhsRobotBase::Now()
+{
+	return(Hal::Now());
+}
+
+/**
+ * WaitForData() blocks on the driver station's new data condition but has no
+ * timeout, so it gets its own task.  The main loop waits on packetCond instead,
+ * which lets it wake up if the packets stop.
+ */
+void *RhsRobotBase::DSWaitTask(void *pThis)
+{
+	RhsRobotBase *pBase = (RhsRobotBase *)pThis;
+	DriverStation *pDS = DriverStation::GetInstance();
+
+	while(true)
+	{
+		pDS->WaitForData();
+		pBase->fPacketTime.store(Now(), std::memory_order_relaxed);
+
+		pthread_mutex_lock(&pBase->packetMutex);
+		pBase->bPacketReady = true;
+		pthread_cond_signal(&pBase->packetCond);
+		pthread_mutex_unlock(&pBase->packetMutex);
+	}
+
+	return(NULL);
+}
+
+bool RhsRobotBase::WaitForPacket(DriverStation *pDS)
+{
+	struct timespec deadline;
+	bool bReady;
+
+	//packetCond was made on the monotonic clock, the deadline has to be on it too
+
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	deadline.tv_nsec += (long)(DS_PACKET_TIMEOUT * 1.0e9);
+
+	while(deadline.tv_nsec >= 1000000000L)
+	{
+		deadline.tv_nsec -= 1000000000L;
+		deadline.tv_sec++;
+	}
+
+	pthread_mutex_lock(&packetMutex);
+
+	while(!bPacketReady)
+	{
+		if(pthread_cond_timedwait(&packetCond, &packetMutex, &deadline) == ETIMEDOUT)
+		{
+			break;
+		}
+	}
+
+	bReady = bPacketReady;
+	bPacketReady = false;
+	pthread_mutex_unlock(&packetMutex);
+
+	if(!bReady)
+	{
+		iPacketTimeouts++;
+		return false;
+	}
+
+	//the flag may have been set again by a packet we already read, only act on new data
+
+	return pDS->IsNewControlData();
+}
+
+/**
+ * Sums the time between packets and from each packet to the end of Run(), and
+ * every LOOP_STATS_PACKETS turns the sums into the values the getters return.
+ */
+void RhsRobotBase::UpdateLoopStats(double fWake, double fDone)
+{
+	double fLatency = fDone - fPacketTime.load(std::memory_order_relaxed);
+
+	FlightRecorder::RecordAt(flightLatency, fDone, fLatency);
+
+	if(fLastWake > 0.0)
+	{
+		double fPeriod = fWake - fLastWake;
+
+		fPeriodSum += fPeriod;
+		fPeriodSquaredSum += fPeriod * fPeriod;
+		fPeriodMax = (fPeriod > fPeriodMax) ? fPeriod : fPeriodMax;
+		fLatencySum += fLatency;
+		fLatencyMax = (fLatency > fLatencyMax) ? fLatency : fLatencyMax;
+		iPeriods++;
+	}
+
+	fLastWake = fWake;
+
+	if(iPeriods >= LOOP_STATS_PACKETS)
+	{
+		double fMean = fPeriodSum / iPeriods;
+		double fVariance = fPeriodSquaredSum / iPeriods - fMean * fMean;
+
+		fLoopPeriod = fMean;
+		fLoopJitter = (fVariance > 0.0) ? sqrt(fVariance) : 0.0;
+		fLoopPeriodMax = fPeriodMax;
+		fInputLatency = fLatencySum / iPeriods;
+
+		Telemetry::Put(keyLoopPeriod, TRUNC_HUND(fLoopPeriod * 1000.0));
+		Telemetry::Put(keyLoopJitter, TRUNC_HUND(fLoopJitter * 1000.0));
+		Telemetry::Put(keyLoopPeriodMax, TRUNC_HUND(fLoopPeriodMax * 1000.0));
+		Telemetry::Put(keyInputLatency, TRUNC_HUND(fInputLatency * 1000.0));
+		Telemetry::Put(keyInputLatencyMax, TRUNC_HUND(fLatencyMax * 1000.0));
+		Telemetry::Put(keyPacketTimeouts, iPacketTimeouts);
+
+		fPeriodSum = 0.0;
+		fPeriodSquaredSum = 0.0;
+		fPeriodMax = 0.0;
+		fLatencySum = 0.0;
+		fLatencyMax = 0.0;
+		iPeriods = 0;
+	}
+}
+
 void RhsRobotBase::StartCompetition()			//Robot's main function
 {
 	DriverStation *pDS = DriverStation::GetInstance();
 
+	double fWake;
+
 	Init();		//Initialize the robot
 
+	iHeartbeat = HeartbeatMonitor::GetInstance()->Register("main loop", MAIN_LOOP_HEARTBEAT_PERIOD, NULL);
+	HeartbeatMonitor::GetInstance()->Start();
+	Telemetry::Start();
+	CanBusMonitor::Start();
+	pDSWaitTask->Start((intptr_t) this);
+
 	while(true)
 	{
-		if(!pDS->IsNewControlData())
+		bool bPacket = WaitForPacket(pDS);
+
+		HeartbeatMonitor::GetInstance()->Beat(iHeartbeat, robotMessage.command);
+
+		if(!bPacket)
 		{
-			Wait(0.002);
 			continue;
 		}
 
+		fWake = Now();
+
 		//Checks the current state of the robot
 		if(IsDisabled())
 		{
@@ -107,32 +325,35 @@ void RhsRobotBase::StartCompetition()			//Robot's main function
 			switch(GetCurrentRobotState())
 			{
 			case ROBOT_STATE_DISABLED:
-				printf("ROBOT_STATE_DISABLED\n");
+				RobotLog::Printf(LOG_INFO, "ROBOT_STATE_DISABLED\n");
 				robotMessage.command = COMMAND_ROBOT_STATE_DISABLED;
+				FlightRecorder::Flush();
 				//robotMessage.robotMode = ROBOT_STATE_DISABLED;
 				break;
 			case ROBOT_STATE_AUTONOMOUS:
-				printf("ROBOT_STATE_AUTONOMOUS\n");
+				RobotLog::Printf(LOG_INFO, "ROBOT_STATE_AUTONOMOUS\n");
 				robotMessage.command = COMMAND_ROBOT_STATE_AUTONOMOUS;
 				//robotMessage.robotMode = ROBOT_STATE_AUTONOMOUS;
 				break;
 			case ROBOT_STATE_TELEOPERATED:
-				printf("ROBOT_STATE_TELEOPERATED\n");
+				RobotLog::Printf(LOG_INFO, "ROBOT_STATE_TELEOPERATED\n");
 				robotMessage.command = COMMAND_ROBOT_STATE_TELEOPERATED;
 				//robotMessage.robotMode = ROBOT_STATE_TELEOPERATED;
 				break;
 			case ROBOT_STATE_TEST:
-				printf("ROBOT_STATE_TEST\n");
+				RobotLog::Printf(LOG_INFO, "ROBOT_STATE_TEST\n");
 				robotMessage.command = COMMAND_ROBOT_STATE_TEST;
 				//robotMessage.robotMode = ROBOT_STATE_TEST;
 				break;
 			case ROBOT_STATE_UNKNOWN:
-				printf("ROBOT_STATE_UNKNOWN\n");
+				RobotLog::Printf(LOG_INFO, "ROBOT_STATE_UNKNOWN\n");
 				robotMessage.command = COMMAND_ROBOT_STATE_UNKNOWN;
 				//robotMessage.robotMode = ROBOT_STATE_UNKNOWN;
 				break;
 			}
 
+			FlightRecorder::Record(flightState, robotMessage.command);
+			CanBusMonitor::SetPhase(robotMessage.command);
 			OnStateChange();			//Handles the state change
 		}
 
@@ -148,6 +369,8 @@ void RhsRobotBase::StartCompetition()			//Robot's main function
 
 		previousRobotState = currentRobotState;
 
+		UpdateLoopStats(fWake, Now());
+
 		++loop;		//Increment the loop counter
 	}
 }
@@ -8,10 +8,16 @@
 #define RHS_ROBOT_BASE_H
 
 #include <unistd.h>
+#include <pthread.h>
+
+#include <atomic>
 
 //Robot
 #include <WPILib.h>			//For the RobotBase class
 #include "RobotMessage.h"
+#include "FlightRecorder.h"
+#include "Telemetry.h"
+#include "Hal.h"
 
 typedef enum eRobotOpMode
 {
@@ -34,8 +40,17 @@ public:
 
 	int GetLoop();			//Returns the loop number
 
+	float GetLoopPeriod();			//Returns the mean time between packets over the last window, seconds
+	float GetLoopJitter();			//Returns the standard deviation of that time, seconds
+	float GetLoopPeriodMax();			//Returns the longest time between packets in the last window, seconds
+	float GetInputLatency();			//Returns the mean time from a packet arriving to Run() finishing, seconds
+	int GetPacketTimeouts();			//Returns how many times DS_PACKET_TIMEOUT passed with no packet
+
+	static void *DSWaitTask(void *pThis);			//Waits for driver station packets and wakes the main loop
+
 protected:
 	RobotMessage robotMessage;			//Message to be written and sent to components
+	Hal *pHal;			//Where the components get their devices
 
 	virtual void Init() = 0;			//Abstract function: initializes the robot
 	virtual void OnStateChange() = 0;			//Abstract function: handles state changes
@@ -46,8 +61,42 @@ private:
 	RobotOpMode previousRobotState;			//Previous robot state
 
 	int loop;			//Loop counter
+	int iHeartbeat;			//Main loop's slot in the HeartbeatMonitor
+	FlightChannel flightState;			//state change commands
+	FlightChannel flightLatency;			//each packet's input latency
+
+	Task *pDSWaitTask;			//Sets bPacketReady and signals packetCond for each driver station packet
+	pthread_mutex_t packetMutex;
+	pthread_cond_t packetCond;			//on CLOCK_MONOTONIC, so setting the date can't stretch or cut a timeout
+	bool bPacketReady;			//under packetMutex
+	std::atomic<double> fPacketTime;			//When the latest packet arrived
+
+	//Loop timing, summed over a window of LOOP_STATS_PACKETS
+	double fLastWake;
+	double fPeriodSum;
+	double fPeriodSquaredSum;
+	double fPeriodMax;
+	double fLatencySum;
+	double fLatencyMax;
+	int iPeriods;
+	int iPacketTimeouts;
+
+	//Loop timing of the last complete window
+	float fLoopPeriod;
+	float fLoopJitter;
+	float fLoopPeriodMax;
+	float fInputLatency;
+	TelemetryKey keyLoopPeriod;			//the window's values on the dashboard, in ms
+	TelemetryKey keyLoopJitter;
+	TelemetryKey keyLoopPeriodMax;
+	TelemetryKey keyInputLatency;
+	TelemetryKey keyInputLatencyMax;
+	TelemetryKey keyPacketTimeouts;
 
 	void StartCompetition();			//Robot's main function
+	bool WaitForPacket(DriverStation *pDS);			//Blocks until a new packet or DS_PACKET_TIMEOUT
+	void UpdateLoopStats(double fWake, double fDone);
+	static double Now();
 };
 
 #endif //RHS_ROBOT_BASE_H
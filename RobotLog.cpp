@@ -0,0 +1,273 @@
+/** \file
+ * Implementation of the robot log.
+ *
+ * A thread claims a queue the first time it logs and keeps it in a thread local
+ * pointer.  Queues are never given back; the robot's threads live as long as the
+ * program does.  The queues are static, so a new one starts out empty.
+ */
+
+#include "RobotLog.h"
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <algorithm>
+
+#include "RobotParams.h"
+#include "Telemetry.h"
+#include "Hal.h"
+
+static_assert((ROBOTLOG_QUEUE_RECORDS & (ROBOTLOG_QUEUE_RECORDS - 1)) == 0,
+		"ROBOTLOG_QUEUE_RECORDS must be a power of 2");
+
+static const char szSeverityLetters[] = "DIWE";
+
+///One message, formatted by the caller
+struct LogRecord {
+	double fTime;
+	LogSeverity severity;
+	char szText[ROBOTLOG_TEXT_LENGTH];
+};
+
+///The messages one thread has waiting, it writes the head and the log task the tail
+struct LogQueue {
+	std::atomic<unsigned> uHead;
+	std::atomic<unsigned> uTail;
+	char szThread[16]; //pthread names are at most 15 characters
+	LogRecord records[ROBOTLOG_QUEUE_RECORDS];
+};
+
+static LogQueue queues[ROBOTLOG_MAX_THREADS];
+static std::atomic<int> iQueues(0);
+static thread_local LogQueue *pThreadQueue = NULL;
+static std::atomic<int> iLevel(LOG_INFO);
+static std::atomic<unsigned> uDropped(0);
+static std::atomic<unsigned> uMaxCallTime(0); //nanoseconds
+static std::atomic<FILE *> pLogFile(NULL);
+static double fStartTime = 0.0;
+static Task *pTask = NULL;
+
+static double Now()
+{
+	return(Hal::Now());
+}
+
+///Returns this thread's queue, claiming one the first time, NULL if they are all taken
+static LogQueue *GetThreadQueue()
+{
+	if(pThreadQueue == NULL)
+	{
+		int iQueue = iQueues.fetch_add(1, std::memory_order_relaxed);
+
+		if(iQueue >= ROBOTLOG_MAX_THREADS)
+		{
+			return(NULL);
+		}
+
+		LogQueue &queue = queues[iQueue];
+
+		if(pthread_getname_np(pthread_self(), queue.szThread, sizeof(queue.szThread)) != 0)
+		{
+			snprintf(queue.szThread, sizeof(queue.szThread), "t%d", iQueue);
+		}
+
+		pThreadQueue = &queue;
+	}
+
+	return(pThreadQueue);
+}
+
+void RobotLog::Printf(LogSeverity severity, const char *szFormat, ...)
+{
+	double fStart;
+	LogQueue *pQueue;
+	unsigned uHead;
+	unsigned uCallTime;
+	unsigned uMax;
+	va_list args;
+
+	if(severity < iLevel.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+
+	fStart = Now();
+	pQueue = GetThreadQueue();
+
+	if(pQueue == NULL)
+	{
+		uDropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	uHead = pQueue->uHead.load(std::memory_order_relaxed);
+
+	if(uHead - pQueue->uTail.load(std::memory_order_acquire) >= (unsigned)ROBOTLOG_QUEUE_RECORDS)
+	{
+		uDropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	LogRecord &record = pQueue->records[uHead & (ROBOTLOG_QUEUE_RECORDS - 1)];
+
+	record.fTime = fStart;
+	record.severity = severity;
+	va_start(args, szFormat);
+	vsnprintf(record.szText, sizeof(record.szText), szFormat, args);
+	va_end(args);
+
+	pQueue->uHead.store(uHead + 1, std::memory_order_release);
+
+	// keep the slowest call, the loser of a race just tries again
+
+	uCallTime = (unsigned)((Now() - fStart) * 1.0e9);
+	uMax = uMaxCallTime.load(std::memory_order_relaxed);
+
+	while((uCallTime > uMax)
+			&& !uMaxCallTime.compare_exchange_weak(uMax, uCallTime, std::memory_order_relaxed))
+	{
+	}
+}
+
+void RobotLog::Start()
+{
+	if(pTask == NULL)
+	{
+		fStartTime = Now();
+		pTask = new Task(ROBOTLOG_TASKNAME, (FUNCPTR) &RobotLog::StartTask,
+				ROBOTLOG_PRIORITY, ROBOTLOG_STACKSIZE);
+		wpi_assert(pTask);
+		pTask->Start();
+	}
+}
+
+void RobotLog::SetLevel(LogSeverity severity)
+{
+	iLevel.store(severity, std::memory_order_relaxed);
+}
+
+///The old file is left open, the log task may be partway through a write to it
+bool RobotLog::SetFile(const char *szPath)
+{
+	FILE *pFile = NULL;
+
+	if(szPath != NULL)
+	{
+		pFile = fopen(szPath, "a");
+
+		if(pFile == NULL)
+		{
+			return(false);
+		}
+	}
+
+	pLogFile.store(pFile, std::memory_order_release);
+	return(true);
+}
+
+unsigned RobotLog::GetDroppedCount()
+{
+	return(uDropped.load(std::memory_order_relaxed));
+}
+
+float RobotLog::GetMaxCallTime()
+{
+	return(uMaxCallTime.load(std::memory_order_relaxed) * 1.0e-9);
+}
+
+void RobotLog::ResetMaxCallTime()
+{
+	uMaxCallTime.store(0, std::memory_order_relaxed);
+}
+
+void *RobotLog::StartTask(void *pThis)
+{
+	TelemetryKey keyMaxCallTime = Telemetry::Register("Log Call Max us", TELEMETRY_NUMBER);
+	TelemetryKey keyDropped = Telemetry::Register("Log Dropped", TELEMETRY_NUMBER);
+	HalClock *pClock = Hal::GetInstance()->GetClock();
+	double fDeadline = pClock->Now();
+
+	while(true)
+	{
+		Drain();
+
+		Telemetry::Put(keyMaxCallTime, GetMaxCallTime() * 1.0e6);
+		Telemetry::Put(keyDropped, GetDroppedCount());
+
+		fDeadline += ROBOTLOG_DRAIN_PERIOD;
+		pClock->WaitUntil(fDeadline);
+	}
+
+	return(NULL);
+}
+
+///Writes everything the threads have queued, oldest first
+void RobotLog::Drain()
+{
+	static const LogRecord *pending[ROBOTLOG_MAX_THREADS * ROBOTLOG_QUEUE_RECORDS];
+	static const char *szThreads[ROBOTLOG_MAX_THREADS * ROBOTLOG_QUEUE_RECORDS];
+	unsigned uHeads[ROBOTLOG_MAX_THREADS];
+	int iCount = std::min(iQueues.load(std::memory_order_acquire), ROBOTLOG_MAX_THREADS);
+	int iPending = 0;
+	FILE *pFile = pLogFile.load(std::memory_order_acquire);
+
+	for(int i = 0; i < iCount; i++)
+	{
+		LogQueue &queue = queues[i];
+
+		uHeads[i] = queue.uHead.load(std::memory_order_acquire);
+
+		for(unsigned uTail = queue.uTail.load(std::memory_order_relaxed); uTail != uHeads[i]; uTail++)
+		{
+			szThreads[iPending] = queue.szThread;
+			pending[iPending++] = &queue.records[uTail & (ROBOTLOG_QUEUE_RECORDS - 1)];
+		}
+	}
+
+	if(iPending == 0)
+	{
+		return;
+	}
+
+	static int order[ROBOTLOG_MAX_THREADS * ROBOTLOG_QUEUE_RECORDS];
+
+	for(int i = 0; i < iPending; i++)
+	{
+		order[i] = i;
+	}
+
+	std::stable_sort(order, order + iPending,
+			[](int a, int b) { return(pending[a]->fTime < pending[b]->fTime); });
+
+	for(int i = 0; i < iPending; i++)
+	{
+		const LogRecord &record = *pending[order[i]];
+		size_t uLength = strlen(record.szText);
+		const char *szEnd = ((uLength > 0) && (record.szText[uLength - 1] == '\n')) ? "" : "\n";
+
+		printf("%0.3lf %c %-10s %s%s", record.fTime - fStartTime, szSeverityLetters[record.severity],
+				szThreads[order[i]], record.szText, szEnd);
+
+		if(pFile != NULL)
+		{
+			fprintf(pFile, "%0.3lf %c %-10s %s%s", record.fTime - fStartTime,
+					szSeverityLetters[record.severity], szThreads[order[i]], record.szText, szEnd);
+		}
+	}
+
+	fflush(stdout);
+
+	if(pFile != NULL)
+	{
+		fflush(pFile);
+	}
+
+	// only now can the threads have the slots back
+
+	for(int i = 0; i < iCount; i++)
+	{
+		queues[i].uTail.store(uHeads[i], std::memory_order_release);
+	}
+}
@@ -0,0 +1,58 @@
+/** \file
+ * Definitions of the robot log, which keeps console output off the control paths.
+ *
+ * RobotLog::Printf() formats the message into a record and pushes it onto a queue
+ * that belongs to the calling thread, then returns; it never takes a lock or
+ * touches the console.  Each queue has one writer (its thread) and one reader
+ * (the log task), so a pair of atomic indexes is all the synchronization needed.
+ * The log task wakes every ROBOTLOG_DRAIN_PERIOD, collects what every thread has
+ * queued, puts it back in time order and writes it to the console and, if one
+ * was set, a file.
+ *
+ * A full queue drops the message rather than wait; GetDroppedCount() says how
+ * many.  Messages below the level set with SetLevel() are dropped before they
+ * are formatted.  The slowest Printf() since boot is kept so the cost in the
+ * caller is measured on the robot, not guessed.
+ */
+
+#ifndef ROBOT_LOG_H
+#define ROBOT_LOG_H
+
+#include "WPILib.h"
+
+#include <atomic>
+
+const int ROBOTLOG_MAX_THREADS = 24; //threads that can log, each gets a queue the first time it does
+const int ROBOTLOG_QUEUE_RECORDS = 64; //messages a thread can have waiting, must be a power of 2
+const int ROBOTLOG_TEXT_LENGTH = 112;
+const float ROBOTLOG_DRAIN_PERIOD = 0.02; //seconds between passes of the log task
+
+///How important a message is, the log drops those below its level
+typedef enum eLogSeverity
+{
+	LOG_DEBUG,						//!< chatter, off unless asked for
+	LOG_INFO,						//!< what the robot is doing
+	LOG_WARNING,					//!< something unexpected the robot carries on from
+	LOG_ERROR						//!< something failed
+} LogSeverity;
+
+class RobotLog
+{
+public:
+	static void Printf(LogSeverity severity, const char *szFormat, ...)
+		__attribute__((format(printf, 2, 3)));
+
+	static void Start(); //call early, messages queue until it is
+	static void SetLevel(LogSeverity severity);
+	static bool SetFile(const char *szPath); //also write to this file, NULL to stop
+	static unsigned GetDroppedCount(); //messages lost to full queues since boot
+	static float GetMaxCallTime(); //seconds, the slowest Printf() since boot or the last reset
+	static void ResetMaxCallTime();
+
+	static void *StartTask(void *pThis);
+
+private:
+	static void Drain();
+};
+
+#endif //ROBOT_LOG_H
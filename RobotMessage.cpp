@@ -0,0 +1,116 @@
+/** \file
+ * Names of the message commands, for reading them from files and writing them to logs.
+ */
+
+#include "RobotMessage.h"
+
+#include <string.h>
+
+//must be in the same order as MessageCommand
+static const char* const szMessageCommandNames[] = {
+	"COMMAND_UNKNOWN",
+	"COMMAND_SYSTEM_MSGTIMEOUT",
+	"COMMAND_SYSTEM_OK",
+	"COMMAND_SYSTEM_ERROR",
+	"COMMAND_ROBOT_STATE_DISABLED",
+	"COMMAND_ROBOT_STATE_AUTONOMOUS",
+	"COMMAND_ROBOT_STATE_TELEOPERATED",
+	"COMMAND_ROBOT_STATE_TEST",
+	"COMMAND_ROBOT_STATE_UNKNOWN",
+	"COMMAND_AUTONOMOUS_RUN",
+	"COMMAND_AUTONOMOUS_COMPLETE",
+	"COMMAND_AUTONOMOUS_RESPONSE_OK",
+	"COMMAND_AUTONOMOUS_RESPONSE_ERROR",
+	"COMMAND_CHECKLIST_RUN",
+	"COMMAND_SENSORFUSION_IMPACT",
+	"COMMAND_DRIVETRAIN_STOP",
+	"COMMAND_DRIVETRAIN_DRIVE_TANK",
+	"COMMAND_DRIVETRAIN_DRIVE_ARCADE",
+	"COMMAND_DRIVETRAIN_DRIVE_CURVATURE",
+	"COMMAND_DRIVETRAIN_AUTO_MOVE",
+	"COMMAND_DRIVETRAIN_DRIVE_STRAIGHT",
+	"COMMAND_DRIVETRAIN_TURN",
+	"COMMAND_DRIVETRAIN_SEEK_TOTE",
+	"COMMAND_DRIVETRAIN_START_DRIVE_FWD",
+	"COMMAND_DRIVETRAIN_START_DRIVE_BCK",
+	"COMMAND_DRIVETRAIN_START_KEEPALIGN",
+	"COMMAND_DRIVETRAIN_STOP_KEEPALIGN",
+	"COMMAND_DRIVETRAIN_TOGGLE_HEADINGHOLD",
+	"COMMAND_CONVEYOR_RUN_FWD",
+	"COMMAND_CONVEYOR_RUN_BCK",
+	"COMMAND_CONVEYOR_SET_BACK",
+	"COMMAND_CONVEYOR_STOP",
+	"COMMAND_CONVEYOR_SEEK_TOTE_FRONT",
+	"COMMAND_CONVEYOR_SEEK_TOTE_BACK",
+	"COMMAND_CONVEYOR_FRONTLOAD_TOTE",
+	"COMMAND_CONVEYOR_BACKLOAD_TOTE",
+	"COMMAND_CONVEYOR_SHIFTTOTES_FWD",
+	"COMMAND_CONVEYOR_SHIFTTOTES_BCK",
+	"COMMAND_CONVEYOR_PUSHTOTES_BCK",
+	"COMMAND_CONVEYOR_DEPOSITTOTES_BCK",
+	"COMMAND_CONVEYOR_WAIT_FRONT_BEAM",
+	"COMMAND_CONVEYOR_WAIT_BACK_BEAM",
+	"COMMAND_CANLIFTER_RAISE",
+	"COMMAND_CANLIFTER_LOWER",
+	"COMMAND_CANLIFTER_HOVER",
+	"COMMAND_CANLIFTER_TOGGLE_HOVER",
+	"COMMAND_CANLIFTER_RAISE_TOTES",
+	"COMMAND_CANLIFTER_LOWER_TOTES",
+	"COMMAND_CANLIFTER_START_RAISE_TOTES",
+	"COMMAND_CANLIFTER_CLAW_TO_TOP",
+	"COMMAND_CANLIFTER_CLAW_TO_BOTTOM",
+	"COMMAND_CANLIFTER_RAISE_LOMID",
+	"COMMAND_CANLIFTER_LOWER_HIMID",
+	"COMMAND_CANLIFTER_STOP",
+	"COMMAND_CLAW_OPEN",
+	"COMMAND_CLAW_CLOSE",
+	"COMMAND_CLAW_STOP",
+	"COMMAND_CANARM_OPEN",
+	"COMMAND_CANARM_CLOSE",
+	"COMMAND_CANARM_STOP",
+	"COMMAND_CUBECLICKER_RAISE",
+	"COMMAND_CUBECLICKER_LOWER",
+	"COMMAND_CUBECLICKER_STOP",
+	"COMMAND_CUBEINTAKE_RUN",
+	"COMMAND_CUBEINTAKE_STOP",
+	"COMMAND_CUBEAUTOCYCLE_START",
+	"COMMAND_CUBEAUTOCYCLE_STOP",
+	"COMMAND_CUBEAUTOCYCLE_PAUSE",
+	"COMMAND_CUBEAUTOCYCLE_RESUME",
+	"COMMAND_CUBEAUTOCYCLE_HOLD",
+	"COMMAND_CUBEAUTOCYCLE_RELEASE",
+	"COMMAND_CUBE_STOP",
+	"COMMAND_NOODLEFAN_START",
+	"COMMAND_NOODLEFAN_STOP",
+	"COMMAND_NOODLEFAN_TOGGLE",
+	"COMMAND_COMPONENT_TEST",
+	"COMMAND_LAST"
+};
+
+static_assert(sizeof(szMessageCommandNames) / sizeof(szMessageCommandNames[0]) == COMMAND_LAST + 1,
+		"szMessageCommandNames is out of step with MessageCommand");
+
+///Returns the enum name of a command, "COMMAND_UNKNOWN" if it is out of range.
+const char *GetMessageCommandName(MessageCommand command)
+{
+	if((command < COMMAND_UNKNOWN) || (command > COMMAND_LAST))
+	{
+		return(szMessageCommandNames[COMMAND_UNKNOWN]);
+	}
+
+	return(szMessageCommandNames[command]);
+}
+
+///Returns the command with the given enum name, COMMAND_UNKNOWN if there isn't one.
+MessageCommand GetMessageCommand(const char *szName)
+{
+	for(int i = COMMAND_UNKNOWN; i < COMMAND_LAST; i++)
+	{
+		if(strcmp(szName, szMessageCommandNames[i]) == 0)
+		{
+			return((MessageCommand)i);
+		}
+	}
+
+	return(COMMAND_UNKNOWN);
+}
@@ -37,9 +37,13 @@
  robot=>drive [label="STOP"];
  robot=>drive [label="DRIVE_TANK"];
  robot=>drive [label="DRIVE_ARCADE"];
+ robot=>drive [label="DRIVE_CURVATURE"];
+ robot=>drive [label="TOGGLE_HEADINGHOLD"];
  auto=>drive [label="DRIVE_STRAIGHT"];
  auto=>drive [label="TURN"];
  auto=>drive [label="SEEK_TOTE"];
+ drive=>drive [label="SENSORFUSION_IMPACT"];
+ drive=>auto [label="SENSORFUSION_IMPACT"];
  drive=>auto [label="AUTONOMOUS_RESPONSE_OK"]
  drive=>auto [label="AUTONOMOUS_RESPONSE_ERROR"]
  robot=>conveyor [label="RUN_FWD"];
@@ -87,18 +91,21 @@ enum MessageCommand {
 	COMMAND_AUTONOMOUS_RESPONSE_OK,		//!< Tells Autonomous that a command finished running successfully
 	COMMAND_AUTONOMOUS_RESPONSE_ERROR,	//!< Tells Autonomous that a command had a error while running
 	COMMAND_CHECKLIST_RUN,				//!< Tells CheckList to run
+	COMMAND_SENSORFUSION_IMPACT,		//!< Tells subscribers that the robot ran into something
 
 	COMMAND_DRIVETRAIN_STOP,			//!< Tells Drivetrain to stop moving
 	COMMAND_DRIVETRAIN_DRIVE_TANK,		//!< Tells Drivetrain to use tank drive
 	COMMAND_DRIVETRAIN_DRIVE_ARCADE,	//!< Tells Drivetrain to use arcade drive
+	COMMAND_DRIVETRAIN_DRIVE_CURVATURE,	//!< Tells Drivetrain to use curvature (cheesy) drive
 	COMMAND_DRIVETRAIN_AUTO_MOVE,		//!< Tells Drivetrain to move motors, used by Autonomous
 	COMMAND_DRIVETRAIN_DRIVE_STRAIGHT,	//!< Tells Drivetrain to drive straight, used by Autonomous
 	COMMAND_DRIVETRAIN_TURN,			//!< Tells Drivetrain to turn, used by Autonomous
 	COMMAND_DRIVETRAIN_SEEK_TOTE,		//!< Tells Drivetrain to seek the next tote, used by Autonomous
-	COMMAND_DRIVETRAIN_START_DRIVE_FWD,	//!< Tells Drivetrain to front load the next tote, used by Autonomous
-	COMMAND_DRIVETRAIN_START_DRIVE_BCK,	//!< Tells Drivetrain to back load the next tote, used by Autonomous
+	COMMAND_DRIVETRAIN_START_DRIVE_FWD,	//!< Tells Drivetrain to front load the next tote, the next straight drive stops on an impact, used by Autonomous
+	COMMAND_DRIVETRAIN_START_DRIVE_BCK,	//!< Tells Drivetrain to back load the next tote, the next straight drive stops on an impact, used by Autonomous
 	COMMAND_DRIVETRAIN_START_KEEPALIGN,	//!< Tells Drivetrain to start keeping itself at constant alignment, used by Autonomous
 	COMMAND_DRIVETRAIN_STOP_KEEPALIGN,	//!< Tells Drivetrain to stop keeping itself at constant alignment, used by Autonomous
+	COMMAND_DRIVETRAIN_TOGGLE_HEADINGHOLD,	//!< Tells Drivetrain to toggle holding its heading while the driver is not turning
 
 	COMMAND_CONVEYOR_RUN_FWD,			//!< Tells Conveyor to run the rollers forward
 	COMMAND_CONVEYOR_RUN_BCK,			//!< Tells Conveyor to run the rollers backwards - fancy operations
@@ -170,6 +177,13 @@ struct ArcadeDriveParams {
 	float y;
 };
 
+///Used to deliver joystick readings to Drivetrain
+struct CurvatureDriveParams {
+	float throttle;
+	float wheel;
+	bool bQuickTurn;
+};
+
 ///Used to deliver joystick readings to Conveyor
 struct ConveyorParams {
 	bool bButtonWentDownEvent;
@@ -199,13 +213,22 @@ struct AutonomousParams {
 	float driveTime;
 };
 
+///Used to deliver impacts from SensorFusion
+struct ImpactParams {
+	float magnitude;	//g
+	float forward;		//g of the jolt toward the front, - when the front ran into something
+	float sideways;		//g of the jolt toward the left, - when the left ran into something
+};
+
 ///Contains all the parameter structures contained in a message
 union MessageParams {
 	TankDriveParams tankDrive;
 	ArcadeDriveParams arcadeDrive;
+	CurvatureDriveParams curvatureDrive;
 	ConveyorParams conveyorParams;
 	CanLifterParams canLifterParams;
 	AutonomousParams autonomous;
+	ImpactParams impact;
 };
 
 ///A structure containing a command, a set of parameters, and a reply id, sent between components
@@ -215,4 +238,7 @@ struct RobotMessage {
 	MessageParams params;
 };
 
+const char *GetMessageCommandName(MessageCommand command);
+MessageCommand GetMessageCommand(const char *szName);
+
 #endif //ROBOT_MESSAGE_H
@@ -10,24 +10,31 @@
 
 //Robot
 #include "JoystickLayouts.h"			//For joystick layouts
+#include "AxisShaper.h"				//For axis response curves
+#include "Hal.h"					//For the mode macros
 
 //Robot Params
 const char* const ROBOT_NAME =		"RhsRobot2015 Oklahoma";	//Formal name
 const char* const ROBOT_NICKNAME =   "The Blues Brothers";		//Nickname
 const char* const ROBOT_VERSION =	"2.0";						//Version
 
-//Robot Mode Macros - used to tell what mode the robot is in
-#define ISAUTO			RobotBase::getInstance().IsAutonomous()
-#define ISTELEOPERATED	RobotBase::getInstance().IsOperatorControl()
-#define ISTEST			RobotBase::getInstance().IsTest()
-#define ISENABLED		RobotBase::getInstance().IsEnabled()
-#define ISDISABLED		RobotBase::getInstance().IsDisabled()
+//Main Loop Params
+const float DS_PACKET_TIMEOUT = 0.05;		//seconds without a driver station packet before the main loop wakes anyway
+const float MAIN_LOOP_HEARTBEAT_PERIOD = 0.07;	//the main loop beats at least every DS_PACKET_TIMEOUT
+const int LOOP_STATS_PACKETS = 250;		//packets in each window of loop timing statistics, about 5s
+
+//Robot Mode Macros - used to tell what mode the robot is in, the HAL's driver station knows
+#define ISAUTO			Hal::GetInstance()->GetDriverStation()->IsAutonomous()
+#define ISTELEOPERATED	Hal::GetInstance()->GetDriverStation()->IsOperatorControl()
+#define ISTEST			Hal::GetInstance()->GetDriverStation()->IsTest()
+#define ISENABLED		Hal::GetInstance()->GetDriverStation()->IsEnabled()
+#define ISDISABLED		(!Hal::GetInstance()->GetDriverStation()->IsEnabled())
 
 //Utility Functions - Define commonly used operations here
 #define ABLIMIT(a,b)		if(a > b) a = b; else if(a < -b) a = -b;
 #define TRUNC_THOU(a)		((int)(1000 * a)) * .001
 #define TRUNC_HUND(a)		((int)(100 * a)) * .01
-#define PRINTAUTOERROR		printf("Early Death! %s %i \n", __FILE__, __LINE__);
+#define PRINTAUTOERROR		RobotLog::Printf(LOG_ERROR, "Early Death! %s %i", __FILE__, __LINE__);
 
 //Task Params - Defines component task priorites relative to the default priority.
 //EXAMPLE: const int DRIVETRAIN_PRIORITY = DEFAULT_PRIORITY -2;
@@ -43,6 +50,12 @@ const int CANLIFTER_PRIORITY 	= DEFAULT_PRIORITY;
 const int CLAW_PRIORITY 		= DEFAULT_PRIORITY;
 const int CANARM_PRIORITY		= DEFAULT_PRIORITY;
 const int NOODLEFAN_PRIORITY	= DEFAULT_PRIORITY;
+const int SENSORFUSION_PRIORITY	= DEFAULT_PRIORITY;
+const int DSWAIT_PRIORITY		= DEFAULT_PRIORITY;
+const int HEARTBEAT_PRIORITY	= DEFAULT_PRIORITY;
+const int TELEMETRY_PRIORITY	= DEFAULT_PRIORITY;
+const int ROBOTLOG_PRIORITY		= DEFAULT_PRIORITY + 20;
+const int CANBUS_PRIORITY		= DEFAULT_PRIORITY;
 
 //Task Names - Used when you view the task list but used by the operating system
 //EXAMPLE: const char* DRIVETRAIN_TASKNAME = "tDrive";
@@ -57,6 +70,12 @@ const char* const CANLIFTER_TASKNAME	= "tCanLift";
 const char* const CLAW_TASKNAME			= "tClaw";
 const char* const CANARM_TASKNAME		= "tCanArm";
 const char* const NOODLEFAN_TASKNAME	= "tNoodleFan";
+const char* const SENSORFUSION_TASKNAME	= "tFusion";
+const char* const DSWAIT_TASKNAME		= "tDSWait";
+const char* const HEARTBEAT_TASKNAME	= "tHeartbeat";
+const char* const TELEMETRY_TASKNAME	= "tTelemetry";
+const char* const ROBOTLOG_TASKNAME		= "tLog";
+const char* const CANBUS_TASKNAME		= "tCanBus";
 
 const int COMPONENT_STACKSIZE	= 0x10000;
 const int DRIVETRAIN_STACKSIZE	= 0x10000;
@@ -69,6 +88,12 @@ const int CANLIFTER_STACKSIZE	= 0x10000;
 const int CLAW_STACKSIZE		= 0x10000;
 const int CANARM_STACKSIZE		= 0x10000;
 const int NOODLEFAN_STACKSIZE	= 0x10000;
+const int SENSORFUSION_STACKSIZE	= 0x10000;
+const int DSWAIT_STACKSIZE		= 0x10000;
+const int HEARTBEAT_STACKSIZE	= 0x10000;
+const int TELEMETRY_STACKSIZE	= 0x10000;
+const int ROBOTLOG_STACKSIZE		= 0x10000;
+const int CANBUS_STACKSIZE		= 0x10000;
 
 //TODO change these variables throughout the code to PIPE or whatever instead  of QUEUE
 //Queue Names - Used when you want to open the message queue for any task
@@ -126,6 +151,8 @@ const int CUBECLICKER_MAX_TOTES = 6;
 //EXAMPLE: const int DIO_DRIVETRAIN_BEAM_BREAK = 0;
 //const int DIO_CANLIFTER_LOWER_HALL_EFFECT = 0;
 //const int DIO_CANLIFTER_UPPER_HALL_EFFECT = 1;
+const int DIO_DRIVETRAIN_ENCODER_A = 0; //not fitted yet, the Drivetrain encoder is commented out
+const int DIO_DRIVETRAIN_ENCODER_B = 1;
 const int DIO_CANLIFTER_HOVER_HALL_EFFECT = 9; //due to cable length
 
 //Solenoid - Assigns names to Solenoid ports 1-8 on the 9403
@@ -135,17 +162,38 @@ const int DIO_CANLIFTER_HOVER_HALL_EFFECT = 9; //due to cable length
 //EXAMPLE: const int IO2C_AUTO_ACCEL = 1;
 const int IO2C_AUTO_ACCEL = 1;
 
+//SPI - Assigns names to the SPI ports on the Roborio, the values of SPI::Port
+const int SPI_GYRO = 0; //SPI::kOnboardCS0
+
 //Analog I/O - Assigns names to Analog I/O ports 1-8 on Anal;og Breakout Module
 //EXAMPLE: const int AIO_BATTERY = 8;
 
 //Joystick Input Device Counts - used by the listener to watch buttons and axis
+//buttons are numbered from 1 (at most 32), axes from 0
 const int JOYSTICK_BUTTON_COUNT = 10;
-const int JOYSTICK_AXIS_COUNT = 5;
+const int JOYSTICK_AXIS_COUNT = 6;
+const float JOYSTICK_AXIS_FILTER = 0.5;		//weight of each new axis reading, about 30ms of smoothing at 50 packets a second
+const float JOYSTICK_AXIS_TOLERANCE = 0.02;	//hysteresis band, an axis must move this far to change
+
+//Driver Output Limits - applied by the drive bindings, see InputBindings.cpp
+const float DRIVE_MAX_OUTPUT = 0.75;
+const float CURVATURE_QUICKTURN_THRESHOLD = 0.05;	//curvature drive spins in place below this throttle
+
+//Axis Response Curves - baked into AxisShaper lookup tables when the robot starts
+//EXAMPLE: const AxisCurveParams EXAMPLE_CURVE = { AXIS_CURVE_PIECEWISE, 0.05, 0.0, 2, {0.5, 0.9}, {0.2, 0.6} };
+const AxisCurveParams TANK_DRIVE_CURVE =	{ AXIS_CURVE_EXPO, 0.08, 0.6, 0, {}, {} };
+const AxisCurveParams ARCADE_DRIVE_CURVE =	{ AXIS_CURVE_EXPO, 0.08, 0.6, 0, {}, {} };
+//the lifter was tuned on the raw trigger past a 0.10 threshold, so it keeps that scale
+const AxisCurveParams CANLIFTER_CURVE =		{ AXIS_CURVE_LINEAR, 0.10, 0.0, 0, {}, {}, true };
+const AxisCurveParams CUBECLICKER_CURVE =	{ AXIS_CURVE_LINEAR, 0.65, 0.0, 0, {}, {} };
 
 //POV IDs - Assign names to the 9 POV positions: -1 to 7
 //EXAMPLE: const int POV_STILL = -1;
 const int POV_STILL = -1;
 
+//Controller Mappings - the IDs below make the default binding table in InputBindings.cpp,
+//a bindings file on the robot (INPUT_BINDINGS_FILEPATH) replaces them without a rebuild
+
 //Primary Controller Mapping - Assigns action to buttons or axes on the first joystick
 #undef	USE_X3D_FOR_CONTROLLER_1
 #undef	USE_XBOX_FOR_CONTROLLER_1
@@ -162,7 +210,7 @@ const int POV_STILL = -1;
  * \verbatim
  	 +++++ Controller 1 +++++
   	A Button					Toggle noodle fan
-  	B Button					~~
+  	B Button					Toggle drivetrain heading hold
   	X Button					Hold Cube clicker at bottom to remove totes
   	Y Button					Release Cube clicker from hold
   	Start Button				Start Cube autocycle
@@ -171,8 +219,8 @@ const int POV_STILL = -1;
   	Right Bumper				Run Conveyor backwards - to claw
   	Left Thumbstick Button		Close CanLifter claw
   	Right Thumbstick Button		Open CanLifter claw
-  	Left Thumbstick				Left tank, Arcade
-  	Right Thumbstick			Right tank
+  	Left Thumbstick				Left tank, Arcade, Curvature throttle
+  	Right Thumbstick			Right tank, Curvature wheel (X)
   	D-pad						~~
   	Left Trigger				Lower CanLifter
   	RightTrigger				Raise CanLifter
@@ -201,31 +249,21 @@ const int POV_STILL = -1;
 #define TANK_DRIVE_RIGHT_ID			L310_THUMBSTICK_RIGHT_Y
 #define ARCADE_DRIVE_X_ID			L310_THUMBSTICK_LEFT_X
 #define ARCADE_DRIVE_Y_ID			L310_THUMBSTICK_LEFT_Y
+#define CURVATURE_DRIVE_THROTTLE_ID	L310_THUMBSTICK_LEFT_Y
+#define CURVATURE_DRIVE_WHEEL_ID	L310_THUMBSTICK_RIGHT_X
 #define CONVEYOR_FWD_ID				L310_BUTTON_BUMPER_LEFT
 #define CONVEYOR_BCK_ID				L310_BUTTON_BUMPER_RIGHT
-#define CANLIFTER_RAISE_ID			L310_TRIGGER_LEFT
-#define CANLIFTER_LOWER_ID			L310_TRIGGER_RIGHT
+#define CANLIFTER_RAISE_ID			L310_TRIGGER_RIGHT
+#define CANLIFTER_LOWER_ID			L310_TRIGGER_LEFT
 //#define CANLIFTER_HOVER_ID		L310_BUTTON_A
 #define NOODLEFAN_TOGGLE_ID			L310_BUTTON_A
+#define HEADINGHOLD_TOGGLE_ID		L310_BUTTON_B
 #define CLAW_CLOSE_ID				L310_BUTTON_THUMB_RIGHT
 #define CLAW_OPEN_ID				L310_BUTTON_THUMB_LEFT
 #define CUBEAUTO_START_ID			L310_BUTTON_START	//Used on both controllers
 #define CUBEAUTO_STOP_ID			L310_BUTTON_STOP	//Used on both controllers
 #define CUBEAUTO_HOLD_ID			L310_BUTTON_X		//Used on both controllers
 #define CUBEAUTO_RELEASE_ID			L310_BUTTON_Y		//Used on both controllers
-
-//#define TANK_DRIVE_LEFT			pow(-Controller_1->GetRawAxis(L310_THUMBSTICK_LEFT_Y),3)
-//#define TANK_DRIVE_RIGHT			pow(-Controller_1->GetRawAxis(L310_THUMBSTICK_RIGHT_Y),3)
-#define TANK_DRIVE_LEFT				(-Controller_1->GetRawAxis(L310_THUMBSTICK_LEFT_Y))
-#define TANK_DRIVE_RIGHT			(-Controller_1->GetRawAxis(L310_THUMBSTICK_RIGHT_Y))
-#define ARCADE_DRIVE_X				Controller_1->GetRawAxis(L310_THUMBSTICK_LEFT_X)
-#define ARCADE_DRIVE_Y				-Controller_1->GetRawAxis(L310_THUMBSTICK_LEFT_Y)
-#define CONVEYOR_FWD				Controller_1->GetRawButton(L310_BUTTON_BUMPER_LEFT)
-#define CONVEYOR_BCK				Controller_1->GetRawButton(L310_BUTTON_BUMPER_RIGHT)
-#define CANLIFTER_RAISE				Controller_1->GetRawAxis(L310_TRIGGER_RIGHT)
-#define CANLIFTER_LOWER				Controller_1->GetRawAxis(L310_TRIGGER_LEFT)
-#define CLAW_CLOSE					Controller_1->GetRawButton(L310_BUTTON_THUMB_LEFT)
-#define CLAW_OPEN					Controller_1->GetRawButton(L310_BUTTON_THUMB_RIGHT)
 #endif // USE_L310_FOR_CONTROLLER_1
 
 #ifdef USE_X3D_FOR_CONTROLLER_2
@@ -239,12 +277,6 @@ const int POV_STILL = -1;
 #define CUBEINTAKE_RUN_ID			L310_BUTTON_BUMPER_LEFT
 #define CUBECLICKER_RAISE_ID		L310_THUMBSTICK_RIGHT_Y
 #define CUBECLICKER_LOWER_ID		L310_THUMBSTICK_RIGHT_Y
-
-#define CUBEINTAKE_RUN				Controller_2->GetRawButton(L310_BUTTON_BUMPER_LEFT)
-#define CUBEAUTO_START				Controller_2->GetRawButton(L310_BUTTON_X)
-#define CUBEAUTO_STOP				Controller_2->GetRawButton(L310_BUTTON_Y)
-#define CUBECLICKER_RAISE			(-Controller_2->GetRawAxis(L310_THUMBSTICK_RIGHT_Y) > 0.65)
-#define CUBECLICKER_LOWER			(-Controller_2->GetRawAxis(L310_THUMBSTICK_RIGHT_Y) < -0.65)
 #endif // USE_L310_FOR_CONTROLLER_2
 
 #endif //ROBOT_PARAMS_H
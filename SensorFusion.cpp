@@ -0,0 +1,199 @@
+/** \file
+ * Implementation of the sensor fusion class.
+ *
+ * The ADXRS453Z only measures yaw, so there is no pitch or roll rate to blend
+ * with the accelerometer.  The gyro is used instead to decide when to believe
+ * the accelerometer: the tilt is a low pass filter of the gravity direction that
+ * is held while the robot turns hard, when centripetal acceleration would drag
+ * it off.  Impacts are sudden changes in the horizontal acceleration against the
+ * same filtered value, so a slope or a mounting angle is not mistaken for one.
+ *
+ * The accelerometer is assumed to be mounted flat with X toward the front of the
+ * robot and Y toward the left.
+ */
+
+#include "SensorFusion.h"
+
+#include <math.h>
+#include <time.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "RobotParams.h"
+#include "RobotMessage.h"
+
+static const float RADIANS_TO_DEGREES = 57.2957795;
+
+int SensorFusionUpdateFunction(intptr_t pointer_val) {
+	SensorFusion *fusion = (SensorFusion *) pointer_val;
+	const double period = 1.0 / SENSORFUSION_SAMPLE_RATE;
+	HalClock *clock = Hal::GetInstance()->GetClock();
+	double deadline = clock->Now();
+
+	while (true)
+	{
+		fusion->Update();
+
+		deadline += period;
+		clock->WaitUntil(deadline);
+	}
+	return 0;
+}
+
+SensorFusion::SensorFusion(ADXRS453Z *gyro, HalAccelerometer *accelerometer)
+{
+	pGyro = gyro;
+	pAccelerometer = accelerometer;
+	fFilteredX = 0.0;
+	fFilteredY = 0.0;
+	fAccelMean = 1.0;
+	fLastImpactTime = 0.0;
+	iSubscribers.store(0, std::memory_order_relaxed);
+
+	for(int i = 0; i < SENSORFUSION_MAX_SUBSCRIBERS; i++)
+	{
+		szSubscribers[i] = NULL;
+		iSubscriberPipes[i] = -1;
+	}
+
+	fPitch = 0.0;
+	fRoll = 0.0;
+	fAccelVariance = 0.0;
+	uImpactCount = 0;
+	fLastImpact = 0.0;
+
+	pTask = new Task(SENSORFUSION_TASKNAME, (FUNCPTR) &SensorFusionUpdateFunction,
+			SENSORFUSION_PRIORITY, SENSORFUSION_STACKSIZE);
+	wpi_assert(pTask);
+	pTask->Start((intptr_t) this);
+}
+
+SensorFusion::~SensorFusion()
+{
+	delete pTask;
+	delete pAccelerometer;
+
+	for(int i = 0; i < iSubscribers.load(std::memory_order_acquire); i++)
+	{
+		if(iSubscriberPipes[i] >= 0)
+		{
+			close(iSubscriberPipes[i]);
+		}
+	}
+}
+
+///The update task is already running, so the slot is filled before the count that lets it see the slot
+void SensorFusion::Subscribe(const char *szQueueName)
+{
+	int iSlot = iSubscribers.load(std::memory_order_relaxed);
+
+	wpi_assert(iSlot < SENSORFUSION_MAX_SUBSCRIBERS);
+
+	if(iSlot < SENSORFUSION_MAX_SUBSCRIBERS)
+	{
+		szSubscribers[iSlot] = szQueueName;
+		iSubscribers.store(iSlot + 1, std::memory_order_release);
+	}
+}
+
+float SensorFusion::GetPitch()
+{
+	return(fPitch.load(std::memory_order_relaxed));
+}
+
+float SensorFusion::GetRoll()
+{
+	return(fRoll.load(std::memory_order_relaxed));
+}
+
+float SensorFusion::GetAccelVariance()
+{
+	return(fAccelVariance.load(std::memory_order_relaxed));
+}
+
+unsigned SensorFusion::GetImpactCount()
+{
+	return(uImpactCount.load(std::memory_order_acquire));
+}
+
+float SensorFusion::GetLastImpact()
+{
+	return(fLastImpact.load(std::memory_order_relaxed));
+}
+
+void SensorFusion::Update()
+{
+	double fNow = ADXRS453Z::Now();
+	float fAccelX = pAccelerometer->GetX();
+	float fAccelY = pAccelerometer->GetY();
+	float fAccelZ = pAccelerometer->GetZ();
+	float fAccel = sqrt(fAccelX * fAccelX + fAccelY * fAccelY + fAccelZ * fAccelZ);
+	float fDeviation = fAccel - fAccelMean;
+	float fJoltX = fAccelX - fFilteredX;
+	float fJoltY = fAccelY - fFilteredY;
+	float fJolt = sqrt(fJoltX * fJoltX + fJoltY * fJoltY);
+	float fVariance = fAccelVariance.load(std::memory_order_relaxed);
+
+	// running mean and variance of the magnitude so the mounting angle doesn't matter
+
+	fAccelMean += SENSORFUSION_VARIANCE_ALPHA * fDeviation;
+	fAccelVariance.store((1.0 - SENSORFUSION_VARIANCE_ALPHA)
+			* (fVariance + SENSORFUSION_VARIANCE_ALPHA * fDeviation * fDeviation),
+			std::memory_order_relaxed);
+
+	if((fJolt > SENSORFUSION_IMPACT_THRESHOLD)
+			&& ((fNow - fLastImpactTime) > SENSORFUSION_IMPACT_HOLDOFF))
+	{
+		fLastImpactTime = fNow;
+		PublishImpact(fJolt, fJoltX, fJoltY);
+	}
+
+	// a hard turn or a hit pulls the accelerometer off gravity, keep the last tilt
+
+	if((fabs(pGyro->GetRate()) > SENSORFUSION_TURN_GATE)
+			|| ((fNow - fLastImpactTime) < SENSORFUSION_IMPACT_HOLDOFF))
+	{
+		return;
+	}
+
+	fFilteredX += SENSORFUSION_TILT_ALPHA * fJoltX;
+	fFilteredY += SENSORFUSION_TILT_ALPHA * fJoltY;
+
+	fPitch.store(atan2(fFilteredX, sqrt(fFilteredY * fFilteredY + fAccelZ * fAccelZ))
+			* RADIANS_TO_DEGREES, std::memory_order_relaxed);
+	fRoll.store(atan2(fFilteredY, fAccelZ) * RADIANS_TO_DEGREES, std::memory_order_relaxed);
+}
+
+/**
+ * Sends COMMAND_SENSORFUSION_IMPACT to every subscriber.  The pipes are
+ * non-blocking so a component that is busy can never hold up this task; if its
+ * pipe is full the event is dropped and GetImpactCount() still shows it.
+ */
+void SensorFusion::PublishImpact(float fMagnitude, float fForward, float fSideways)
+{
+	RobotMessage message;
+	int iCount = iSubscribers.load(std::memory_order_acquire);
+
+	fLastImpact.store(fMagnitude, std::memory_order_relaxed);
+	uImpactCount.fetch_add(1, std::memory_order_release);
+
+	message.command = COMMAND_SENSORFUSION_IMPACT;
+	message.replyQ = NULL;
+	message.params.impact.magnitude = fMagnitude;
+	message.params.impact.forward = fForward;
+	message.params.impact.sideways = fSideways;
+
+	for(int i = 0; i < iCount; i++)
+	{
+		if(iSubscriberPipes[i] < 0)
+		{
+			iSubscriberPipes[i] = open(szSubscribers[i], O_WRONLY | O_NONBLOCK);
+		}
+
+		if(iSubscriberPipes[i] >= 0)
+		{
+			write(iSubscriberPipes[i], (char*) &message, sizeof(RobotMessage));
+		}
+	}
+}
@@ -0,0 +1,71 @@
+/** \file
+ * Definitions of the sensor fusion class, which combines the roboRIO accelerometer with the gyro.
+ *
+ * SensorFusion runs its own task at a fixed rate, sampling the accelerometer and
+ * the gyro together.  It keeps a tilt estimate, the variance of the acceleration
+ * (used to tell if the robot is sitting still) and watches for impact spikes.
+ * Components subscribe with their queue name and are sent
+ * COMMAND_SENSORFUSION_IMPACT when the robot runs into something.
+ */
+
+#ifndef SENSOR_FUSION_H
+#define SENSOR_FUSION_H
+
+#include "WPILib.h"
+
+#include <atomic>
+
+#include "ADXRS453Z.h"
+
+const int SENSORFUSION_SAMPLE_RATE = 200; //Hz
+const float SENSORFUSION_TILT_ALPHA = 0.02; //weight of each accelerometer reading in the tilt, about 0.25s
+const float SENSORFUSION_TURN_GATE = 60.0; //degrees per second of turning above which the tilt is held
+const float SENSORFUSION_VARIANCE_ALPHA = 0.05; //weight of each reading in the running mean and variance
+const float SENSORFUSION_IMPACT_THRESHOLD = 0.6; //g of sudden horizontal acceleration that counts as an impact
+const float SENSORFUSION_IMPACT_HOLDOFF = 0.25; //seconds after an impact before another is reported
+const int SENSORFUSION_MAX_SUBSCRIBERS = 4;
+
+int SensorFusionUpdateFunction(intptr_t pointer_val);
+
+class SensorFusion
+{
+public:
+	SensorFusion(ADXRS453Z *gyro, HalAccelerometer *accelerometer); //takes ownership of the accelerometer
+	~SensorFusion();
+
+	void Subscribe(const char *szQueueName); //call before the robot is enabled, from one thread, the task may already be running
+
+	float GetPitch(); //degrees, nose up +
+	float GetRoll(); //degrees, right side down +
+	float GetAccelVariance(); //g^2, of the acceleration magnitude
+	unsigned GetImpactCount(); //impacts since boot, compare two reads to see if one happened
+	float GetLastImpact(); //g, size of the latest impact
+
+private:
+	friend int SensorFusionUpdateFunction(intptr_t pointer_val);
+	void Update();
+	void PublishImpact(float fMagnitude, float fForward, float fSideways);
+
+	ADXRS453Z *pGyro;
+	HalAccelerometer *pAccelerometer;
+	Task *pTask;
+
+	//only the update task touches these
+	float fFilteredX;
+	float fFilteredY;
+	float fAccelMean;
+	double fLastImpactTime;
+
+	//Subscribe() fills a slot and then publishes the count, the update task reads the count first
+	std::atomic<int> iSubscribers;
+	const char *szSubscribers[SENSORFUSION_MAX_SUBSCRIBERS];
+	int iSubscriberPipes[SENSORFUSION_MAX_SUBSCRIBERS]; //only the update task touches these
+
+	std::atomic<float> fPitch;
+	std::atomic<float> fRoll;
+	std::atomic<float> fAccelVariance;
+	std::atomic<unsigned> uImpactCount;
+	std::atomic<float> fLastImpact;
+};
+
+#endif //SENSOR_FUSION_H
@@ -0,0 +1,191 @@
+/** \file
+ * Implementation of the telemetry publisher.
+ *
+ * The values are kept as their 32 bit patterns so a float and a bool share one
+ * kind of atomic slot.  Only the publisher task reads the table and only it
+ * talks to SmartDashboard; registration is the one place a lock is taken.
+ */
+
+#include "Telemetry.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "RobotParams.h"
+#include "FlightRecorder.h"
+#include "Hal.h"
+
+///One slot of the shadow table
+struct TelemetryEntry {
+	char szName[TELEMETRY_NAME_LENGTH];
+	TelemetryType type;
+	FlightChannel flight;			//every value put also goes to the flight recorder
+	std::atomic<uint32_t> uValue;
+	std::atomic<bool> bWritten;
+	//only the publisher task touches these
+	uint32_t uPublished;
+	bool bPublished;
+};
+
+static TelemetryEntry entries[TELEMETRY_MAX_KEYS];
+static std::atomic<int> iEntries(0);
+static pthread_mutex_t register_mutex = PTHREAD_MUTEX_INITIALIZER;
+static std::atomic<float> fRate(TELEMETRY_DEFAULT_RATE);
+static std::atomic<unsigned> uPublished(0);
+static std::atomic<unsigned> uSuppressed(0);
+static Task *pTask = NULL;
+
+///Returns the key for szName, registering it if it is new, or -1 if the table is full
+TelemetryKey Telemetry::Register(const char *szName, TelemetryType type)
+{
+	TelemetryKey key = -1;
+
+	pthread_mutex_lock(&register_mutex);
+
+	for(int i = 0; i < iEntries.load(std::memory_order_relaxed); i++)
+	{
+		if(strncmp(entries[i].szName, szName, TELEMETRY_NAME_LENGTH - 1) == 0)
+		{
+			key = i;
+			break;
+		}
+	}
+
+	if((key < 0) && (iEntries.load(std::memory_order_relaxed) < TELEMETRY_MAX_KEYS))
+	{
+		key = iEntries.load(std::memory_order_relaxed);
+
+		TelemetryEntry &entry = entries[key];
+
+		strncpy(entry.szName, szName, TELEMETRY_NAME_LENGTH - 1);
+		entry.szName[TELEMETRY_NAME_LENGTH - 1] = '\0';
+		entry.type = type;
+		entry.flight = FlightRecorder::Register(entry.szName);
+		entry.uValue = 0;
+		entry.bWritten = false;
+		entry.uPublished = 0;
+		entry.bPublished = false;
+
+		iEntries.store(key + 1, std::memory_order_release);
+	}
+
+	pthread_mutex_unlock(&register_mutex);
+
+	wpi_assert(key >= 0);
+	return(key);
+}
+
+void Telemetry::Put(TelemetryKey key, float fValue)
+{
+	uint32_t uValue;
+
+	if((key < 0) || (key >= TELEMETRY_MAX_KEYS))
+	{
+		return;
+	}
+
+	memcpy(&uValue, &fValue, sizeof(uValue));
+	entries[key].uValue.store(uValue, std::memory_order_relaxed);
+	entries[key].bWritten.store(true, std::memory_order_release);
+	FlightRecorder::Record(entries[key].flight, fValue);
+}
+
+void Telemetry::PutBoolean(TelemetryKey key, bool bValue)
+{
+	if((key < 0) || (key >= TELEMETRY_MAX_KEYS))
+	{
+		return;
+	}
+
+	entries[key].uValue.store(bValue ? 1 : 0, std::memory_order_relaxed);
+	entries[key].bWritten.store(true, std::memory_order_release);
+	FlightRecorder::Record(entries[key].flight, bValue ? 1.0 : 0.0);
+}
+
+void Telemetry::Start()
+{
+	if(pTask == NULL)
+	{
+		pTask = new Task(TELEMETRY_TASKNAME, (FUNCPTR) &Telemetry::StartTask,
+				TELEMETRY_PRIORITY, TELEMETRY_STACKSIZE);
+		wpi_assert(pTask);
+		pTask->Start();
+	}
+}
+
+void Telemetry::SetRate(float fHz)
+{
+	if(fHz > 0.0)
+	{
+		fRate.store(fHz, std::memory_order_relaxed);
+	}
+}
+
+unsigned Telemetry::GetPublishedCount()
+{
+	return(uPublished.load(std::memory_order_relaxed));
+}
+
+unsigned Telemetry::GetSuppressedCount()
+{
+	return(uSuppressed.load(std::memory_order_relaxed));
+}
+
+void *Telemetry::StartTask(void *pThis)
+{
+	HalClock *pClock = Hal::GetInstance()->GetClock();
+	double fDeadline = pClock->Now();
+
+	while(true)
+	{
+		Publish();
+
+		fDeadline += 1.0 / fRate.load(std::memory_order_relaxed);
+		pClock->WaitUntil(fDeadline);
+	}
+
+	return(NULL);
+}
+
+///Sends every value that was written and has changed since it was last sent
+void Telemetry::Publish()
+{
+	int iCount = iEntries.load(std::memory_order_acquire);
+
+	for(int i = 0; i < iCount; i++)
+	{
+		TelemetryEntry &entry = entries[i];
+		uint32_t uValue;
+
+		if(!entry.bWritten.load(std::memory_order_acquire))
+		{
+			continue;
+		}
+
+		uValue = entry.uValue.load(std::memory_order_relaxed);
+
+		if(entry.bPublished && (uValue == entry.uPublished))
+		{
+			uSuppressed.fetch_add(1, std::memory_order_relaxed);
+			continue;
+		}
+
+		if(entry.type == TELEMETRY_BOOLEAN)
+		{
+			SmartDashboard::PutBoolean(entry.szName, uValue != 0);
+		}
+		else
+		{
+			float fValue;
+
+			memcpy(&fValue, &uValue, sizeof(fValue));
+			SmartDashboard::PutNumber(entry.szName, fValue);
+		}
+
+		entry.uPublished = uValue;
+		entry.bPublished = true;
+		uPublished.fetch_add(1, std::memory_order_relaxed);
+	}
+}
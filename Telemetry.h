@@ -0,0 +1,53 @@
+/** \file
+ * Definitions of the telemetry publisher, which batches dashboard values off the hot paths.
+ *
+ * A value is registered once, by name, and gets back a key.  Putting a value is
+ * a single atomic store into that key's slot of a shadow table; it never takes a
+ * lock, builds a string or touches NetworkTables, so it is safe inside Run() and
+ * inside the tight autonomous loops.  A publisher task wakes at the telemetry
+ * rate and sends the dashboard only the values that changed since it last did.
+ *
+ * Registering the same name twice returns the same key, so two functions that
+ * report the same thing share a slot.  Every value put is also written to the
+ * flight recorder under the same name, at full rate.
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "WPILib.h"
+
+#include <stdint.h>
+#include <atomic>
+
+const int TELEMETRY_MAX_KEYS = 192;
+const int TELEMETRY_NAME_LENGTH = 48;
+const float TELEMETRY_DEFAULT_RATE = 10.0; //Hz, the dashboard can't show anything faster
+
+typedef int TelemetryKey;
+
+typedef enum eTelemetryType
+{
+	TELEMETRY_NUMBER,				//!< SmartDashboard::PutNumber
+	TELEMETRY_BOOLEAN				//!< SmartDashboard::PutBoolean
+} TelemetryType;
+
+class Telemetry
+{
+public:
+	static TelemetryKey Register(const char *szName, TelemetryType type); //at construction, not in loops
+	static void Put(TelemetryKey key, float fValue);
+	static void PutBoolean(TelemetryKey key, bool bValue);
+
+	static void Start(); //call once everything is built
+	static void SetRate(float fHz);
+	static unsigned GetPublishedCount(); //values sent to the dashboard since boot
+	static unsigned GetSuppressedCount(); //flushes that found a value unchanged
+
+	static void *StartTask(void *pThis);
+
+private:
+	static void Publish();
+};
+
+#endif //TELEMETRY_H
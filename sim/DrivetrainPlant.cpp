@@ -0,0 +1,222 @@
+/** \file
+ * Implementation of the drivetrain plant.
+ */
+
+#include "DrivetrainPlant.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "RobotParams.h"
+
+const double INCHES_PER_SECOND_SQUARED_PER_G = 386.09;
+const double DEGREES_PER_RADIAN = 57.29578;
+
+const uint8_t GYRO_READ_REGISTER = 0x80; //100A AAAA, any other first byte is a sensor data request
+const uint8_t GYRO_READ_MASK = 0xE0;
+const uint32_t GYRO_STATUS_SENSOR_DATA = 0x04000000; //ST = 01
+const uint32_t GYRO_STATUS_READ = 0x40000000; //010 in the top bits, a register read
+const uint32_t GYRO_PARITY_HIGH = 0x10000000; //P0, odd parity over the top 16 bits
+const uint32_t GYRO_PARITY_LOW = 0x00000001; //P, odd parity over all 32
+const double GYRO_LSB_PER_DEGREE = 80.0;
+
+///Moves fValue toward fTarget by at most fLimit
+static double Slew(double fValue, double fTarget, double fLimit)
+{
+	if(fTarget > fValue + fLimit)
+	{
+		return(fValue + fLimit);
+	}
+
+	if(fTarget < fValue - fLimit)
+	{
+		return(fValue - fLimit);
+	}
+
+	return(fTarget);
+}
+
+DrivetrainPlant::DrivetrainPlant(HalSim *pHal, const DrivetrainPlantParams &params)
+{
+	this->pHal = pHal;
+	this->params = params;
+	bGyroAttached = false;
+	uLastCommand = 0;
+	Reset();
+}
+
+///Between runs, with the gyro task waiting its turn on the virtual clock
+void DrivetrainPlant::Reset()
+{
+	uNoiseState = params.uSeed;
+	fLeftVolts = 0.0;
+	fRightVolts = 0.0;
+	fLeftWheel = 0.0;
+	fRightWheel = 0.0;
+	fLeftGround = 0.0;
+	fRightGround = 0.0;
+	fLeftDistance = 0.0;
+	fRightDistance = 0.0;
+	fX = 0.0;
+	fY = 0.0;
+	fHeading = 0.0;
+	fForwardAccel = 0.0;
+	fSideAccel = 0.0;
+	fYawRate.store(0.0, std::memory_order_relaxed);
+}
+
+/**
+ * The devices are made by Drivetrain, which may come after us, so they are
+ * looked up every tick.  Until the motors are there the robot sits still.
+ */
+void DrivetrainPlant::Tick(double fNow, double fStep)
+{
+	SimMotor *pLeft = pHal->GetMotor(CAN_DRIVETRAIN_LEFT_MOTOR);
+	SimMotor *pRight = pHal->GetMotor(CAN_DRIVETRAIN_RIGHT_MOTOR);
+	SimSpi *pSpi = pHal->GetSpi(SPI_GYRO);
+	SimAccelerometer *pAccelerometer = pHal->GetAccelerometer();
+	SimEncoder *pEncoder = pHal->GetEncoder(DIO_DRIVETRAIN_ENCODER_A);
+
+	if(pSpi && !bGyroAttached)
+	{
+		pSpi->Attach(this);
+		bGyroAttached = true;
+	}
+
+	if(pLeft && pRight)
+	{
+		// the Talons share the bus, one ramp rate for both is what Drivetrain sets
+
+		Advance(pLeft->Get(), pRight->Get(), pLeft->GetBusVoltage(), pLeft->GetVoltageRampRate(), fStep);
+	}
+
+	if(pAccelerometer)
+	{
+		pAccelerometer->Set(fForwardAccel, fSideAccel, 1.0);
+	}
+
+	if(pEncoder)
+	{
+		pEncoder->SetCount((int32_t)lround(fLeftDistance / params.fEncoderRatio));
+		pEncoder->SetCountRate(fLeftWheel / params.fEncoderRatio);
+	}
+}
+
+void DrivetrainPlant::Step(float fLeft, float fRight, double fStep)
+{
+	Advance(fLeft, fRight, DRIVEPLANT_NOMINAL_VOLTS, 0.0, fStep);
+}
+
+void DrivetrainPlant::Advance(double fLeft, double fRight, double fBusVolts, double fRampRate, double fStep)
+{
+	double fLag = 1.0 - exp(-fStep / params.fTimeConstant);
+	double fPush = params.fTraction * fStep;
+	double fLastSpeed = GetSpeed();
+	double fSpeed;
+	double fRate;
+
+	// the right side is mounted reversed
+
+	if(fRampRate > 0.0)
+	{
+		fLeftVolts = Slew(fLeftVolts, fLeft * fBusVolts, fRampRate * fStep);
+		fRightVolts = Slew(fRightVolts, -fRight * fBusVolts, fRampRate * fStep);
+	}
+	else
+	{
+		fLeftVolts = fLeft * fBusVolts;
+		fRightVolts = -fRight * fBusVolts;
+	}
+
+	fLeftWheel += (fLeftVolts / DRIVEPLANT_NOMINAL_VOLTS * params.fFreeSpeed - fLeftWheel) * fLag;
+	fRightWheel += (fRightVolts / DRIVEPLANT_NOMINAL_VOLTS * params.fFreeSpeed - fRightWheel) * fLag;
+
+	// a side can't change speed faster than the tires grip, past that the wheel spins
+
+	fLeftGround = Slew(fLeftGround, fLeftWheel, fPush);
+	fRightGround = Slew(fRightGround, fRightWheel, fPush);
+
+	fLeftDistance += fLeftWheel * fStep;
+	fRightDistance += fRightWheel * fStep;
+
+	fSpeed = GetSpeed();
+	fRate = (fLeftGround - fRightGround) / (params.fTrackWidth * params.fScrub) * DEGREES_PER_RADIAN;
+
+	fHeading += fRate * fStep;
+	fX += fSpeed * cos(fHeading / DEGREES_PER_RADIAN) * fStep;
+	fY += fSpeed * sin(fHeading / DEGREES_PER_RADIAN) * fStep;
+
+	// turning clockwise pulls toward the right, which is - on the accelerometer's Y
+
+	fForwardAccel = (fSpeed - fLastSpeed) / fStep / INCHES_PER_SECOND_SQUARED_PER_G;
+	fSideAccel = -fSpeed * (fRate / DEGREES_PER_RADIAN) / INCHES_PER_SECOND_SQUARED_PER_G;
+	fYawRate.store(fRate, std::memory_order_relaxed);
+}
+
+/**
+ * Answers the previous command, as the ADXRS453 does.  A register read is
+ * answered with the temperature whatever the register, that is the only one
+ * ADXRS453Z reads.  Sensor data is the yaw rate plus bias and noise.
+ */
+void DrivetrainPlant::Transaction(const uint8_t *pSend, uint8_t *pReceive, uint8_t uSize)
+{
+	uint32_t uFrame;
+	int iData;
+
+	if((uLastCommand & GYRO_READ_MASK) == GYRO_READ_REGISTER)
+	{
+		// TEM: the top 10 bits are 0 at 45C and 5 per degree
+
+		iData = (int)lround((DRIVEPLANT_GYRO_TEMPERATURE - 45.0) * 5.0);
+		uFrame = GYRO_STATUS_READ | ((((uint32_t)iData << 6) & 0xFFFF) << 5);
+	}
+	else
+	{
+		iData = (int)lround((GetYawRate() + params.fGyroBias + GyroNoise()) * GYRO_LSB_PER_DEGREE);
+
+		if(iData > 32767)
+		{
+			iData = 32767;
+		}
+		else if(iData < -32768)
+		{
+			iData = -32768;
+		}
+
+		uFrame = GYRO_STATUS_SENSOR_DATA | ((uint32_t)(iData & 0xFFFF) << 10);
+	}
+
+	if((__builtin_popcount(uFrame >> 16) & 1) == 0)
+	{
+		uFrame |= GYRO_PARITY_HIGH;
+	}
+
+	if((__builtin_popcount(uFrame) & 1) == 0)
+	{
+		uFrame |= GYRO_PARITY_LOW;
+	}
+
+	uLastCommand = (uSize > 0) ? pSend[0] : 0;
+	memset(pReceive, 0, uSize);
+
+	for(int i = 0; (i < 4) && (i < uSize); i++)
+	{
+		pReceive[i] = (uint8_t)(uFrame >> (24 - 8 * i));
+	}
+}
+
+///Roughly normal, the sum of four uniform draws from a 64 bit LCG
+float DrivetrainPlant::GyroNoise()
+{
+	double fSum = 0.0;
+
+	for(int i = 0; i < 4; i++)
+	{
+		uNoiseState = uNoiseState * 6364136223846793005ULL + 1442695040888963407ULL;
+		fSum += (double)(uNoiseState >> 11) / 9007199254740992.0 - 0.5; //top 53 bits over 2^53
+	}
+
+	// four uniforms on [-0.5, 0.5) have a variance of 1/3
+
+	return(fSum * 1.7320508 * params.fGyroNoise);
+}
@@ -0,0 +1,107 @@
+/** \file
+ * Definitions of the drivetrain plant, a simulated skid steer robot for tuning the autonomous drive moves off the robot.
+ *
+ * Each tick the plant reads the setpoints Drivetrain gave its two Talons and
+ * moves the robot on.  The right motor is mounted reversed, as Drivetrain
+ * assumes, and every setpoint is taken as a fraction of the bus voltage.  The
+ * voltage slews at the Talon's ramp rate when one is set.  Each wheel's surface
+ * speed follows its voltage with a first order lag.  The ground under each
+ * side follows its wheel only as fast as the tires can push, so a hard start
+ * spins the wheels and the encoders see it.  A turn scrubs, so the robot
+ * turns slower than the wheel speeds alone would make it.
+ *
+ * What the robot does comes back through the sensors Drivetrain already reads:
+ * - The plant sits on the gyro's SPI port and answers in the ADXRS453Z's
+ *   frame format.  Clockwise is a positive rate, as Drivetrain expects, with
+ *   seeded noise so frames don't repeat and runs stay repeatable.
+ * - The accelerometer sees the forward and centripetal acceleration.
+ * - The left wheel drives the encoder on DIO_DRIVETRAIN_ENCODER_A, in
+ *   DRIVETRAIN_ENCODER_RATIO pulses, once Drivetrain makes that encoder.
+ *
+ * The model is a handful of multiplies per tick, so a run's cost is the
+ * components' tasks handing the virtual clock around, not the plant.  The gyro
+ * takes CALIBRATE_PERIOD to calibrate, so a sweep pays for that once: build
+ * the runner, the plant and the components, run the calibration out disabled,
+ * then for each run Reset() the plant, SetRobotState() to autonomous, Step()
+ * while Autonomous::IsRunningScript() and go back to disabled for a moment.
+ * Step() moves the plant on its own when a sweep wants the physics without
+ * the threads.
+ *
+ * The pose is in inches from where the plant started: x along the starting
+ * heading, y to its right, and the heading in degrees clockwise.
+ */
+
+#ifndef DRIVETRAIN_PLANT_H
+#define DRIVETRAIN_PLANT_H
+
+#include <stdint.h>
+
+#include <atomic>
+
+#include "LockstepRunner.h"
+#include "Drivetrain.h"
+
+const float DRIVEPLANT_NOMINAL_VOLTS = 12.0;
+const float DRIVEPLANT_GYRO_TEMPERATURE = 25.0; //degrees C, well inside the calibration's tolerance
+
+///What the robot is like, the defaults are a 2015 six wheel drop center on CIMs
+struct DrivetrainPlantParams {
+	float fFreeSpeed = 150.0;		//inches per second a wheel surface reaches at DRIVEPLANT_NOMINAL_VOLTS
+	float fTimeConstant = 0.12;		//seconds for a wheel to reach 63% of a new speed
+	float fTraction = 200.0;		//inches per second squared the tires can push a side before slipping, under SENSORFUSION_IMPACT_THRESHOLD
+	float fTrackWidth = 24.0;		//inches between the wheel centers
+	float fScrub = 1.3;				//how much wider than fTrackWidth the robot turns, from the outer wheels scrubbing
+	float fEncoderRatio = DRIVETRAIN_ENCODER_RATIO;	//inches per encoder pulse
+	float fGyroBias = 0.0;			//degrees per second the gyro reads when still
+	float fGyroNoise = 0.13;		//degrees per second, standard deviation of one gyro sample, sqrt(GYRO_RATE_NOISE)
+	uint64_t uSeed = 1;				//for the gyro noise, the same seed gives the same run
+};
+
+class DrivetrainPlant : public SimTickHandler, public SimSpiDevice
+{
+public:
+	DrivetrainPlant(HalSim *pHal, const DrivetrainPlantParams &params = DrivetrainPlantParams());
+
+	void Tick(double fNow, double fStep); //reads the motors and sensors from the HAL
+	void Step(float fLeft, float fRight, double fStep); //setpoints as Drivetrain writes them, touches no devices
+	void Transaction(const uint8_t *pSend, uint8_t *pReceive, uint8_t uSize); //from the gyro task
+
+	void Reset(); //stopped, at the origin, with the gyro noise started over from uSeed
+
+	double GetX() { return(fX); };
+	double GetY() { return(fY); };
+	double GetHeading() { return(fHeading); };
+	double GetYawRate() { return(fYawRate.load(std::memory_order_relaxed)); }; //degrees per second, clockwise
+	double GetSpeed() { return(0.5 * (fLeftGround + fRightGround)); }; //inches per second, forward
+	double GetLeftDistance() { return(fLeftDistance); }; //inches the left wheel surface has turned
+	double GetRightDistance() { return(fRightDistance); };
+
+private:
+	void Advance(double fLeft, double fRight, double fBusVolts, double fRampRate, double fStep);
+	float GyroNoise();
+
+	HalSim *pHal;
+	DrivetrainPlantParams params;
+	bool bGyroAttached;
+
+	double fLeftVolts;
+	double fRightVolts;
+	double fLeftWheel; //inches per second at the wheel surface
+	double fRightWheel;
+	double fLeftGround; //inches per second the side moves over the carpet
+	double fRightGround;
+	double fLeftDistance;
+	double fRightDistance;
+	double fX;
+	double fY;
+	double fHeading;
+	double fForwardAccel; //g
+	double fSideAccel; //g, toward the left
+	std::atomic<double> fYawRate;
+
+	//only the gyro task touches these once the plant is running
+	uint8_t uLastCommand; //the first byte, responses come one transaction late
+	uint64_t uNoiseState;
+};
+
+#endif //DRIVETRAIN_PLANT_H
@@ -0,0 +1,318 @@
+/** \file
+ * Implementation of the simulated HAL backend.
+ */
+
+#include "HalSim.h"
+
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+#include <sys/select.h>
+
+SimMotor::SimMotor(int iCanId)
+{
+	iDeviceNumber = iCanId;
+	fSetpoint.store(0.0);
+	controlMode.store(HAL_CONTROL_PERCENT_VBUS);
+	fRampRate.store(0.0);
+	limitMode.store(HAL_LIMIT_SWITCH_INPUTS_ONLY);
+	neutralMode.store(HAL_NEUTRAL_JUMPER);
+	bAlive.store(true);
+	bFwdLimit.store(false);
+	bRevLimit.store(false);
+	fCurrent.store(0.0);
+	fBusVoltage.store(12.0);
+	iQuadB.store(0);
+}
+
+SimDigitalInput::SimDigitalInput()
+{
+	bValue.store(false);
+	iRisingEdges.store(0);
+}
+
+///Only the test writes an input, so the compare and the edge count need no lock
+void SimDigitalInput::Set(bool bNew)
+{
+	if(bNew && !bValue.load(std::memory_order_relaxed))
+	{
+		iRisingEdges.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	bValue.store(bNew, std::memory_order_relaxed);
+}
+
+SimCounter::SimCounter(SimDigitalInput *pInput)
+{
+	this->pInput = pInput;
+	iBase.store(pInput->GetRisingEdges());
+}
+
+SimEncoder::SimEncoder(bool bReverse)
+{
+	this->bReverse = bReverse;
+	iCount.store(0);
+	iBase.store(0);
+	fCountRate.store(0.0);
+	fDistancePerPulse.store(1.0);
+}
+
+double SimEncoder::GetDistance()
+{
+	double fCounts = iCount.load(std::memory_order_relaxed) - iBase.load(std::memory_order_relaxed);
+
+	return((bReverse ? -fCounts : fCounts) * fDistancePerPulse.load(std::memory_order_relaxed));
+}
+
+double SimEncoder::GetRate()
+{
+	double fRate = fCountRate.load(std::memory_order_relaxed);
+
+	return((bReverse ? -fRate : fRate) * fDistancePerPulse.load(std::memory_order_relaxed));
+}
+
+SimSpi::SimSpi()
+{
+	pDevice.store(NULL);
+}
+
+int32_t SimSpi::Transaction(uint8_t *pSend, uint8_t *pReceive, uint8_t uSize)
+{
+	SimSpiDevice *pAttached = pDevice.load(std::memory_order_acquire);
+
+	if(pAttached)
+	{
+		pAttached->Transaction(pSend, pReceive, uSize);
+	}
+	else
+	{
+		memset(pReceive, 0, uSize);
+	}
+
+	return(uSize);
+}
+
+SimAccelerometer::SimAccelerometer()
+{
+	Set(0.0, 0.0, 1.0);
+}
+
+void SimAccelerometer::Set(double fNewX, double fNewY, double fNewZ)
+{
+	fX.store(fNewX, std::memory_order_relaxed);
+	fY.store(fNewY, std::memory_order_relaxed);
+	fZ.store(fNewZ, std::memory_order_relaxed);
+}
+
+double SimClock::Now()
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec + now.tv_nsec * 1.0e-9);
+}
+
+void SimClock::WaitUntil(double fDeadline)
+{
+	struct timespec deadline;
+
+	deadline.tv_sec = (time_t)fDeadline;
+	deadline.tv_nsec = (long)((fDeadline - deadline.tv_sec) * 1.0e9);
+	clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+}
+
+bool SimClock::WaitForInput(int iFd, double fTimeout)
+{
+	fd_set selectSet;
+	struct timeval timeout;
+
+	FD_ZERO(&selectSet);
+	FD_SET(iFd, &selectSet);
+
+	timeout.tv_sec = (time_t)fTimeout;
+	timeout.tv_usec = (long)((fTimeout - timeout.tv_sec) * 1.0e6);
+
+	return(select(iFd + 1, &selectSet, NULL, NULL, &timeout) > 0);
+}
+
+SimDriverStation::SimDriverStation()
+{
+	bEnabled.store(false);
+	bAutonomous.store(false);
+	bTest.store(false);
+
+	for(int i = 0; i < SIM_MAX_STICKS; i++)
+	{
+		for(int j = 0; j < SIM_MAX_AXES; j++)
+		{
+			fAxes[i][j].store(0.0);
+		}
+
+		uButtons[i].store(0);
+	}
+}
+
+void SimDriverStation::SetMode(bool bNewAutonomous, bool bNewTest)
+{
+	bAutonomous.store(bNewAutonomous, std::memory_order_relaxed);
+	bTest.store(bNewTest, std::memory_order_relaxed);
+}
+
+float SimDriverStation::GetStickAxis(int iStick, int iAxis)
+{
+	if((iStick < 0) || (iStick >= SIM_MAX_STICKS) || (iAxis < 0) || (iAxis >= SIM_MAX_AXES))
+	{
+		return(0.0);
+	}
+
+	return(fAxes[iStick][iAxis].load(std::memory_order_relaxed));
+}
+
+bool SimDriverStation::GetStickButton(int iStick, int iButton)
+{
+	if((iStick < 0) || (iStick >= SIM_MAX_STICKS) || (iButton < 1) || (iButton > SIM_MAX_BUTTONS))
+	{
+		return(false);
+	}
+
+	return((uButtons[iStick].load(std::memory_order_relaxed) & ((uint32_t)1 << (iButton - 1))) != 0);
+}
+
+void SimDriverStation::SetStickAxis(int iStick, int iAxis, float fValue)
+{
+	if((iStick >= 0) && (iStick < SIM_MAX_STICKS) && (iAxis >= 0) && (iAxis < SIM_MAX_AXES))
+	{
+		fAxes[iStick][iAxis].store(fValue, std::memory_order_relaxed);
+	}
+}
+
+void SimDriverStation::SetStickButton(int iStick, int iButton, bool bPressed)
+{
+	if((iStick >= 0) && (iStick < SIM_MAX_STICKS) && (iButton >= 1) && (iButton <= SIM_MAX_BUTTONS))
+	{
+		uint32_t uMask = (uint32_t)1 << (iButton - 1);
+
+		if(bPressed)
+		{
+			uButtons[iStick].fetch_or(uMask, std::memory_order_relaxed);
+		}
+		else
+		{
+			uButtons[iStick].fetch_and(~uMask, std::memory_order_relaxed);
+		}
+	}
+}
+
+HalSim::HalSim(HalClock *pClock)
+{
+	for(int i = 0; i < SIM_MAX_CAN_IDS; i++)
+	{
+		pMotors[i] = NULL;
+	}
+
+	for(int i = 0; i < SIM_MAX_CHANNELS; i++)
+	{
+		pInputs[i] = NULL;
+		pEncoders[i] = NULL;
+	}
+
+	for(int i = 0; i < SIM_SPI_PORTS; i++)
+	{
+		pSpis[i] = NULL;
+	}
+
+	pAccelerometer = NULL;
+	bOwnClock = (pClock == NULL);
+	this->pClock = bOwnClock ? new SimClock() : pClock;
+	pDriverStation = new SimDriverStation();
+}
+
+///The devices belong to the components that asked for them, only the driver station and our own clock are ours
+HalSim::~HalSim()
+{
+	if(bOwnClock)
+	{
+		delete pClock;
+	}
+
+	delete pDriverStation;
+}
+
+HalMotor *HalSim::NewTalon(int iCanId)
+{
+	SimMotor *pMotor = new SimMotor(iCanId);
+
+	if((iCanId >= 0) && (iCanId < SIM_MAX_CAN_IDS))
+	{
+		pMotors[iCanId] = pMotor;
+	}
+
+	return(pMotor);
+}
+
+HalDigitalInput *HalSim::NewDigitalInput(int iChannel)
+{
+	SimDigitalInput *pInput = new SimDigitalInput();
+
+	if((iChannel >= 0) && (iChannel < SIM_MAX_CHANNELS))
+	{
+		pInputs[iChannel] = pInput;
+	}
+
+	return(pInput);
+}
+
+HalCounter *HalSim::NewCounter(HalDigitalInput *pInput)
+{
+	return(new SimCounter((SimDigitalInput *)pInput));
+}
+
+HalEncoder *HalSim::NewEncoder(int iChannelA, int iChannelB, bool bReverse)
+{
+	SimEncoder *pEncoder = new SimEncoder(bReverse);
+
+	if((iChannelA >= 0) && (iChannelA < SIM_MAX_CHANNELS))
+	{
+		pEncoders[iChannelA] = pEncoder;
+	}
+
+	return(pEncoder);
+}
+
+HalSpi *HalSim::NewSpi(int iPort)
+{
+	SimSpi *pSpi = new SimSpi();
+
+	if((iPort >= 0) && (iPort < SIM_SPI_PORTS))
+	{
+		pSpis[iPort] = pSpi;
+	}
+
+	return(pSpi);
+}
+
+HalAccelerometer *HalSim::NewAccelerometer()
+{
+	pAccelerometer = new SimAccelerometer();
+	return(pAccelerometer);
+}
+
+SimMotor *HalSim::GetMotor(int iCanId)
+{
+	return(((iCanId >= 0) && (iCanId < SIM_MAX_CAN_IDS)) ? pMotors[iCanId] : NULL);
+}
+
+SimDigitalInput *HalSim::GetDigitalInput(int iChannel)
+{
+	return(((iChannel >= 0) && (iChannel < SIM_MAX_CHANNELS)) ? pInputs[iChannel] : NULL);
+}
+
+SimEncoder *HalSim::GetEncoder(int iChannelA)
+{
+	return(((iChannelA >= 0) && (iChannelA < SIM_MAX_CHANNELS)) ? pEncoders[iChannelA] : NULL);
+}
+
+SimSpi *HalSim::GetSpi(int iPort)
+{
+	return(((iPort >= 0) && (iPort < SIM_SPI_PORTS)) ? pSpis[iPort] : NULL);
+}
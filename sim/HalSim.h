@@ -0,0 +1,262 @@
+/** \file
+ * Definitions of the simulated HAL backend, which keeps every device in memory so the robot code runs on a Linux box.
+ *
+ * A motor remembers what it was told and reports the limit switches, current
+ * and bus voltage the test sets; an input, encoder or accelerometer reads
+ * whatever the test put there; an SPI port hands each transaction to the
+ * SimSpiDevice attached to it.  The driver station's mode and sticks are set
+ * the same way.  HalSim keeps a pointer to each device it made so a test can
+ * find a motor by CAN ID or an input by channel after the components have
+ * built them.  Those pointers live as long as the component that owns the device.
+ *
+ * The values are atomics, a test thread writes them while the component tasks
+ * read them.
+ *
+ * The components build on the host against sim/WPILib.h, which has the tasks,
+ * timers and dashboard but none of the devices, so anything that still reaches
+ * for a device past the HAL doesn't compile.  sim/Makefile builds them with
+ * the tests in sim/SimTest.cpp, from the top of the tree:
+ * \verbatim
+ make -C sim test
+ \endverbatim
+ * A new test adds its cases to SimTest.cpp, or its own program to the Makefile
+ * with the same sources.
+ */
+
+#ifndef HAL_SIM_H
+#define HAL_SIM_H
+
+#include <stddef.h>
+
+#include <atomic>
+
+#include "Hal.h"
+
+const int SIM_MAX_CAN_IDS = 64;
+const int SIM_MAX_CHANNELS = 26; //10 on the roboRIO and 16 on the MXP
+const int SIM_SPI_PORTS = 5; //SPI::Port, the four onboard chip selects and the MXP
+const int SIM_MAX_STICKS = 6;
+const int SIM_MAX_AXES = 12;
+const int SIM_MAX_BUTTONS = 32;
+
+class SimMotor : public HalMotor
+{
+public:
+	SimMotor(int iCanId);
+
+	void Set(float fValue) { fSetpoint.store(fValue, std::memory_order_relaxed); };
+	float Get() { return(fSetpoint.load(std::memory_order_relaxed)); };
+	void SetControlMode(HalControlMode mode) { controlMode.store(mode, std::memory_order_relaxed); };
+	void SetVoltageRampRate(double fRampRate) { this->fRampRate.store(fRampRate, std::memory_order_relaxed); };
+	void ConfigLimitMode(HalLimitMode mode) { limitMode.store(mode, std::memory_order_relaxed); };
+	void ConfigNeutralMode(HalNeutralMode mode) { neutralMode.store(mode, std::memory_order_relaxed); };
+	void ConfigFwdLimitSwitchNormallyOpen(bool bNormallyOpen) {};
+	void ConfigRevLimitSwitchNormallyOpen(bool bNormallyOpen) {};
+	void SetStatusFrameRateMs(HalStatusFrame frame, int iPeriodMs) {};
+
+	bool IsAlive() { return(bAlive.load(std::memory_order_relaxed)); };
+	bool IsFwdLimitSwitchClosed() { return(bFwdLimit.load(std::memory_order_relaxed)); };
+	bool IsRevLimitSwitchClosed() { return(bRevLimit.load(std::memory_order_relaxed)); };
+	float GetOutputCurrent() { return(fCurrent.load(std::memory_order_relaxed)); };
+	float GetBusVoltage() { return(fBusVoltage.load(std::memory_order_relaxed)); };
+	int GetPinStateQuadB() { return(iQuadB.load(std::memory_order_relaxed)); };
+	int GetDeviceNumber() { return(iDeviceNumber); };
+
+	//what the code asked for
+	HalControlMode GetControlMode() { return(controlMode.load(std::memory_order_relaxed)); };
+	double GetVoltageRampRate() { return(fRampRate.load(std::memory_order_relaxed)); };
+	HalLimitMode GetLimitMode() { return(limitMode.load(std::memory_order_relaxed)); };
+	HalNeutralMode GetNeutralMode() { return(neutralMode.load(std::memory_order_relaxed)); };
+
+	//what the test says the Talon sees
+	void SetAlive(bool bValue) { bAlive.store(bValue, std::memory_order_relaxed); };
+	void SetFwdLimitSwitch(bool bClosed) { bFwdLimit.store(bClosed, std::memory_order_relaxed); };
+	void SetRevLimitSwitch(bool bClosed) { bRevLimit.store(bClosed, std::memory_order_relaxed); };
+	void SetOutputCurrent(float fAmps) { fCurrent.store(fAmps, std::memory_order_relaxed); };
+	void SetBusVoltage(float fVolts) { fBusVoltage.store(fVolts, std::memory_order_relaxed); };
+	void SetPinStateQuadB(int iValue) { iQuadB.store(iValue, std::memory_order_relaxed); };
+
+private:
+	int iDeviceNumber;
+	std::atomic<float> fSetpoint;
+	std::atomic<HalControlMode> controlMode;
+	std::atomic<double> fRampRate;
+	std::atomic<HalLimitMode> limitMode;
+	std::atomic<HalNeutralMode> neutralMode;
+	std::atomic<bool> bAlive;
+	std::atomic<bool> bFwdLimit;
+	std::atomic<bool> bRevLimit;
+	std::atomic<float> fCurrent;
+	std::atomic<float> fBusVoltage;
+	std::atomic<int> iQuadB;
+};
+
+///A digital input, which also counts its own rising edges for the counters built on it
+class SimDigitalInput : public HalDigitalInput
+{
+public:
+	SimDigitalInput();
+
+	bool Get() { return(bValue.load(std::memory_order_relaxed)); };
+
+	void Set(bool bNew); //from the test
+	int32_t GetRisingEdges() { return(iRisingEdges.load(std::memory_order_relaxed)); };
+
+private:
+	std::atomic<bool> bValue;
+	std::atomic<int32_t> iRisingEdges;
+};
+
+class SimCounter : public HalCounter
+{
+public:
+	SimCounter(SimDigitalInput *pInput);
+
+	void Reset() { iBase.store(pInput->GetRisingEdges(), std::memory_order_relaxed); };
+	int32_t Get() { return(pInput->GetRisingEdges() - iBase.load(std::memory_order_relaxed)); };
+
+private:
+	SimDigitalInput *pInput;
+	std::atomic<int32_t> iBase;
+};
+
+class SimEncoder : public HalEncoder
+{
+public:
+	SimEncoder(bool bReverse);
+
+	void Reset() { iBase.store(iCount.load(std::memory_order_relaxed), std::memory_order_relaxed); };
+	void SetDistancePerPulse(double fDistance) { fDistancePerPulse.store(fDistance, std::memory_order_relaxed); };
+	double GetDistance();
+	double GetRate();
+
+	void SetCount(int32_t iNew) { iCount.store(iNew, std::memory_order_relaxed); }; //4X counts, before any reversing
+	void SetCountRate(double fCountsPerSecond) { fCountRate.store(fCountsPerSecond, std::memory_order_relaxed); };
+
+private:
+	bool bReverse;
+	std::atomic<int32_t> iCount;
+	std::atomic<int32_t> iBase;
+	std::atomic<double> fCountRate;
+	std::atomic<double> fDistancePerPulse;
+};
+
+///What sits on the other end of a simulated SPI port
+class SimSpiDevice
+{
+public:
+	virtual ~SimSpiDevice() {};
+
+	virtual void Transaction(const uint8_t *pSend, uint8_t *pReceive, uint8_t uSize) = 0;
+};
+
+class SimSpi : public HalSpi
+{
+public:
+	SimSpi();
+
+	void SetClockRate(double fHz) {};
+	void SetClockActiveHigh() {};
+	void SetChipSelectActiveLow() {};
+	void SetMSBFirst() {};
+	int32_t Transaction(uint8_t *pSend, uint8_t *pReceive, uint8_t uSize); //zeros with nothing attached
+
+	void Attach(SimSpiDevice *pDevice) { this->pDevice.store(pDevice, std::memory_order_release); };
+
+private:
+	std::atomic<SimSpiDevice *> pDevice;
+};
+
+class SimAccelerometer : public HalAccelerometer
+{
+public:
+	SimAccelerometer(); //flat and still, 1 g down
+
+	double GetX() { return(fX.load(std::memory_order_relaxed)); };
+	double GetY() { return(fY.load(std::memory_order_relaxed)); };
+	double GetZ() { return(fZ.load(std::memory_order_relaxed)); };
+
+	void Set(double fNewX, double fNewY, double fNewZ);
+
+private:
+	std::atomic<double> fX;
+	std::atomic<double> fY;
+	std::atomic<double> fZ;
+};
+
+///Wall clock time, CLOCK_MONOTONIC, with the tasks running as the host schedules them
+class SimClock : public HalClock
+{
+public:
+	double Now();
+	void Wait(double fSeconds) { WaitUntil(Now() + fSeconds); };
+	void WaitUntil(double fDeadline);
+	bool WaitForInput(int iFd, double fTimeout);
+};
+
+class SimDriverStation : public HalDriverStation
+{
+public:
+	SimDriverStation(); //disabled, teleop, sticks centered
+
+	bool IsEnabled() { return(bEnabled.load(std::memory_order_relaxed)); };
+	bool IsAutonomous() { return(bAutonomous.load(std::memory_order_relaxed)); };
+	bool IsOperatorControl() { return(!bAutonomous.load(std::memory_order_relaxed) && !bTest.load(std::memory_order_relaxed)); };
+	bool IsTest() { return(bTest.load(std::memory_order_relaxed)); };
+	float GetStickAxis(int iStick, int iAxis);
+	bool GetStickButton(int iStick, int iButton);
+
+	void SetEnabled(bool bValue) { bEnabled.store(bValue, std::memory_order_relaxed); };
+	void SetAutonomous() { SetMode(true, false); };
+	void SetOperatorControl() { SetMode(false, false); };
+	void SetTest() { SetMode(false, true); };
+	void SetStickAxis(int iStick, int iAxis, float fValue);
+	void SetStickButton(int iStick, int iButton, bool bPressed); //buttons count from 1, as in WPILib
+
+private:
+	void SetMode(bool bNewAutonomous, bool bNewTest);
+
+	std::atomic<bool> bEnabled;
+	std::atomic<bool> bAutonomous;
+	std::atomic<bool> bTest;
+	std::atomic<float> fAxes[SIM_MAX_STICKS][SIM_MAX_AXES];
+	std::atomic<uint32_t> uButtons[SIM_MAX_STICKS];
+};
+
+class HalSim : public Hal
+{
+public:
+	HalSim(HalClock *pClock = NULL); //the wall clock unless one is given, which stays the caller's
+	virtual ~HalSim();
+
+	HalDigitalInput *NewDigitalInput(int iChannel);
+	HalCounter *NewCounter(HalDigitalInput *pInput);
+	HalEncoder *NewEncoder(int iChannelA, int iChannelB, bool bReverse);
+	HalSpi *NewSpi(int iPort);
+	HalAccelerometer *NewAccelerometer();
+	HalClock *GetClock() { return(pClock); };
+	HalDriverStation *GetDriverStation() { return(pDriverStation); };
+
+	//for the test, NULL until the robot code has built the device
+	SimMotor *GetMotor(int iCanId);
+	SimDigitalInput *GetDigitalInput(int iChannel);
+	SimEncoder *GetEncoder(int iChannelA);
+	SimSpi *GetSpi(int iPort);
+	SimAccelerometer *GetAccelerometer() { return(pAccelerometer); };
+	SimDriverStation *GetSimDriverStation() { return(pDriverStation); };
+
+protected:
+	HalMotor *NewTalon(int iCanId);
+
+private:
+	SimMotor *pMotors[SIM_MAX_CAN_IDS];
+	SimDigitalInput *pInputs[SIM_MAX_CHANNELS];
+	SimEncoder *pEncoders[SIM_MAX_CHANNELS];
+	SimSpi *pSpis[SIM_SPI_PORTS];
+	SimAccelerometer *pAccelerometer;
+	HalClock *pClock;
+	bool bOwnClock;
+	SimDriverStation *pDriverStation;
+};
+
+#endif //HAL_SIM_H
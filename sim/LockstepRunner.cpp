@@ -0,0 +1,212 @@
+/** \file
+ * Implementation of the lockstep runner.
+ */
+
+#include "LockstepRunner.h"
+
+#include <string.h>
+
+#include "ComponentBase.h"
+
+const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+const uint64_t FNV_PRIME = 1099511628211ULL;
+
+///FNV-1a, folding uSize bytes into uHash
+static uint64_t HashBytes(uint64_t uHash, const void *pData, size_t uSize)
+{
+	const uint8_t *pBytes = (const uint8_t *)pData;
+
+	for(size_t i = 0; i < uSize; i++)
+	{
+		uHash ^= pBytes[i];
+		uHash *= FNV_PRIME;
+	}
+
+	return(uHash);
+}
+
+LockstepRunner::LockstepRunner(double fTick)
+{
+	pClock = new VirtualClock();
+	pHal = new HalSim(pClock);
+	Hal::SetInstance(pHal);
+
+	this->fTick = fTick;
+	fNextTick = pClock->Now();
+	iComponents = 0;
+	iHandlers = 0;
+	iEvents = 0;
+	pTrace = NULL;
+	bTraceHeader = false;
+	uHash = FNV_OFFSET_BASIS;
+}
+
+void LockstepRunner::AddComponent(ComponentBase *pComponent)
+{
+	if(iComponents < LOCKSTEP_MAX_COMPONENTS)
+	{
+		pComponents[iComponents++] = pComponent;
+	}
+}
+
+void LockstepRunner::AddTickHandler(SimTickHandler *pHandler)
+{
+	if(iHandlers < LOCKSTEP_MAX_HANDLERS)
+	{
+		pHandlers[iHandlers++] = pHandler;
+	}
+}
+
+bool LockstepRunner::Schedule(double fTime, ComponentBase *pComponent, const RobotMessage &message)
+{
+	int iSlot = iEvents;
+
+	if(iEvents >= LOCKSTEP_MAX_EVENTS)
+	{
+		return(false);
+	}
+
+	// after everything due at the same time, so ties go in the order scheduled
+
+	while((iSlot > 0) && (events[iSlot - 1].fTime > fTime))
+	{
+		events[iSlot] = events[iSlot - 1];
+		iSlot--;
+	}
+
+	events[iSlot].fTime = fTime;
+	events[iSlot].pComponent = pComponent;
+	events[iSlot].message = message;
+	iEvents++;
+	return(true);
+}
+
+void LockstepRunner::SetRobotState(MessageCommand state)
+{
+	SimDriverStation *pDriverStation = pHal->GetSimDriverStation();
+	RobotMessage message;
+
+	switch(state)
+	{
+		case COMMAND_ROBOT_STATE_AUTONOMOUS:
+			pDriverStation->SetAutonomous();
+			break;
+
+		case COMMAND_ROBOT_STATE_TEST:
+			pDriverStation->SetTest();
+			break;
+
+		default:
+			pDriverStation->SetOperatorControl();
+			break;
+	}
+
+	pDriverStation->SetEnabled((state != COMMAND_ROBOT_STATE_DISABLED) && (state != COMMAND_ROBOT_STATE_UNKNOWN));
+
+	memset(&message, 0, sizeof(message));
+	message.command = state;
+
+	for(int i = 0; i < iComponents; i++)
+	{
+		pComponents[i]->SendMessage(&message);
+	}
+}
+
+void LockstepRunner::Step()
+{
+	double fNow = pClock->Now();
+
+	Deliver();
+
+	for(int i = 0; i < iHandlers; i++)
+	{
+		pHandlers[i]->Tick(fNow, fTick);
+	}
+
+	Record();
+
+	// ticks are counted from the start rather than from when we woke, so they don't drift
+
+	fNextTick += fTick;
+	pClock->WaitUntil(fNextTick);
+}
+
+void LockstepRunner::RunFor(double fSeconds)
+{
+	double fEnd = pClock->Now() + fSeconds;
+
+	while(pClock->Now() < fEnd)
+	{
+		Step();
+	}
+}
+
+///Sends every message due by now, in time order
+void LockstepRunner::Deliver()
+{
+	double fNow = pClock->Now();
+	int iDue = 0;
+
+	while((iDue < iEvents) && (events[iDue].fTime <= fNow))
+	{
+		events[iDue].pComponent->SendMessage(&events[iDue].message);
+		iDue++;
+	}
+
+	if(iDue > 0)
+	{
+		memmove(&events[0], &events[iDue], (iEvents - iDue) * sizeof(ScheduledMessage));
+		iEvents -= iDue;
+	}
+}
+
+///One line of every motor the components made, in CAN ID order
+void LockstepRunner::Record()
+{
+	double fNow = pClock->Now();
+
+	if(pTrace && !bTraceHeader)
+	{
+		fprintf(pTrace, "time");
+
+		for(int i = 0; i < SIM_MAX_CAN_IDS; i++)
+		{
+			if(pHal->GetMotor(i))
+			{
+				fprintf(pTrace, ",can%d", i);
+			}
+		}
+
+		fprintf(pTrace, "\n");
+		bTraceHeader = true;
+	}
+
+	uHash = HashBytes(uHash, &fNow, sizeof(fNow));
+
+	if(pTrace)
+	{
+		fprintf(pTrace, "%.4f", fNow);
+	}
+
+	for(int i = 0; i < SIM_MAX_CAN_IDS; i++)
+	{
+		SimMotor *pMotor = pHal->GetMotor(i);
+
+		if(pMotor)
+		{
+			float fSetpoint = pMotor->Get();
+
+			uHash = HashBytes(uHash, &fSetpoint, sizeof(fSetpoint));
+
+			if(pTrace)
+			{
+				fprintf(pTrace, ",%.4f", fSetpoint);
+			}
+		}
+	}
+
+	if(pTrace)
+	{
+		fprintf(pTrace, "\n");
+	}
+}
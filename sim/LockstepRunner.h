@@ -0,0 +1,92 @@
+/** \file
+ * Definitions of the lockstep runner, which drives the components through a simulation on the virtual clock.
+ *
+ * The runner makes the VirtualClock and a HalSim on it, and installs that as
+ * the HAL, so it has to exist before any component.  The thread that makes it
+ * is the test, and it only lets the component tasks run when it waits.  Each
+ * Step() hands out the messages that are due, lets every tick handler move the
+ * simulated world on, writes one line of motor setpoints to the trace and
+ * waits one tick of virtual time, during which every task due in that tick
+ * gets its turns.
+ *
+ * Teleop is played back as a schedule of the messages RhsRobot would have sent
+ * for the sticks, autonomous by SetRobotState(COMMAND_ROBOT_STATE_AUTONOMOUS)
+ * with the script named through Autonomous::SetScriptFile().  A run of the
+ * same schedule gives the same trace and the same GetTraceHash() every time.
+ *
+ * sim/Makefile builds it, with sim/DrivetrainPlant.cpp for a robot that moves.
+ */
+
+#ifndef LOCKSTEP_RUNNER_H
+#define LOCKSTEP_RUNNER_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "HalSim.h"
+#include "VirtualClock.h"
+#include "RobotMessage.h"
+
+class ComponentBase;
+
+const double LOCKSTEP_DEFAULT_TICK = 0.005; //seconds, the fastest component loop
+const int LOCKSTEP_MAX_COMPONENTS = 16;
+const int LOCKSTEP_MAX_HANDLERS = 8;
+const int LOCKSTEP_MAX_EVENTS = 512;
+
+///Anything the test simulates around the robot, called once per tick before the components run
+class SimTickHandler
+{
+public:
+	virtual ~SimTickHandler() {};
+
+	virtual void Tick(double fNow, double fStep) = 0;
+};
+
+class LockstepRunner
+{
+public:
+	LockstepRunner(double fTick = LOCKSTEP_DEFAULT_TICK); //like the HAL it installs, it stays for the life of the process
+
+	HalSim *GetHal() { return(pHal); };
+	VirtualClock *GetClock() { return(pClock); };
+	double Now() { return(pClock->Now()); };
+
+	void AddComponent(ComponentBase *pComponent); //gets the robot state changes
+	void AddTickHandler(SimTickHandler *pHandler);
+	bool Schedule(double fTime, ComponentBase *pComponent, const RobotMessage &message); //false when the schedule is full
+	void SetRobotState(MessageCommand state); //the driver station's mode, and the message RhsRobot sends on a change
+	void SetTrace(FILE *pFile) { pTrace = pFile; }; //CSV of the motor setpoints each tick, NULL for none
+
+	void Step();
+	void RunFor(double fSeconds);
+
+	uint64_t GetTraceHash() { return(uHash); }; //over every tick's time and setpoints, traced or not
+
+private:
+	typedef struct
+	{
+		double fTime;
+		ComponentBase *pComponent;
+		RobotMessage message;
+	} ScheduledMessage;
+
+	void Deliver();
+	void Record();
+
+	VirtualClock *pClock;
+	HalSim *pHal;
+	double fTick;
+	double fNextTick;
+	ComponentBase *pComponents[LOCKSTEP_MAX_COMPONENTS];
+	int iComponents;
+	SimTickHandler *pHandlers[LOCKSTEP_MAX_HANDLERS];
+	int iHandlers;
+	ScheduledMessage events[LOCKSTEP_MAX_EVENTS]; //in time order, the same time in the order scheduled
+	int iEvents;
+	FILE *pTrace;
+	bool bTraceHeader;
+	uint64_t uHash;
+};
+
+#endif //LOCKSTEP_RUNNER_H
@@ -0,0 +1,284 @@
+/** \file
+ * Host tests of the components running on the lockstep runner.
+ *
+ * The runner installs itself as the HAL for the life of the process and leaves
+ * the component tasks parked when it is done, so each case runs in a child of
+ * its own and sends its result back up a pipe.  A case that hangs the virtual
+ * clock is killed after SIMTEST_CASE_TIMEOUT of wall time and fails.
+ *
+ * - Straight: STRAIGHT 0.5 for 2s on the drivetrain plant, twice.  Both runs
+ *   have to leave the same trace hash, and the robot has to end up about
+ *   SIMTEST_STRAIGHT_DISTANCE ahead, still on its starting heading.
+ * - Frontload: FRONTLOADTOTE with the tote never reaching the limit switch has
+ *   to give up at its timeout.
+ *
+ * The gyro calibration is saved to GYRO_CALIBRATION_FILEPATH when a run goes
+ * back to disabled, so on a laptop without /home/lvuser every run calibrates
+ * from scratch and the hash stays put.
+ *
+ * From the top of the tree:
+ * \verbatim
+ make -C sim test
+ \endverbatim
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "LockstepRunner.h"
+#include "DrivetrainPlant.h"
+#include "RobotParams.h"
+#include "Drivetrain.h"
+#include "Conveyor.h"
+#include "Autonomous.h"
+#include "RobotLog.h"
+#include "Telemetry.h"
+
+const unsigned SIMTEST_CASE_TIMEOUT = 120; //seconds of wall time
+const double SIMTEST_CALIBRATE_TIME = 16.0; //seconds disabled, past the gyro's CALIBRATE_PERIOD
+const double SIMTEST_STRAIGHT_DISTANCE = 150.0; //inches, STRAIGHT 0.5 for 2s on the default plant
+const double SIMTEST_STRAIGHT_TOLERANCE = 15.0;
+const double SIMTEST_STRAIGHT_MAX_HEADING = 2.0; //degrees
+const double SIMTEST_FRONTLOAD_TIMEOUT = 2.0;
+const double SIMTEST_SCRIPT_LIMIT = 30.0; //seconds of virtual time a script may take
+
+///What a case sends back to the parent
+typedef struct
+{
+	bool bPassed;
+	uint64_t uHash;
+	double fX;
+	double fY;
+	double fHeading;
+	double fTime; //virtual seconds the script ran
+} SimTestResult;
+
+typedef void (*SimTestCase)(SimTestResult &result);
+
+///Writes szScript to a temporary file and returns its name, which the caller frees
+static char *WriteScript(const char *szScript)
+{
+	char *szFile = strdup("/tmp/SimTestXXXXXX");
+	int iFd = mkstemp(szFile);
+
+	if(iFd < 0)
+	{
+		free(szFile);
+		return(NULL);
+	}
+
+	if(write(iFd, szScript, strlen(szScript)) != (ssize_t)strlen(szScript))
+	{
+		close(iFd);
+		free(szFile);
+		return(NULL);
+	}
+
+	close(iFd);
+	return(szFile);
+}
+
+///Steps until the script ends or SIMTEST_SCRIPT_LIMIT passes, returns how long it ran
+static double RunScript(LockstepRunner &runner, Autonomous *pAutonomous)
+{
+	double fStart = runner.Now();
+
+	runner.SetRobotState(COMMAND_ROBOT_STATE_AUTONOMOUS);
+
+	// the script starts when Autonomous gets the state change, on the next tick
+
+	runner.Step();
+
+	while(pAutonomous->IsRunningScript() && ((runner.Now() - fStart) < SIMTEST_SCRIPT_LIMIT))
+	{
+		runner.Step();
+	}
+
+	return(runner.Now() - fStart);
+}
+
+static void StraightCase(SimTestResult &result)
+{
+	LockstepRunner runner;
+	HalSim *pHal = runner.GetHal();
+	DrivetrainPlant plant(pHal);
+	char *szScript = WriteScript("BEGIN\nSTRAIGHT 0.5 2.0\nDELAY 2.0\nEND\n");
+
+	if(szScript == NULL)
+	{
+		return;
+	}
+
+	RobotLog::Start();
+	Telemetry::Start();
+
+	Drivetrain *pDrivetrain = new Drivetrain(pHal);
+	Autonomous *pAutonomous = new Autonomous(pHal);
+
+	pAutonomous->SetScriptFile(szScript);
+	runner.AddTickHandler(&plant);
+	runner.AddComponent(pDrivetrain);
+	runner.AddComponent(pAutonomous);
+
+	runner.RunFor(SIMTEST_CALIBRATE_TIME);
+	plant.Reset();
+	result.fTime = RunScript(runner, pAutonomous);
+
+	// let the robot coast to a stop before reading where it is
+
+	runner.SetRobotState(COMMAND_ROBOT_STATE_DISABLED);
+	runner.RunFor(1.0);
+
+	result.uHash = runner.GetTraceHash();
+	result.fX = plant.GetX();
+	result.fY = plant.GetY();
+	result.fHeading = plant.GetHeading();
+	result.bPassed = !pAutonomous->IsRunningScript()
+			&& (fabs(result.fX - SIMTEST_STRAIGHT_DISTANCE) < SIMTEST_STRAIGHT_TOLERANCE)
+			&& (fabs(result.fHeading) < SIMTEST_STRAIGHT_MAX_HEADING);
+
+	unlink(szScript);
+	free(szScript);
+}
+
+static void FrontloadCase(SimTestResult &result)
+{
+	LockstepRunner runner;
+	HalSim *pHal = runner.GetHal();
+	char szLine[64];
+	char *szScript;
+
+	snprintf(szLine, sizeof(szLine), "BEGIN\nFRONTLOADTOTE %0.1f\nEND\n", SIMTEST_FRONTLOAD_TIMEOUT);
+	szScript = WriteScript(szLine);
+
+	if(szScript == NULL)
+	{
+		return;
+	}
+
+	RobotLog::Start();
+	Telemetry::Start();
+
+	Drivetrain *pDrivetrain = new Drivetrain(pHal);
+	Conveyor *pConveyor = new Conveyor(pHal);
+	Autonomous *pAutonomous = new Autonomous(pHal);
+
+	pAutonomous->SetScriptFile(szScript);
+	runner.AddComponent(pDrivetrain);
+	runner.AddComponent(pConveyor);
+	runner.AddComponent(pAutonomous);
+
+	// both switches closed reads as no tote, so the conveyor waits for one that never comes
+
+	pHal->GetMotor(CAN_PALLET_JACK_CONVEYOR)->SetFwdLimitSwitch(true);
+	pHal->GetMotor(CAN_PALLET_JACK_CONVEYOR)->SetRevLimitSwitch(true);
+
+	runner.RunFor(1.0);
+	result.fTime = RunScript(runner, pAutonomous);
+	result.uHash = runner.GetTraceHash();
+	result.bPassed = !pAutonomous->IsRunningScript()
+			&& (result.fTime >= SIMTEST_FRONTLOAD_TIMEOUT)
+			&& (result.fTime < SIMTEST_FRONTLOAD_TIMEOUT + 1.0);
+
+	unlink(szScript);
+	free(szScript);
+}
+
+///Runs a case in a child process, false if it failed, hung or died
+static bool RunCase(SimTestCase testCase, SimTestResult &result)
+{
+	int pipeFds[2];
+	int iStatus;
+	pid_t child;
+	bool bRead;
+
+	memset(&result, 0, sizeof(result));
+
+	if(pipe(pipeFds) != 0)
+	{
+		return(false);
+	}
+
+	fflush(stdout);
+	child = fork();
+
+	if(child < 0)
+	{
+		return(false);
+	}
+
+	if(child == 0)
+	{
+		SimTestResult childResult;
+
+		close(pipeFds[0]);
+		alarm(SIMTEST_CASE_TIMEOUT);
+		memset(&childResult, 0, sizeof(childResult));
+		testCase(childResult);
+
+		if(write(pipeFds[1], &childResult, sizeof(childResult)) != sizeof(childResult))
+		{
+			_exit(1);
+		}
+
+		// the component tasks are still parked on the clock, don't wait for them
+
+		fflush(stdout);
+		_exit(0);
+	}
+
+	close(pipeFds[1]);
+	bRead = (read(pipeFds[0], &result, sizeof(result)) == sizeof(result));
+	close(pipeFds[0]);
+	waitpid(child, &iStatus, 0);
+
+	if(!bRead || !WIFEXITED(iStatus) || (WEXITSTATUS(iStatus) != 0))
+	{
+		printf("case %s\n", WIFSIGNALED(iStatus) ? "hung or crashed" : "didn't report");
+		result.bPassed = false;
+	}
+
+	return(result.bPassed);
+}
+
+int main()
+{
+	SimTestResult first;
+	SimTestResult second;
+	SimTestResult frontload;
+	int iFailures = 0;
+
+	RunCase(StraightCase, first);
+	RunCase(StraightCase, second);
+	printf("straight: x %0.1f y %0.1f heading %0.2f in %0.2fs, hash %016llx\n",
+			first.fX, first.fY, first.fHeading, first.fTime, (unsigned long long)first.uHash);
+
+	if(!first.bPassed || !second.bPassed)
+	{
+		printf("FAIL straight: expected x within %0.1f of %0.1f and heading within %0.1f\n",
+				SIMTEST_STRAIGHT_TOLERANCE, SIMTEST_STRAIGHT_DISTANCE, SIMTEST_STRAIGHT_MAX_HEADING);
+		iFailures++;
+	}
+
+	if(first.uHash != second.uHash)
+	{
+		printf("FAIL straight: second run's hash %016llx differs\n", (unsigned long long)second.uHash);
+		iFailures++;
+	}
+
+	RunCase(FrontloadCase, frontload);
+	printf("frontload: script ran %0.2fs\n", frontload.fTime);
+
+	if(!frontload.bPassed)
+	{
+		printf("FAIL frontload: expected the script to end at its %0.1fs timeout\n", SIMTEST_FRONTLOAD_TIMEOUT);
+		iFailures++;
+	}
+
+	printf("%s\n", iFailures ? "FAILED" : "PASSED");
+	return(iFailures ? 1 : 0);
+}
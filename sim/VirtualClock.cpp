@@ -0,0 +1,258 @@
+/** \file
+ * Implementation of the virtual clock.
+ *
+ * All of the state is under one mutex.  A task that blocks records what it is
+ * waiting for, passes its turn on and sleeps on its own condition until the
+ * clock hands it a turn again.
+ */
+
+#include "VirtualClock.h"
+
+#include <stdio.h>
+#include <poll.h>
+
+static __thread int iThisTask = -1; //the calling thread's slot
+
+VirtualClock::VirtualClock(double fStart)
+{
+	pthread_mutex_init(&mutex, NULL);
+
+	for(int i = 0; i < VIRTUALCLOCK_MAX_TASKS; i++)
+	{
+		tasks[i].bActive = false;
+		tasks[i].bWaiting = false;
+		tasks[i].bInput = false;
+		tasks[i].fWake = 0.0;
+		tasks[i].iFd = -1;
+		pthread_cond_init(&tasks[i].turn, NULL);
+	}
+
+	fNow.store(fStart, std::memory_order_release);
+	uSwitches = 0;
+
+	// whoever made us holds the clock
+
+	tasks[0].bActive = true;
+	iTasks = 1;
+	iRunning = 0;
+	iThisTask = 0;
+}
+
+///The threads parked in here are left parked, the process is on its way out
+VirtualClock::~VirtualClock()
+{
+	iThisTask = -1;
+}
+
+void VirtualClock::WaitUntil(double fDeadline)
+{
+	Block(fDeadline, -1);
+}
+
+bool VirtualClock::WaitForInput(int iFd, double fTimeout)
+{
+	return(Block(Now() + fTimeout, iFd));
+}
+
+int VirtualClock::AddTask()
+{
+	int iSlot = -1;
+
+	pthread_mutex_lock(&mutex);
+
+	if(iTasks < VIRTUALCLOCK_MAX_TASKS)
+	{
+		iSlot = iTasks++;
+
+		// ready straight away, it runs when the task starting it next blocks
+
+		tasks[iSlot].bActive = true;
+		tasks[iSlot].bWaiting = true;
+		tasks[iSlot].fWake = Now();
+		tasks[iSlot].iFd = -1;
+	}
+	else
+	{
+		fprintf(stderr, "Virtual clock is out of task slots\n");
+	}
+
+	pthread_mutex_unlock(&mutex);
+	return(iSlot);
+}
+
+void VirtualClock::EnterTask(int iSlot)
+{
+	pthread_mutex_lock(&mutex);
+
+	iThisTask = iSlot;
+
+	while(iRunning != iSlot)
+	{
+		pthread_cond_wait(&tasks[iSlot].turn, &mutex);
+	}
+
+	tasks[iSlot].bWaiting = false;
+	pthread_mutex_unlock(&mutex);
+}
+
+void VirtualClock::ExitTask()
+{
+	pthread_mutex_lock(&mutex);
+
+	if(iThisTask >= 0)
+	{
+		tasks[iThisTask].bActive = false;
+
+		if(iRunning == iThisTask)
+		{
+			PassTurn();
+		}
+
+		iThisTask = -1;
+	}
+
+	pthread_mutex_unlock(&mutex);
+}
+
+void VirtualClock::RemoveTask(int iSlot)
+{
+	pthread_mutex_lock(&mutex);
+
+	if((iSlot >= 0) && (iSlot < iTasks))
+	{
+		tasks[iSlot].bActive = false;
+	}
+
+	pthread_mutex_unlock(&mutex);
+}
+
+unsigned long long VirtualClock::GetSwitches()
+{
+	unsigned long long uResult;
+
+	pthread_mutex_lock(&mutex);
+	uResult = uSwitches;
+	pthread_mutex_unlock(&mutex);
+
+	return(uResult);
+}
+
+/**
+ * Gives up the clock until fWake, or until iFd can be read if it isn't -1, and
+ * returns true in the second case.  A thread the clock has never seen joins the
+ * turns here; that works, but where it lands in the order depends on the host.
+ */
+bool VirtualClock::Block(double fWake, int iFd)
+{
+	bool bInput;
+
+	pthread_mutex_lock(&mutex);
+
+	if(iThisTask < 0)
+	{
+		if(iTasks >= VIRTUALCLOCK_MAX_TASKS)
+		{
+			fprintf(stderr, "Virtual clock is out of task slots\n");
+			pthread_mutex_unlock(&mutex);
+			return(false);
+		}
+
+		iThisTask = iTasks++;
+		tasks[iThisTask].bActive = true;
+	}
+
+	VirtualTask &task = tasks[iThisTask];
+
+	task.fWake = fWake;
+	task.iFd = iFd;
+	task.bInput = false;
+	task.bWaiting = true;
+
+	if((iRunning == iThisTask) || (iRunning < 0))
+	{
+		PassTurn();
+	}
+
+	while(iRunning != iThisTask)
+	{
+		pthread_cond_wait(&task.turn, &mutex);
+	}
+
+	task.bWaiting = false;
+	bInput = task.bInput;
+
+	pthread_mutex_unlock(&mutex);
+	return(bInput);
+}
+
+///Only called with the mutex held
+bool VirtualClock::IsReady(VirtualTask &task)
+{
+	struct pollfd input;
+
+	if(!task.bActive || !task.bWaiting)
+	{
+		return(false);
+	}
+
+	if(task.iFd >= 0)
+	{
+		input.fd = task.iFd;
+		input.events = POLLIN;
+		input.revents = 0;
+
+		if(poll(&input, 1, 0) > 0)
+		{
+			task.bInput = true;
+			return(true);
+		}
+	}
+
+	return(task.fWake <= Now());
+}
+
+/**
+ * Hands the clock to the next ready task after the one that had it, moving
+ * time up to the earliest wake time when none is ready.  Only called with the
+ * mutex held, by the task giving the clock up.
+ */
+void VirtualClock::PassTurn()
+{
+	int iLast = (iRunning >= 0) ? iRunning : 0;
+
+	while(true)
+	{
+		double fEarliest = 0.0;
+		bool bAnyWaiting = false;
+
+		for(int i = 1; i <= iTasks; i++)
+		{
+			int iNext = (iLast + i) % iTasks;
+
+			if(IsReady(tasks[iNext]))
+			{
+				iRunning = iNext;
+				uSwitches++;
+				pthread_cond_signal(&tasks[iNext].turn);
+				return;
+			}
+		}
+
+		for(int i = 0; i < iTasks; i++)
+		{
+			if(tasks[i].bActive && tasks[i].bWaiting && (!bAnyWaiting || (tasks[i].fWake < fEarliest)))
+			{
+				fEarliest = tasks[i].fWake;
+				bAnyWaiting = true;
+			}
+		}
+
+		if(!bAnyWaiting)
+		{
+			iRunning = -1;
+			return;
+		}
+
+		fNow.store(fEarliest, std::memory_order_release);
+	}
+}
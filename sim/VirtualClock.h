@@ -0,0 +1,77 @@
+/** \file
+ * Definitions of the virtual clock, which runs the robot's tasks one at a time in simulated time.
+ *
+ * Every task blocks only through the HAL clock: Wait(), WaitUntil() or
+ * WaitForInput() on its message pipe.  The virtual clock lets exactly one task
+ * run at a time.  When the running task blocks, the clock hands over to the
+ * next task that is ready at the current time, taking them in turn after the
+ * one that ran last.  A task is ready once its wake time has come or its pipe
+ * has something in it.  When none is ready, time jumps straight to the earliest
+ * wake time.  Nothing waits on the wall clock, so a 15 second autonomous
+ * routine takes as long as the code takes to run.  Because the order tasks run
+ * in depends only on the clock, two runs of the same inputs match bit for bit.
+ *
+ * A task has to be known to the clock before it first runs, so that the order
+ * is fixed too.  The sim's Task does this in Start() with AddTask(), and the
+ * new thread calls EnterTask() before it does anything.  The thread that makes
+ * the clock is the first task and holds the clock.  A task that is stopped
+ * from outside is dropped from the turns and its thread parked for good.
+ *
+ * A task that spins without calling the clock stops the whole simulation.
+ * There is one virtual clock per process.
+ */
+
+#ifndef VIRTUAL_CLOCK_H
+#define VIRTUAL_CLOCK_H
+
+#include <pthread.h>
+
+#include <atomic>
+
+#include "Hal.h"
+
+const int VIRTUALCLOCK_MAX_TASKS = 128; //over the life of the process, slots aren't reused
+const double VIRTUALCLOCK_START = 10.0; //seconds, roughly how long the roboRIO has been up when the robot code starts
+
+class VirtualClock : public HalClock
+{
+public:
+	VirtualClock(double fStart = VIRTUALCLOCK_START);
+	virtual ~VirtualClock();
+
+	double Now() { return(fNow.load(std::memory_order_acquire)); };
+	void Wait(double fSeconds) { WaitUntil(Now() + fSeconds); };
+	void WaitUntil(double fDeadline);
+	bool WaitForInput(int iFd, double fTimeout);
+
+	int AddTask(); //by the task starting a thread, returns the slot the thread enters with, -1 if full
+	void EnterTask(int iSlot); //the new thread's first call, returns on its first turn
+	void ExitTask(); //the thread's last call, passes its turn on
+	void RemoveTask(int iSlot); //a task stopped from outside never gets another turn
+
+	unsigned long long GetSwitches(); //turns handed over so far
+
+private:
+	typedef struct
+	{
+		bool bActive;
+		bool bWaiting;
+		bool bInput; //woken because the pipe had something
+		double fWake;
+		int iFd; //-1 when only waiting on time
+		pthread_cond_t turn;
+	} VirtualTask;
+
+	bool Block(double fWake, int iFd);
+	void PassTurn();
+	bool IsReady(VirtualTask &task);
+
+	pthread_mutex_t mutex;
+	VirtualTask tasks[VIRTUALCLOCK_MAX_TASKS];
+	int iTasks;
+	int iRunning; //the task holding the clock, -1 for none
+	std::atomic<double> fNow;
+	unsigned long long uSwitches;
+};
+
+#endif //VIRTUAL_CLOCK_H
@@ -0,0 +1,220 @@
+/** \file
+ * Implementation of the host stand-in for WPILib.
+ */
+
+#include "WPILib.h"
+
+#include <string.h>
+#include <time.h>
+
+#include "Hal.h"
+#include "VirtualClock.h"
+
+///The virtual clock if that is what the HAL runs on
+static VirtualClock *GetVirtualClock()
+{
+	if(Hal::GetInstance())
+	{
+		return(dynamic_cast<VirtualClock *>(Hal::GetInstance()->GetClock()));
+	}
+
+	return(NULL);
+}
+
+bool wpi_assert_impl(bool bCondition, const char *szCondition, const char *szFile, int iLine, const char *szFunction)
+{
+	if(!bCondition)
+	{
+		fprintf(stderr, "Assertion \"%s\" failed in %s() at %s:%d\n", szCondition, szFunction, szFile, iLine);
+	}
+
+	return(bCondition);
+}
+
+///Before there is a backend this is CLOCK_MONOTONIC, what the HAL clocks start from anyway
+double GetTime()
+{
+	struct timespec now;
+
+	if(Hal::GetInstance())
+	{
+		return(Hal::GetInstance()->GetClock()->Now());
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec + now.tv_nsec * 1.0e-9);
+}
+
+void Wait(double fSeconds)
+{
+	struct timespec delay;
+
+	if(Hal::GetInstance())
+	{
+		Hal::GetInstance()->GetClock()->Wait(fSeconds);
+	}
+	else if(fSeconds > 0.0)
+	{
+		delay.tv_sec = (time_t)fSeconds;
+		delay.tv_nsec = (long)((fSeconds - delay.tv_sec) * 1.0e9);
+		nanosleep(&delay, NULL);
+	}
+}
+
+Timer::Timer()
+{
+	pthread_mutex_init(&mutex, NULL);
+	Reset();
+	bRunning = false;
+}
+
+double Timer::Get()
+{
+	double fResult;
+
+	pthread_mutex_lock(&mutex);
+	fResult = bRunning ? (fAccumulatedTime + GetTime() - fStartTime) : fAccumulatedTime;
+	pthread_mutex_unlock(&mutex);
+
+	return(fResult);
+}
+
+void Timer::Reset()
+{
+	pthread_mutex_lock(&mutex);
+	fAccumulatedTime = 0.0;
+	fStartTime = GetTime();
+	pthread_mutex_unlock(&mutex);
+}
+
+void Timer::Start()
+{
+	pthread_mutex_lock(&mutex);
+
+	if(!bRunning)
+	{
+		fStartTime = GetTime();
+		bRunning = true;
+	}
+
+	pthread_mutex_unlock(&mutex);
+}
+
+void Timer::Stop()
+{
+	pthread_mutex_lock(&mutex);
+
+	if(bRunning)
+	{
+		fAccumulatedTime += GetTime() - fStartTime;
+		bRunning = false;
+	}
+
+	pthread_mutex_unlock(&mutex);
+}
+
+///True once a period has gone by, and the timer moves on by exactly one period so none are lost
+bool Timer::HasPeriodPassed(double fPeriod)
+{
+	if(Get() > fPeriod)
+	{
+		pthread_mutex_lock(&mutex);
+		fStartTime += fPeriod;
+		pthread_mutex_unlock(&mutex);
+		return(true);
+	}
+
+	return(false);
+}
+
+Task::Task(const char *szName, FUNCPTR function, int iPriority, int iStackSize)
+{
+	snprintf(this->szName, sizeof(this->szName), "%s", szName);
+	this->function = function;
+	arg = 0;
+	bRunning = false;
+	iClockSlot = -1;
+}
+
+Task::~Task()
+{
+	Stop();
+}
+
+bool Task::Start(intptr_t arg0)
+{
+	if(bRunning)
+	{
+		return(false);
+	}
+
+	VirtualClock *pVirtual = GetVirtualClock();
+
+	arg = arg0;
+	iClockSlot = pVirtual ? pVirtual->AddTask() : -1;
+
+	if(pthread_create(&thread, NULL, &Task::Run, this) != 0)
+	{
+		if(pVirtual)
+		{
+			pVirtual->RemoveTask(iClockSlot);
+		}
+
+		return(false);
+	}
+
+	pthread_setname_np(thread, szName);
+	bRunning = true;
+	return(true);
+}
+
+/**
+ * The task loops block in select() and friends, which are cancellation points.
+ * A thread waiting its turn on the virtual clock is in pthread_cond_wait() and
+ * would be cancelled holding the clock's mutex, so that one is only parked.
+ */
+bool Task::Stop()
+{
+	VirtualClock *pVirtual = GetVirtualClock();
+
+	if(!bRunning)
+	{
+		return(false);
+	}
+
+	if(pVirtual && (iClockSlot >= 0))
+	{
+		pVirtual->RemoveTask(iClockSlot);
+		pthread_detach(thread);
+	}
+	else
+	{
+		pthread_cancel(thread);
+		pthread_join(thread, NULL);
+	}
+
+	bRunning = false;
+	return(true);
+}
+
+///Every entry point the robot code hands a Task takes its one argument as a pointer sized value
+void *Task::Run(void *pThis)
+{
+	Task *pTask = (Task *)pThis;
+	VirtualClock *pVirtual = (pTask->iClockSlot >= 0) ? GetVirtualClock() : NULL;
+	void *pResult;
+
+	if(pVirtual)
+	{
+		pVirtual->EnterTask(pTask->iClockSlot);
+	}
+
+	pResult = ((void *(*)(intptr_t))pTask->function)(pTask->arg);
+
+	if(pVirtual)
+	{
+		pVirtual->ExitTask();
+	}
+
+	return(pResult);
+}
@@ -0,0 +1,87 @@
+/** \file
+ * Host stand-in for WPILib.h, for building the components against the simulated HAL.
+ *
+ * Only the services the components lean on are here: tasks on pthreads, timers
+ * and Wait() on the HAL's clock, wpi_assert() and a dashboard that goes nowhere.
+ * There are deliberately no device classes, the components get those from the
+ * HAL.  Task priorities and stack sizes are accepted and ignored.
+ */
+
+#ifndef SIM_WPILIB_H
+#define SIM_WPILIB_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <pthread.h>
+
+#include <string>
+
+typedef int (*FUNCPTR)(...);
+
+///Like the robot's, a failed assert is printed and the code carries on
+#define wpi_assert(condition) wpi_assert_impl((condition), #condition, __FILE__, __LINE__, __FUNCTION__)
+bool wpi_assert_impl(bool bCondition, const char *szCondition, const char *szFile, int iLine, const char *szFunction);
+
+double GetTime(); //seconds, from the HAL's clock once there is a backend
+void Wait(double fSeconds);
+
+class Timer
+{
+public:
+	Timer();
+
+	double Get();
+	void Reset();
+	void Start();
+	void Stop();
+	bool HasPeriodPassed(double fPeriod);
+
+private:
+	double fStartTime;
+	double fAccumulatedTime;
+	bool bRunning;
+	pthread_mutex_t mutex;
+};
+
+/**
+ * One pthread, the entry point gets the first argument to Start().  Under a
+ * VirtualClock the thread takes turns with the others and Stop() parks it
+ * rather than cancelling it.
+ */
+class Task
+{
+public:
+	static const int kDefaultPriority = 101;
+	static const int kDefaultStackSize = 20000;
+
+	Task(const char *szName, FUNCPTR function, int iPriority = kDefaultPriority, int iStackSize = kDefaultStackSize);
+	virtual ~Task();
+
+	bool Start(intptr_t arg0 = 0);
+	bool Stop();
+	bool Suspend() { return(false); }; //a pthread can't be suspended from outside, it runs on
+	bool Resume() { return(false); };
+	bool IsReady() { return(bRunning); };
+	const char *GetName() { return(szName); };
+
+private:
+	static void *Run(void *pThis);
+
+	char szName[32];
+	FUNCPTR function;
+	intptr_t arg;
+	pthread_t thread;
+	bool bRunning;
+	int iClockSlot; //our turn on the virtual clock, -1 on the real one
+};
+
+class SmartDashboard
+{
+public:
+	static void init() {};
+	static void PutNumber(std::string key, double fValue) {};
+	static void PutBoolean(std::string key, bool bValue) {};
+	static void PutString(std::string key, std::string value) {};
+};
+
+#endif //SIM_WPILIB_H
@@ -0,0 +1,457 @@
+/** \file
+ * Host tool that suggests Talon status frame periods that keep the CAN bus under a target load.
+ *
+ * The plan file lists the devices on the bus and, for each status frame the
+ * code reads, the fastest period worth having (how often the code looks) and
+ * the slowest it can live with.  Frames that aren't listed stay at the Talon's
+ * default.  What each device sends beyond its periodic traffic comes from the
+ * plan or, with -f, from the peak of its "<name> CAN frames/s" channel in a
+ * flight recording, so the plan can be checked against a real match.
+ *
+ * Every listed frame starts at its fastest period.  If that is over the target,
+ * all of them are stretched by one common factor, each stopping at its slowest,
+ * until the load fits.  The model is the one CanBusMonitor uses on the robot;
+ * the constants below are kept in step with CanBusMonitor.h.
+ *
+ * Build it on a laptop from this directory:
+ * \verbatim
+ g++ -std=c++11 -O2 -I.. -o canplanner CanPlanner.cpp
+ \endverbatim
+ *
+ * Usage:
+ * \verbatim
+ canplanner plan.txt [-t percent] [-f FlightRecorder.bin]
+ \endverbatim
+ *
+ * The plan file, # starts a comment:
+ * \verbatim
+ target percent                            load to fit under, -t overrides it
+ talon id name                             the name the robot code gave its MotorProxy
+ pdb id name
+ status id general|feedback|quad|analog fastest_ms slowest_ms
+ sent id frames_per_second                 control and config frames the code sends
+ \endverbatim
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#include "FlightRecorder.h"
+
+static const double BIT_RATE = 1.0e6;
+static const double BITS_PER_FRAME = 150.0;
+static const double TALON_CONTROL_RATE = 100.0;
+static const double PDB_FRAME_RATE = 120.0;
+static const double OTHER_FRAME_RATE = 50.0;
+static const int STATUS_FRAMES = 4;
+static const int MAX_PERIOD_MS = 255; //the longest status period a Talon takes
+static const char *szFrameNames[STATUS_FRAMES] = { "general", "feedback", "quad", "analog" };
+static const char *szFrameEnums[STATUS_FRAMES] = { "StatusFrameRateGeneral", "StatusFrameRateFeedback",
+		"StatusFrameRateQuadEncoder", "StatusFrameRateAnalogTempVbat" };
+static const int iDefaultPeriods[STATUS_FRAMES] = { 10, 20, 100, 100 };
+
+///One status frame of one Talon
+struct StatusPlan {
+	bool bListed;
+	int iFastest;					//ms
+	int iSlowest;					//ms
+	int iSuggested;					//ms
+};
+
+///One device on the bus
+struct DevicePlan {
+	int iId;
+	std::string name;
+	bool bTalon;
+	double fSent;					//frames per second beyond the periodic traffic
+	StatusPlan status[STATUS_FRAMES];
+};
+
+static DevicePlan *FindDevice(std::vector<DevicePlan> &devices, int iId)
+{
+	for(size_t i = 0; i < devices.size(); i++)
+	{
+		if(devices[i].iId == iId)
+		{
+			return(&devices[i]);
+		}
+	}
+
+	return(NULL);
+}
+
+static bool ReadPlan(const char *szPath, std::vector<DevicePlan> &devices, double &fTarget)
+{
+	FILE *pFile = fopen(szPath, "r");
+	char szLine[256];
+	int iLine = 0;
+
+	if(pFile == NULL)
+	{
+		fprintf(stderr, "can't open %s\n", szPath);
+		return(false);
+	}
+
+	while(fgets(szLine, sizeof(szLine), pFile) != NULL)
+	{
+		char szWord[32];
+		char szFrame[32];
+		int iId;
+		int iFastest;
+		int iSlowest;
+		int iUsed;
+		double fValue;
+		char *pComment = strchr(szLine, '#');
+
+		iLine++;
+
+		if(pComment != NULL)
+		{
+			*pComment = '\0';
+		}
+
+		if(sscanf(szLine, "%31s", szWord) != 1)
+		{
+			continue;
+		}
+
+		if((strcmp(szWord, "target") == 0) && (sscanf(szLine, "%*s %lf", &fValue) == 1))
+		{
+			fTarget = fValue;
+		}
+		else if(((strcmp(szWord, "talon") == 0) || (strcmp(szWord, "pdb") == 0))
+				&& (sscanf(szLine, "%*s %d %n", &iId, &iUsed) == 1))
+		{
+			DevicePlan device;
+			std::string name(szLine + iUsed);
+
+			name.erase(name.find_last_not_of(" \t\r\n") + 1);
+			device.iId = iId;
+			device.name = name.empty() ? std::string(szWord) : name;
+			device.bTalon = (strcmp(szWord, "talon") == 0);
+			device.fSent = 0.0;
+
+			for(int i = 0; i < STATUS_FRAMES; i++)
+			{
+				device.status[i].bListed = false;
+				device.status[i].iFastest = iDefaultPeriods[i];
+				device.status[i].iSlowest = iDefaultPeriods[i];
+				device.status[i].iSuggested = iDefaultPeriods[i];
+			}
+
+			devices.push_back(device);
+		}
+		else if((strcmp(szWord, "status") == 0)
+				&& (sscanf(szLine, "%*s %d %31s %d %d", &iId, szFrame, &iFastest, &iSlowest) == 4))
+		{
+			DevicePlan *pDevice = FindDevice(devices, iId);
+			int iFrame = -1;
+
+			for(int i = 0; i < STATUS_FRAMES; i++)
+			{
+				if(strcmp(szFrame, szFrameNames[i]) == 0)
+				{
+					iFrame = i;
+				}
+			}
+
+			if((pDevice == NULL) || !pDevice->bTalon || (iFrame < 0) || (iFastest < 1) || (iSlowest < iFastest))
+			{
+				fprintf(stderr, "%s:%d: bad status line\n", szPath, iLine);
+				fclose(pFile);
+				return(false);
+			}
+
+			StatusPlan &status = pDevice->status[iFrame];
+
+			status.bListed = true;
+			status.iFastest = iFastest;
+			status.iSlowest = std::min(iSlowest, MAX_PERIOD_MS);
+			status.iSuggested = iFastest;
+		}
+		else if((strcmp(szWord, "sent") == 0) && (sscanf(szLine, "%*s %d %lf", &iId, &fValue) == 2)
+				&& (FindDevice(devices, iId) != NULL))
+		{
+			FindDevice(devices, iId)->fSent = fValue;
+		}
+		else
+		{
+			fprintf(stderr, "%s:%d: can't read \"%s\"\n", szPath, iLine, szWord);
+			fclose(pFile);
+			return(false);
+		}
+	}
+
+	fclose(pFile);
+	return(true);
+}
+
+///Replaces each device's sent rate with the peak its channel reached in the recording
+static bool ReadSentRates(const char *szPath, std::vector<DevicePlan> &devices)
+{
+	struct stat info;
+	int iFile = open(szPath, O_RDONLY);
+	void *pMap;
+
+	if(iFile < 0)
+	{
+		fprintf(stderr, "can't open %s\n", szPath);
+		return(false);
+	}
+
+	if((fstat(iFile, &info) < 0) || ((size_t)info.st_size < FLIGHTRECORDER_HEADER_SIZE))
+	{
+		fprintf(stderr, "%s is too short to be a flight recording\n", szPath);
+		close(iFile);
+		return(false);
+	}
+
+	pMap = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, iFile, 0);
+	close(iFile);
+
+	if(pMap == MAP_FAILED)
+	{
+		fprintf(stderr, "can't map %s\n", szPath);
+		return(false);
+	}
+
+	const FlightRecorderHeader *pHeader = (const FlightRecorderHeader *)pMap;
+	const FlightRecord *pRecords = (const FlightRecord *)((const char *)pMap + FLIGHTRECORDER_HEADER_SIZE);
+
+	if((pHeader->uMagic != FLIGHTRECORDER_MAGIC) || (pHeader->uVersion != FLIGHTRECORDER_VERSION)
+			|| (pHeader->uRecordSize != sizeof(FlightRecord))
+			|| ((pHeader->uRecords & (pHeader->uRecords - 1)) != 0)
+			|| ((size_t)info.st_size < FLIGHTRECORDER_HEADER_SIZE + (size_t)pHeader->uRecords * sizeof(FlightRecord)))
+	{
+		fprintf(stderr, "%s is not a version %u flight recording\n", szPath, FLIGHTRECORDER_VERSION);
+		munmap(pMap, info.st_size);
+		return(false);
+	}
+
+	uint32_t uChannels = std::min(pHeader->uChannels.load(), (uint32_t)FLIGHTRECORDER_MAX_CHANNELS);
+	std::vector<int> deviceOf(uChannels, -1);
+	std::vector<double> peaks(devices.size(), -1.0);
+
+	for(size_t i = 0; i < devices.size(); i++)
+	{
+		std::string channel = devices[i].name + " CAN frames/s";
+
+		for(uint32_t j = 0; j < uChannels; j++)
+		{
+			if(strncmp(pHeader->szChannels[j], channel.c_str(), FLIGHTRECORDER_NAME_LENGTH - 1) == 0)
+			{
+				deviceOf[j] = i;
+			}
+		}
+	}
+
+	uint32_t uHead = pHeader->uHead.load();
+	uint32_t uFirst = (uHead > pHeader->uRecords) ? (uHead - pHeader->uRecords) : 0;
+
+	for(uint32_t uIndex = uFirst; uIndex != uHead; uIndex++)
+	{
+		const FlightRecord &record = pRecords[uIndex & (pHeader->uRecords - 1)];
+
+		if((record.uSequence.load(std::memory_order_relaxed) == uIndex + 1)
+				&& (record.uChannel < uChannels) && (deviceOf[record.uChannel] >= 0))
+		{
+			double &fPeak = peaks[deviceOf[record.uChannel]];
+
+			fPeak = std::max(fPeak, (double)record.fValue);
+		}
+	}
+
+	for(size_t i = 0; i < devices.size(); i++)
+	{
+		if(peaks[i] >= 0.0)
+		{
+			devices[i].fSent = peaks[i];
+		}
+		else if(devices[i].bTalon)
+		{
+			fprintf(stderr, "no \"%s CAN frames/s\" in the recording, using the plan\n", devices[i].name.c_str());
+		}
+	}
+
+	munmap(pMap, info.st_size);
+	return(true);
+}
+
+///Fraction of the bus the plan uses with the given status periods
+static double GetLoad(const std::vector<DevicePlan> &devices, bool bSuggested)
+{
+	double fFrames = OTHER_FRAME_RATE;
+
+	for(size_t i = 0; i < devices.size(); i++)
+	{
+		const DevicePlan &device = devices[i];
+
+		fFrames += device.fSent;
+
+		if(!device.bTalon)
+		{
+			fFrames += PDB_FRAME_RATE;
+			continue;
+		}
+
+		fFrames += TALON_CONTROL_RATE;
+
+		for(int j = 0; j < STATUS_FRAMES; j++)
+		{
+			fFrames += 1000.0 / (bSuggested ? device.status[j].iSuggested : iDefaultPeriods[j]);
+		}
+	}
+
+	return(fFrames * BITS_PER_FRAME / BIT_RATE);
+}
+
+///Stretches every listed frame by fFactor, as far as its slowest period
+static void Stretch(std::vector<DevicePlan> &devices, double fFactor)
+{
+	for(size_t i = 0; i < devices.size(); i++)
+	{
+		for(int j = 0; j < STATUS_FRAMES; j++)
+		{
+			StatusPlan &status = devices[i].status[j];
+
+			if(status.bListed)
+			{
+				status.iSuggested = std::min(status.iSlowest, (int)(status.iFastest * fFactor + 0.999));
+			}
+		}
+	}
+}
+
+static void Usage()
+{
+	fprintf(stderr, "usage: canplanner plan.txt [-t percent] [-f FlightRecorder.bin]\n");
+}
+
+int main(int argc, char **argv)
+{
+	std::vector<DevicePlan> devices;
+	double fTarget = 50.0;
+	double fOverride = -1.0;
+	const char *szRecording = NULL;
+	double fFactor = 1.0;
+
+	if(argc < 2)
+	{
+		Usage();
+		return(1);
+	}
+
+	for(int i = 2; i < argc; i++)
+	{
+		if((strcmp(argv[i], "-t") == 0) && (i + 1 < argc))
+		{
+			fOverride = atof(argv[++i]);
+		}
+		else if((strcmp(argv[i], "-f") == 0) && (i + 1 < argc))
+		{
+			szRecording = argv[++i];
+		}
+		else
+		{
+			Usage();
+			return(1);
+		}
+	}
+
+	if(!ReadPlan(argv[1], devices, fTarget) || ((szRecording != NULL) && !ReadSentRates(szRecording, devices)))
+	{
+		return(1);
+	}
+
+	if(fOverride > 0.0)
+	{
+		fTarget = fOverride;
+	}
+
+	// the load only falls as the factor grows, so halve the gap to the smallest one that fits
+
+	if(GetLoad(devices, true) * 100.0 > fTarget)
+	{
+		double fLow = 1.0;
+		double fHigh = MAX_PERIOD_MS;
+
+		Stretch(devices, fHigh);
+
+		if(GetLoad(devices, true) * 100.0 > fTarget)
+		{
+			fprintf(stderr, "even at their slowest periods the frames use %0.1f%% of the bus, over %0.1f%%\n",
+					GetLoad(devices, true) * 100.0, fTarget);
+			fFactor = fHigh;
+		}
+		else
+		{
+			while(fHigh - fLow > 0.01)
+			{
+				double fMiddle = (fLow + fHigh) / 2.0;
+
+				Stretch(devices, fMiddle);
+
+				if(GetLoad(devices, true) * 100.0 > fTarget)
+				{
+					fLow = fMiddle;
+				}
+				else
+				{
+					fHigh = fMiddle;
+				}
+			}
+
+			fFactor = fHigh;
+		}
+
+		Stretch(devices, fFactor);
+	}
+
+	printf("%-4s %-16s %-9s %8s %8s %10s %8s\n", "id", "device", "frame", "default", "suggest", "frames/s", "sent/s");
+
+	for(size_t i = 0; i < devices.size(); i++)
+	{
+		const DevicePlan &device = devices[i];
+
+		if(!device.bTalon)
+		{
+			printf("%-4d %-16s %-9s %8s %8s %10.0f %8.1f\n", device.iId, device.name.c_str(), "-", "-", "-",
+					PDB_FRAME_RATE, device.fSent);
+			continue;
+		}
+
+		for(int j = 0; j < STATUS_FRAMES; j++)
+		{
+			printf("%-4d %-16s %-9s %8d %8d %10.1f %8.1f\n", device.iId, device.name.c_str(), szFrameNames[j],
+					iDefaultPeriods[j], device.status[j].iSuggested, 1000.0 / device.status[j].iSuggested,
+					device.fSent);
+		}
+	}
+
+	printf("\nload with the default periods %0.1f%%, with the suggested ones %0.1f%%, target %0.1f%%\n",
+			GetLoad(devices, false) * 100.0, GetLoad(devices, true) * 100.0, fTarget);
+	printf("listed frames stretched by %0.2f\n\n", fFactor);
+
+	for(size_t i = 0; i < devices.size(); i++)
+	{
+		for(int j = 0; j < STATUS_FRAMES; j++)
+		{
+			if(devices[i].bTalon && (devices[i].status[j].iSuggested != iDefaultPeriods[j]))
+			{
+				printf("%s: SetStatusFrameRateMs(CANTalon::%s, %d);\n", devices[i].name.c_str(),
+						szFrameEnums[j], devices[i].status[j].iSuggested);
+			}
+		}
+	}
+
+	return(0);
+}
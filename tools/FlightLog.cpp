@@ -0,0 +1,654 @@
+/** \file
+ * Host tool that reads flight recorder files pulled off the robot.
+ *
+ * The file is memory mapped and read once to build an index: the records of each
+ * channel in the order they were claimed, and the places the 32 bit microsecond
+ * clock wrapped.  Time ranges are found by binary search on a channel's records,
+ * so only what is asked for is read again.  A few hundred MB index in a couple
+ * of seconds.
+ *
+ * Channels ending in " Command" or " Sent" hold MessageCommands and are printed
+ * with their enum names.  A component's " Sent" channel is written when a message
+ * goes into its pipe and its " Command" channel when it comes out, which is what
+ * the latency command pairs up.
+ *
+ * Build it on a laptop from this directory:
+ * \verbatim
+ g++ -std=c++11 -O2 -I.. -o flightlog FlightLog.cpp ../RobotMessage.cpp
+ \endverbatim
+ *
+ * Usage:
+ * \verbatim
+ flightlog file channels
+ flightlog file csv [-c name]... [-t start end] [-o out.csv]
+ flightlog file columns prefix [-c name]... [-t start end]
+ flightlog file summary [-c name]... [-t start end]
+ flightlog file latency [-t start end]
+
+ -c		picks the channels whose name contains the text, all of them if there is no -c
+ -t		seconds since the recorder started
+ \endverbatim
+ *
+ * csv writes time,channel,value rows in the order the values were recorded.
+ * columns writes one prefix.channel.col file per channel: a uint64_t count, then
+ * count doubles of time, then count floats of value, all little endian.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <vector>
+#include <string>
+#include <deque>
+#include <queue>
+#include <algorithm>
+
+#include "FlightRecorder.h"
+#include "RobotMessage.h"
+
+static const double MICROSECONDS = 1.0e-6;
+static const float LATENCY_BUCKETS[] = { 100.0, 200.0, 500.0, 1000.0, 2000.0, 5000.0,
+		10000.0, 20000.0, 50000.0 }; //microseconds, upper edges, the last bucket is everything above
+static const int LATENCY_BUCKET_COUNT = sizeof(LATENCY_BUCKETS) / sizeof(LATENCY_BUCKETS[0]) + 1;
+
+///A mapped recording and its index
+class FlightLog
+{
+public:
+	FlightLog();
+	~FlightLog();
+
+	bool Open(const char *szPath);
+	int GetChannelCount() { return(iChannels); };
+	const char *GetChannelName(int iChannel) { return(pHeader->szChannels[iChannel]); };
+	bool IsCommandChannel(int iChannel);
+	int FindChannel(const char *szName); //exact name, -1 if there isn't one
+
+	const std::vector<uint32_t> &GetRecords(int iChannel) { return(channels[iChannel]); };
+	double GetTime(uint32_t uIndex);
+	float GetValue(uint32_t uIndex) { return(pRecords[uIndex & uMask].fValue); };
+	void GetRange(int iChannel, double fStart, double fEnd, size_t &uBegin, size_t &uEnd);
+	uint32_t GetValidCount() { return(uValid); };
+	uint32_t GetTornCount() { return(uTorn); };
+
+private:
+	void *pMap;
+	size_t uMapSize;
+	const FlightRecorderHeader *pHeader;
+	const FlightRecord *pRecords;
+	uint32_t uMask;
+	int iChannels;
+	std::vector<std::vector<uint32_t> > channels; //record indexes, in the order they were claimed
+	std::vector<uint32_t> wraps; //record indexes where the microsecond clock went round
+	uint32_t uValid;
+	uint32_t uTorn;
+};
+
+FlightLog::FlightLog()
+{
+	pMap = NULL;
+	uMapSize = 0;
+	pHeader = NULL;
+	pRecords = NULL;
+	uMask = 0;
+	iChannels = 0;
+	uValid = 0;
+	uTorn = 0;
+}
+
+FlightLog::~FlightLog()
+{
+	if(pMap != NULL)
+	{
+		munmap(pMap, uMapSize);
+	}
+}
+
+bool FlightLog::Open(const char *szPath)
+{
+	struct stat info;
+	int iFile = open(szPath, O_RDONLY);
+
+	if(iFile < 0)
+	{
+		fprintf(stderr, "can't open %s\n", szPath);
+		return(false);
+	}
+
+	if((fstat(iFile, &info) < 0) || ((size_t)info.st_size < FLIGHTRECORDER_HEADER_SIZE))
+	{
+		fprintf(stderr, "%s is too short to be a flight recording\n", szPath);
+		close(iFile);
+		return(false);
+	}
+
+	uMapSize = info.st_size;
+	pMap = mmap(NULL, uMapSize, PROT_READ, MAP_PRIVATE, iFile, 0);
+	close(iFile);
+
+	if(pMap == MAP_FAILED)
+	{
+		fprintf(stderr, "can't map %s\n", szPath);
+		pMap = NULL;
+		return(false);
+	}
+
+	madvise(pMap, uMapSize, MADV_SEQUENTIAL);
+	pHeader = (const FlightRecorderHeader *)pMap;
+
+	if((pHeader->uMagic != FLIGHTRECORDER_MAGIC)
+			|| (pHeader->uVersion != FLIGHTRECORDER_VERSION)
+			|| (pHeader->uRecordSize != sizeof(FlightRecord))
+			|| (pHeader->uRecords == 0)
+			|| ((pHeader->uRecords & (pHeader->uRecords - 1)) != 0)
+			|| (uMapSize < FLIGHTRECORDER_HEADER_SIZE + (size_t)pHeader->uRecords * sizeof(FlightRecord)))
+	{
+		fprintf(stderr, "%s is not a version %u flight recording\n", szPath, FLIGHTRECORDER_VERSION);
+		return(false);
+	}
+
+	pRecords = (const FlightRecord *)((const char *)pMap + FLIGHTRECORDER_HEADER_SIZE);
+	uMask = pHeader->uRecords - 1;
+	iChannels = std::min(pHeader->uChannels.load(), (uint32_t)FLIGHTRECORDER_MAX_CHANNELS);
+	channels.resize(iChannels);
+
+	// the last lap of the ring is all that is left, oldest first
+
+	uint32_t uHead = pHeader->uHead.load();
+	uint32_t uFirst = (uHead > pHeader->uRecords) ? (uHead - pHeader->uRecords) : 0;
+	uint32_t uLastTime = 0;
+
+	for(uint32_t uIndex = uFirst; uIndex != uHead; uIndex++)
+	{
+		const FlightRecord &record = pRecords[uIndex & uMask];
+
+		if((record.uSequence.load(std::memory_order_relaxed) != uIndex + 1)
+				|| (record.uChannel >= iChannels))
+		{
+			uTorn++;
+			continue;
+		}
+
+		if((uValid > 0) && (uLastTime - record.uTime > 0x80000000u) && (uLastTime > record.uTime))
+		{
+			wraps.push_back(uIndex);
+		}
+
+		uLastTime = record.uTime;
+		channels[record.uChannel].push_back(uIndex);
+		uValid++;
+	}
+
+	return(true);
+}
+
+bool FlightLog::IsCommandChannel(int iChannel)
+{
+	const char *szName = GetChannelName(iChannel);
+	size_t uLength = strlen(szName);
+
+	return(((uLength > 8) && (strcmp(szName + uLength - 8, " Command") == 0))
+			|| ((uLength > 5) && (strcmp(szName + uLength - 5, " Sent") == 0)));
+}
+
+int FlightLog::FindChannel(const char *szName)
+{
+	for(int i = 0; i < iChannels; i++)
+	{
+		if(strcmp(GetChannelName(i), szName) == 0)
+		{
+			return(i);
+		}
+	}
+
+	return(-1);
+}
+
+///Seconds since the recorder started
+double FlightLog::GetTime(uint32_t uIndex)
+{
+	uint64_t uWraps = std::upper_bound(wraps.begin(), wraps.end(), uIndex) - wraps.begin();
+
+	return(((uWraps << 32) + pRecords[uIndex & uMask].uTime) * MICROSECONDS);
+}
+
+///Positions in GetRecords(iChannel) of the first record at or after fStart and just past the last before fEnd
+void FlightLog::GetRange(int iChannel, double fStart, double fEnd, size_t &uBegin, size_t &uEnd)
+{
+	const std::vector<uint32_t> &records = channels[iChannel];
+
+	uBegin = std::lower_bound(records.begin(), records.end(), fStart,
+			[this](uint32_t uIndex, double fTime) { return(GetTime(uIndex) < fTime); }) - records.begin();
+	uEnd = std::lower_bound(records.begin() + uBegin, records.end(), fEnd,
+			[this](uint32_t uIndex, double fTime) { return(GetTime(uIndex) < fTime); }) - records.begin();
+}
+
+///The command line, after the file name and command
+struct Options {
+	std::vector<std::string> names;
+	double fStart;
+	double fEnd;
+	const char *szOutput;
+	const char *szPrefix;
+};
+
+static void Usage()
+{
+	fprintf(stderr,
+			"usage: flightlog file channels\n"
+			"       flightlog file csv [-c name]... [-t start end] [-o out.csv]\n"
+			"       flightlog file columns prefix [-c name]... [-t start end]\n"
+			"       flightlog file summary [-c name]... [-t start end]\n"
+			"       flightlog file latency [-t start end]\n");
+}
+
+static bool ParseOptions(int argc, char **argv, int iFirst, Options &options)
+{
+	options.fStart = 0.0;
+	options.fEnd = 1.0e12;
+	options.szOutput = NULL;
+
+	for(int i = iFirst; i < argc; i++)
+	{
+		if((strcmp(argv[i], "-c") == 0) && (i + 1 < argc))
+		{
+			options.names.push_back(argv[++i]);
+		}
+		else if((strcmp(argv[i], "-t") == 0) && (i + 2 < argc))
+		{
+			options.fStart = atof(argv[++i]);
+			options.fEnd = atof(argv[++i]);
+		}
+		else if((strcmp(argv[i], "-o") == 0) && (i + 1 < argc))
+		{
+			options.szOutput = argv[++i];
+		}
+		else
+		{
+			fprintf(stderr, "don't understand %s\n", argv[i]);
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
+static std::vector<int> PickChannels(FlightLog &log, const Options &options)
+{
+	std::vector<int> picked;
+
+	for(int i = 0; i < log.GetChannelCount(); i++)
+	{
+		bool bPicked = options.names.empty();
+
+		for(size_t j = 0; j < options.names.size(); j++)
+		{
+			bPicked |= (strstr(log.GetChannelName(i), options.names[j].c_str()) != NULL);
+		}
+
+		if(bPicked)
+		{
+			picked.push_back(i);
+		}
+	}
+
+	return(picked);
+}
+
+static const char *CommandName(float fValue)
+{
+	return(GetMessageCommandName((MessageCommand)(int)fValue));
+}
+
+static void ListChannels(FlightLog &log)
+{
+	for(int i = 0; i < log.GetChannelCount(); i++)
+	{
+		const std::vector<uint32_t> &records = log.GetRecords(i);
+
+		if(records.empty())
+		{
+			printf("%3d %-32s %10d\n", i, log.GetChannelName(i), 0);
+		}
+		else
+		{
+			printf("%3d %-32s %10zu %10.3f %10.3f\n", i, log.GetChannelName(i), records.size(),
+					log.GetTime(records.front()), log.GetTime(records.back()));
+		}
+	}
+
+	printf("%u records, %u torn or overwritten\n", log.GetValidCount(), log.GetTornCount());
+}
+
+///Merges the picked channels back into the order they were recorded
+static bool WriteCsv(FlightLog &log, const Options &options)
+{
+	typedef std::pair<uint32_t, int> Next; //record index, picked channel
+	std::vector<int> picked = PickChannels(log, options);
+	std::vector<size_t> positions(picked.size());
+	std::vector<size_t> ends(picked.size());
+	std::priority_queue<Next, std::vector<Next>, std::greater<Next> > next;
+	FILE *pFile = stdout;
+	static char buffer[1 << 20];
+
+	if(options.szOutput && ((pFile = fopen(options.szOutput, "w")) == NULL))
+	{
+		fprintf(stderr, "can't write %s\n", options.szOutput);
+		return(false);
+	}
+
+	setvbuf(pFile, buffer, _IOFBF, sizeof(buffer));
+	fprintf(pFile, "time,channel,value\n");
+
+	for(size_t i = 0; i < picked.size(); i++)
+	{
+		log.GetRange(picked[i], options.fStart, options.fEnd, positions[i], ends[i]);
+
+		if(positions[i] < ends[i])
+		{
+			next.push(Next(log.GetRecords(picked[i])[positions[i]], i));
+		}
+	}
+
+	while(!next.empty())
+	{
+		uint32_t uIndex = next.top().first;
+		int i = next.top().second;
+		int iChannel = picked[i];
+
+		next.pop();
+
+		if(log.IsCommandChannel(iChannel))
+		{
+			fprintf(pFile, "%.6f,%s,%s\n", log.GetTime(uIndex), log.GetChannelName(iChannel),
+					CommandName(log.GetValue(uIndex)));
+		}
+		else
+		{
+			fprintf(pFile, "%.6f,%s,%g\n", log.GetTime(uIndex), log.GetChannelName(iChannel),
+					log.GetValue(uIndex));
+		}
+
+		if(++positions[i] < ends[i])
+		{
+			next.push(Next(log.GetRecords(iChannel)[positions[i]], i));
+		}
+	}
+
+	if(pFile != stdout)
+	{
+		fclose(pFile);
+	}
+
+	return(true);
+}
+
+static bool WriteColumns(FlightLog &log, const Options &options)
+{
+	std::vector<int> picked = PickChannels(log, options);
+
+	for(size_t i = 0; i < picked.size(); i++)
+	{
+		const std::vector<uint32_t> &records = log.GetRecords(picked[i]);
+		std::string path = std::string(options.szPrefix) + "." + log.GetChannelName(picked[i]) + ".col";
+		size_t uBegin;
+		size_t uEnd;
+		FILE *pFile;
+
+		std::replace(path.begin() + strlen(options.szPrefix), path.end(), ' ', '_');
+		std::replace(path.begin() + strlen(options.szPrefix), path.end(), '/', '_');
+		log.GetRange(picked[i], options.fStart, options.fEnd, uBegin, uEnd);
+
+		uint64_t uCount = uEnd - uBegin;
+		std::vector<double> times(uCount);
+		std::vector<float> values(uCount);
+
+		for(size_t j = uBegin; j < uEnd; j++)
+		{
+			times[j - uBegin] = log.GetTime(records[j]);
+			values[j - uBegin] = log.GetValue(records[j]);
+		}
+
+		if((pFile = fopen(path.c_str(), "wb")) == NULL)
+		{
+			fprintf(stderr, "can't write %s\n", path.c_str());
+			return(false);
+		}
+
+		fwrite(&uCount, sizeof(uCount), 1, pFile);
+		fwrite(times.data(), sizeof(double), uCount, pFile);
+		fwrite(values.data(), sizeof(float), uCount, pFile);
+		fclose(pFile);
+		printf("%s %llu\n", path.c_str(), (unsigned long long)uCount);
+	}
+
+	return(true);
+}
+
+///Value at fraction fAt of the way through, values must be sorted
+static float Percentile(const std::vector<float> &values, double fAt)
+{
+	return(values[(size_t)(fAt * (values.size() - 1) + 0.5)]);
+}
+
+static void Summarize(FlightLog &log, const Options &options)
+{
+	std::vector<int> picked = PickChannels(log, options);
+
+	printf("%-32s %10s %10s %10s %10s %10s %10s %10s\n", "channel", "count", "min", "mean",
+			"p50", "p90", "p99", "max");
+
+	for(size_t i = 0; i < picked.size(); i++)
+	{
+		const std::vector<uint32_t> &records = log.GetRecords(picked[i]);
+		std::vector<float> values;
+		double fSum = 0.0;
+		size_t uBegin;
+		size_t uEnd;
+
+		log.GetRange(picked[i], options.fStart, options.fEnd, uBegin, uEnd);
+
+		if(uBegin == uEnd)
+		{
+			continue;
+		}
+
+		if(log.IsCommandChannel(picked[i]))
+		{
+			std::vector<unsigned> counts(COMMAND_LAST + 1, 0);
+
+			printf("%-32s %10zu\n", log.GetChannelName(picked[i]), uEnd - uBegin);
+
+			for(size_t j = uBegin; j < uEnd; j++)
+			{
+				int iCommand = (int)log.GetValue(records[j]);
+
+				counts[((iCommand < 0) || (iCommand > COMMAND_LAST)) ? COMMAND_UNKNOWN : iCommand]++;
+			}
+
+			for(int j = 0; j <= COMMAND_LAST; j++)
+			{
+				if(counts[j] > 0)
+				{
+					printf("    %-40s %10u\n", GetMessageCommandName((MessageCommand)j), counts[j]);
+				}
+			}
+
+			continue;
+		}
+
+		values.reserve(uEnd - uBegin);
+
+		for(size_t j = uBegin; j < uEnd; j++)
+		{
+			values.push_back(log.GetValue(records[j]));
+			fSum += values.back();
+		}
+
+		std::sort(values.begin(), values.end());
+
+		printf("%-32s %10zu %10.4g %10.4g %10.4g %10.4g %10.4g %10.4g\n", log.GetChannelName(picked[i]),
+				values.size(), values.front(), fSum / values.size(), Percentile(values, 0.5),
+				Percentile(values, 0.9), Percentile(values, 0.99), values.back());
+	}
+}
+
+/**
+ * Pairs each component's sent commands with the ones it received.  The pipe is
+ * first in, first out, so a received command belongs to the oldest matching one
+ * still waiting; anything older than that was lost off the start of the ring.
+ * Commands written straight into the pipe (SensorFusion impacts) have no send
+ * and are skipped.
+ */
+static void Latency(FlightLog &log, const Options &options)
+{
+	printf("%-24s %8s %8s %8s %8s %8s", "component", "count", "p50 us", "p90 us", "p99 us", "max us");
+
+	for(int i = 0; i < LATENCY_BUCKET_COUNT - 1; i++)
+	{
+		printf(" %7.0f", LATENCY_BUCKETS[i]);
+	}
+
+	printf("    more\n");
+
+	for(int iSent = 0; iSent < log.GetChannelCount(); iSent++)
+	{
+		std::string name = log.GetChannelName(iSent);
+
+		if((name.size() <= 5) || (name.compare(name.size() - 5, 5, " Sent") != 0))
+		{
+			continue;
+		}
+
+		std::string component = name.substr(0, name.size() - 5);
+		int iReceived = log.FindChannel((component + " Command").c_str());
+
+		if(iReceived < 0)
+		{
+			continue;
+		}
+
+		const std::vector<uint32_t> &sent = log.GetRecords(iSent);
+		const std::vector<uint32_t> &received = log.GetRecords(iReceived);
+		std::deque<uint32_t> waiting;
+		std::vector<float> latencies;
+		std::vector<unsigned> buckets(LATENCY_BUCKET_COUNT, 0);
+		size_t uSent = 0;
+
+		for(size_t j = 0; j < received.size(); j++)
+		{
+			float fCommand = log.GetValue(received[j]);
+			double fReceived = log.GetTime(received[j]);
+
+			while((uSent < sent.size()) && (sent[uSent] < received[j]))
+			{
+				waiting.push_back(sent[uSent++]);
+			}
+
+			std::deque<uint32_t>::iterator match = std::find_if(waiting.begin(), waiting.end(),
+					[&log, fCommand](uint32_t uIndex) { return(log.GetValue(uIndex) == fCommand); });
+
+			if(match == waiting.end())
+			{
+				continue;
+			}
+
+			double fSent = log.GetTime(*match);
+
+			waiting.erase(waiting.begin(), match + 1);
+
+			if((fSent < options.fStart) || (fSent >= options.fEnd))
+			{
+				continue;
+			}
+
+			float fLatency = (fReceived - fSent) / MICROSECONDS;
+			int iBucket = std::upper_bound(LATENCY_BUCKETS, LATENCY_BUCKETS + LATENCY_BUCKET_COUNT - 1,
+					fLatency) - LATENCY_BUCKETS;
+
+			latencies.push_back(fLatency);
+			buckets[iBucket]++;
+		}
+
+		if(latencies.empty())
+		{
+			continue;
+		}
+
+		std::sort(latencies.begin(), latencies.end());
+		printf("%-24s %8zu %8.0f %8.0f %8.0f %8.0f", component.c_str(), latencies.size(),
+				Percentile(latencies, 0.5), Percentile(latencies, 0.9), Percentile(latencies, 0.99),
+				latencies.back());
+
+		for(int k = 0; k < LATENCY_BUCKET_COUNT; k++)
+		{
+			printf(" %7u", buckets[k]);
+		}
+
+		printf("\n");
+	}
+}
+
+int main(int argc, char **argv)
+{
+	FlightLog log;
+	Options options;
+	int iOptions = 3;
+
+	if(argc < 3)
+	{
+		Usage();
+		return(1);
+	}
+
+	if(strcmp(argv[2], "columns") == 0)
+	{
+		if(argc < 4)
+		{
+			Usage();
+			return(1);
+		}
+
+		options.szPrefix = argv[3];
+		iOptions = 4;
+	}
+
+	if(!ParseOptions(argc, argv, iOptions, options) || !log.Open(argv[1]))
+	{
+		return(1);
+	}
+
+	if(strcmp(argv[2], "channels") == 0)
+	{
+		ListChannels(log);
+	}
+	else if(strcmp(argv[2], "csv") == 0)
+	{
+		return(WriteCsv(log, options) ? 0 : 1);
+	}
+	else if(strcmp(argv[2], "columns") == 0)
+	{
+		return(WriteColumns(log, options) ? 0 : 1);
+	}
+	else if(strcmp(argv[2], "summary") == 0)
+	{
+		Summarize(log, options);
+	}
+	else if(strcmp(argv[2], "latency") == 0)
+	{
+		Latency(log, options);
+	}
+	else
+	{
+		Usage();
+		return(1);
+	}
+
+	return(0);
+}